@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <system_error>
+
+namespace ds
+{
+
+class TcpSocket;
+
+/// @brief High/low watermark flow control of a single outbound connection.
+///
+/// Feed it the connection's backlog (bytes queued in user space plus bytes still unsent in the kernel)
+/// after every queue or flush, and act on the returned events:
+/// * `PAUSE`: backlog reached the high watermark; stop reading from the upstream peers that feed this connection.
+/// * `RESUME`: backlog dropped to the low watermark; it's writable again, resume the upstream peers.
+/// * `SLOW_CONSUMER`: it stayed paused past the deadline; disconnect it.
+///
+/// Each event fires once per transition, so the gap between the watermarks keeps it from flapping.
+/// While paused, keep calling `update()` periodically (e.g. on each loop tick) so the deadline can fire.
+class Backpressure final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Event
+    {
+        NONE,
+        PAUSE,
+        RESUME,
+        SLOW_CONSUMER,
+    };
+
+public:
+    /// @param slow_consumer_deadline `std::nullopt` never reports `Event::SLOW_CONSUMER`
+    Backpressure(std::size_t low_watermark, std::size_t high_watermark,
+                 std::optional<Clock::duration> slow_consumer_deadline = std::nullopt);
+
+    auto update(std::size_t backlog, Clock::time_point now) -> Event;
+
+    /// @brief Backlog of `sock`: `queued_length` bytes in user space, plus the unsent bytes in the kernel.
+    ///
+    /// The kernel part is `TcpSocket::get_unsent_length()` where supported,
+    /// falling back to `StreamSocket::get_send_queue_length()`, or `0` if neither is.
+    static auto measure_backlog(const TcpSocket& sock, std::size_t queued_length, std::error_code&) -> std::size_t;
+
+public:
+    bool is_paused() const;
+    bool is_slow_consumer() const;
+
+    auto get_backlog() const -> std::size_t;
+
+    /// @return when it got paused, or `std::nullopt` if it's not paused
+    auto get_paused_since() const -> std::optional<Clock::time_point>;
+
+    auto get_low_watermark() const -> std::size_t;
+    auto get_high_watermark() const -> std::size_t;
+    void set_watermarks(std::size_t low_watermark, std::size_t high_watermark);
+
+    auto get_slow_consumer_deadline() const -> std::optional<Clock::duration>;
+    void set_slow_consumer_deadline(std::optional<Clock::duration>);
+
+private:
+    std::size_t _low_watermark;
+    std::size_t _high_watermark;
+    std::optional<Clock::duration> _slow_consumer_deadline;
+
+    std::size_t _backlog = 0;
+    std::optional<Clock::time_point> _paused_since;
+    bool _slow_consumer = false;
+};
+
+} // namespace ds
@@ -0,0 +1,354 @@
+#pragma once
+
+#include "DirtySocks/PlatformSocket.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/IoBuffer.hpp"
+#include "DirtySocks/SocketAddress.hpp"
+#include "DirtySocks/UnixSocketAddress.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <system_error>
+#include <utility>
+
+namespace ds
+{
+
+enum class BlockingMode
+{
+    BLOCKING,
+    NON_BLOCKING,
+};
+
+struct TcpProtocol
+{
+    using Address = SocketAddress;
+
+    static constexpr int TYPE = SOCK_STREAM;
+
+    static int family(const Address& addr)
+    {
+        return IpVersion::V6 == addr.get_ip_version() ? AF_INET6 : AF_INET;
+    }
+};
+
+struct UnixStreamProtocol
+{
+    using Address = UnixSocketAddress;
+
+    static constexpr int TYPE = SOCK_STREAM;
+
+    static int family(const Address&)
+    {
+        return AF_UNIX;
+    }
+};
+
+/// @brief Instrumentation that compiles down to nothing.
+struct NoInstrumentation
+{
+    void on_send(std::size_t) noexcept
+    {
+    }
+    void on_receive(std::size_t) noexcept
+    {
+    }
+    void on_error(const std::error_code&) noexcept
+    {
+    }
+};
+
+/// @brief Instrumentation that counts calls, bytes & errors.
+struct CountingInstrumentation
+{
+    std::uint64_t send_calls = 0;
+    std::uint64_t sent_bytes = 0;
+    std::uint64_t receive_calls = 0;
+    std::uint64_t received_bytes = 0;
+    std::uint64_t errors = 0;
+
+    void on_send(std::size_t sent_length) noexcept
+    {
+        ++send_calls;
+        sent_bytes += sent_length;
+    }
+    void on_receive(std::size_t received_length) noexcept
+    {
+        ++receive_calls;
+        received_bytes += received_length;
+    }
+    void on_error(const std::error_code&) noexcept
+    {
+        ++errors;
+    }
+};
+
+/// @brief Non-virtual, header-only stream socket, with its policies fixed at compile time.
+///
+/// Unlike `TcpSocket`, there's no vtable nor runtime blocking flag,
+/// so the send & receive calls are inlined down to the raw syscall & an error check.
+///
+/// @tparam Mode blocking mode, applied at creation time
+/// @tparam Protocol `TcpProtocol` or `UnixStreamProtocol`
+/// @tparam Instrumentation hooks called after each send & receive
+template <BlockingMode Mode, typename Protocol, typename Instrumentation = NoInstrumentation>
+class BasicSocket final
+{
+public:
+    using Address = typename Protocol::Address;
+
+public:
+    BasicSocket() = default;
+
+    ~BasicSocket()
+    {
+        close();
+    }
+
+    BasicSocket(BasicSocket&& other) noexcept
+        : _handle(std::exchange(other._handle, INVALID_SOCKET)), _instrumentation(std::move(other._instrumentation))
+    {
+    }
+
+    BasicSocket& operator=(BasicSocket&& other) noexcept
+    {
+        close();
+        _handle = std::exchange(other._handle, INVALID_SOCKET);
+        _instrumentation = std::move(other._instrumentation);
+        return *this;
+    }
+
+    BasicSocket(const BasicSocket&) = delete;
+    BasicSocket& operator=(const BasicSocket&) = delete;
+
+public:
+    /// @brief Take over an existing handle (e.g. `Socket::release()`), and apply `Mode` to it.
+    static auto adopt(SOCKET handle, std::error_code& ec) -> BasicSocket
+    {
+        ec.clear();
+
+        BasicSocket result;
+        result._handle = handle;
+        result.apply_blocking_mode(ec);
+        return result;
+    }
+
+public:
+    void connect(const Address& addr, std::error_code& ec)
+    {
+        ec.clear();
+        open(Protocol::family(addr), ec);
+        if (ec)
+            return;
+
+        if (SOCKET_ERROR == ::connect(_handle, &addr.get_sockaddr(), addr.get_sockaddr_len()))
+            set_last_error(ec);
+    }
+
+    void close()
+    {
+        if (INVALID_SOCKET != _handle)
+        {
+#ifdef _WIN32
+            closesocket(_handle);
+#else // POSIX
+            ::close(_handle);
+#endif
+            _handle = INVALID_SOCKET;
+        }
+    }
+
+    /// @brief Give up the ownership of the handle, without closing it.
+    auto release() -> SOCKET
+    {
+        return std::exchange(_handle, INVALID_SOCKET);
+    }
+
+public:
+    void send(const void* data, std::size_t data_length, std::size_t& sent_length, std::error_code& ec)
+    {
+        ec.clear();
+
+#ifdef _WIN32
+        const auto ret = ::send(_handle, static_cast<const char*>(data), static_cast<int>(data_length), 0);
+#else // POSIX
+        const auto ret = ::send(_handle, data, data_length, 0);
+#endif
+
+        if (SOCKET_ERROR == ret)
+        {
+            sent_length = 0;
+            set_last_error(ec);
+            return;
+        }
+
+        sent_length = static_cast<std::size_t>(ret);
+        _instrumentation.on_send(sent_length);
+    }
+
+    void send(std::span<IoBuffer> buffers, std::size_t& sent_length, std::error_code& ec)
+    {
+        ec.clear();
+
+#ifdef _WIN32
+        DWORD sent;
+        const auto ret =
+            WSASend(_handle, buffers.data(), static_cast<DWORD>(buffers.size()), &sent, 0, nullptr, nullptr);
+#else // POSIX
+        msghdr msg{};
+        msg.msg_iov = buffers.data();
+        msg.msg_iovlen = buffers.size();
+        const auto ret = sendmsg(_handle, &msg, 0);
+        const auto sent = ret;
+#endif
+
+        if (SOCKET_ERROR == ret)
+        {
+            sent_length = 0;
+            set_last_error(ec);
+            return;
+        }
+
+        sent_length = static_cast<std::size_t>(sent);
+        _instrumentation.on_send(sent_length);
+    }
+
+    void receive(void* data, std::size_t data_length, std::size_t& received_length, std::error_code& ec)
+    {
+        ec.clear();
+
+#ifdef _WIN32
+        const auto ret = ::recv(_handle, static_cast<char*>(data), static_cast<int>(data_length), 0);
+#else // POSIX
+        const auto ret = ::recv(_handle, data, data_length, 0);
+#endif
+
+        if (SOCKET_ERROR == ret)
+        {
+            received_length = 0;
+            set_last_error(ec);
+            return;
+        }
+
+        received_length = static_cast<std::size_t>(ret);
+        _instrumentation.on_receive(received_length);
+    }
+
+    void receive(std::span<IoBuffer> buffers, std::size_t& received_length, std::error_code& ec)
+    {
+        ec.clear();
+
+#ifdef _WIN32
+        DWORD received;
+        DWORD flags = 0;
+        const auto ret =
+            WSARecv(_handle, buffers.data(), static_cast<DWORD>(buffers.size()), &received, &flags, nullptr, nullptr);
+#else // POSIX
+        msghdr msg{};
+        msg.msg_iov = buffers.data();
+        msg.msg_iovlen = buffers.size();
+        const auto ret = recvmsg(_handle, &msg, 0);
+        const auto received = ret;
+#endif
+
+        if (SOCKET_ERROR == ret)
+        {
+            received_length = 0;
+            set_last_error(ec);
+            return;
+        }
+
+        received_length = static_cast<std::size_t>(received);
+        _instrumentation.on_receive(received_length);
+    }
+
+public:
+    auto get_handle() const -> SOCKET
+    {
+        return _handle;
+    }
+
+    static constexpr bool is_non_blocking()
+    {
+        return BlockingMode::NON_BLOCKING == Mode;
+    }
+
+    auto get_instrumentation() -> Instrumentation&
+    {
+        return _instrumentation;
+    }
+
+    auto get_instrumentation() const -> const Instrumentation&
+    {
+        return _instrumentation;
+    }
+
+private:
+    void open(int family, std::error_code& ec)
+    {
+        close();
+
+#ifdef __linux__
+        // set the blocking mode with the socket type flags, no extra `fcntl()` round trips
+        constexpr int type = Protocol::TYPE | SOCK_CLOEXEC | (is_non_blocking() ? SOCK_NONBLOCK : 0);
+        _handle = ::socket(family, type, 0);
+        if (INVALID_SOCKET == _handle)
+            set_last_error(ec);
+#else
+        _handle = ::socket(family, Protocol::TYPE, 0);
+        if (INVALID_SOCKET == _handle)
+        {
+            set_last_error(ec);
+            return;
+        }
+
+        if constexpr (is_non_blocking())
+            apply_blocking_mode(ec);
+#endif
+    }
+
+    void apply_blocking_mode(std::error_code& ec)
+    {
+#ifdef _WIN32
+        u_long enabled = is_non_blocking();
+        if (SOCKET_ERROR == ioctlsocket(_handle, FIONBIO, &enabled))
+            set_last_error(ec);
+#else // POSIX
+        auto flags = fcntl(_handle, F_GETFL, 0);
+        if (SOCKET_ERROR == flags || SOCKET_ERROR == fcntl(_handle, F_SETFL,
+                                                           is_non_blocking() ? (flags | O_NONBLOCK)
+                                                                             : (flags & ~O_NONBLOCK)))
+            set_last_error(ec);
+#endif
+    }
+
+    void set_last_error(std::error_code& ec)
+    {
+#ifdef _WIN32
+        ec = static_cast<SystemErrc>(WSAGetLastError());
+#else // POSIX
+        ec = static_cast<SystemErrc>(errno);
+#endif
+        _instrumentation.on_error(ec);
+    }
+
+private:
+    SOCKET _handle = INVALID_SOCKET;
+    [[no_unique_address]] Instrumentation _instrumentation;
+};
+
+template <typename Instrumentation = NoInstrumentation>
+using BlockingTcpSocket = BasicSocket<BlockingMode::BLOCKING, TcpProtocol, Instrumentation>;
+
+template <typename Instrumentation = NoInstrumentation>
+using NonBlockingTcpSocket = BasicSocket<BlockingMode::NON_BLOCKING, TcpProtocol, Instrumentation>;
+
+template <typename Instrumentation = NoInstrumentation>
+using BlockingUnixSocket = BasicSocket<BlockingMode::BLOCKING, UnixStreamProtocol, Instrumentation>;
+
+template <typename Instrumentation = NoInstrumentation>
+using NonBlockingUnixSocket = BasicSocket<BlockingMode::NON_BLOCKING, UnixStreamProtocol, Instrumentation>;
+
+} // namespace ds
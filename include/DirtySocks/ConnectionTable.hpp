@@ -0,0 +1,210 @@
+#pragma once
+
+#include "DirtySocks/TcpSocket.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ds
+{
+
+/// @brief Generational handle of a `ConnectionTable` entry.
+///
+/// It goes stale once its entry is erased, even if the slot (or the OS descriptor) gets reused,
+/// so it's safe to use as a selector token.
+struct ConnectionHandle
+{
+    std::uint64_t value = 0; // `0` is never a valid handle
+
+public:
+    static constexpr auto from_token(std::uint64_t token) -> ConnectionHandle
+    {
+        return ConnectionHandle{token};
+    }
+
+    constexpr auto to_token() const -> std::uint64_t
+    {
+        return value;
+    }
+
+    constexpr explicit operator bool() const
+    {
+        return 0 != value;
+    }
+
+    constexpr bool operator==(const ConnectionHandle&) const = default;
+};
+
+/// @brief Slot map of sockets & per-connection states, addressed by `ConnectionHandle`.
+///
+/// Sockets and states are kept densely packed in their own arrays, so iterating them is cache-friendly,
+/// and looking up a handle is just an index and a generation check. (no hashing)
+///
+/// Erasing moves the last entry into the hole, so pointers from `get_socket()` & `get_state()` are invalidated
+/// by `erase()`, as well as by `insert()`. Handles are never invalidated until their own entries are erased.
+template <typename State, typename SocketType = TcpSocket>
+class ConnectionTable final
+{
+public:
+    auto insert(SocketType socket, State state) -> ConnectionHandle
+    {
+        std::uint32_t slot_index;
+        if (NO_FREE_SLOT != _free_head)
+        {
+            slot_index = _free_head;
+            _free_head = _slots[slot_index].index;
+        }
+        else
+        {
+            slot_index = static_cast<std::uint32_t>(_slots.size());
+            _slots.push_back(Slot{});
+        }
+
+        Slot& slot = _slots[slot_index];
+        ++slot.generation;
+        slot.index = static_cast<std::uint32_t>(_sockets.size());
+
+        _sockets.push_back(std::move(socket));
+        _states.push_back(std::move(state));
+        _dense_to_slot.push_back(slot_index);
+
+        return make_handle(slot_index, slot.generation);
+    }
+
+    /// @return `false` if `handle` was stale
+    bool erase(ConnectionHandle handle)
+    {
+        const Slot* slot = find(handle);
+        if (!slot)
+            return false;
+
+        const std::uint32_t slot_index = get_slot_index(handle);
+        const std::uint32_t dense_index = slot->index;
+        const std::uint32_t last = static_cast<std::uint32_t>(_sockets.size() - 1);
+
+        // swap-and-pop the dense arrays
+        if (dense_index != last)
+        {
+            _sockets[dense_index] = std::move(_sockets[last]);
+            _states[dense_index] = std::move(_states[last]);
+            _dense_to_slot[dense_index] = _dense_to_slot[last];
+            _slots[_dense_to_slot[dense_index]].index = dense_index;
+        }
+        _sockets.pop_back();
+        _states.pop_back();
+        _dense_to_slot.pop_back();
+
+        // bump the generation to stale the outstanding handles
+        Slot& freed = _slots[slot_index];
+        ++freed.generation;
+        freed.index = _free_head;
+        _free_head = slot_index;
+
+        return true;
+    }
+
+    void clear()
+    {
+        while (!_sockets.empty())
+            erase(get_handle_at(_sockets.size() - 1));
+    }
+
+    bool contains(ConnectionHandle handle) const
+    {
+        return nullptr != find(handle);
+    }
+
+    /// @return `nullptr` if `handle` is stale
+    auto get_socket(ConnectionHandle handle) -> SocketType*
+    {
+        const Slot* slot = find(handle);
+        return (slot) ? &_sockets[slot->index] : nullptr;
+    }
+
+    /// @return `nullptr` if `handle` is stale
+    auto get_state(ConnectionHandle handle) -> State*
+    {
+        const Slot* slot = find(handle);
+        return (slot) ? &_states[slot->index] : nullptr;
+    }
+
+    auto size() const -> std::size_t
+    {
+        return _sockets.size();
+    }
+
+    bool empty() const
+    {
+        return _sockets.empty();
+    }
+
+public:
+    // dense access, in no particular order
+
+    auto get_handle_at(std::size_t dense_index) const -> ConnectionHandle
+    {
+        const std::uint32_t slot_index = _dense_to_slot[dense_index];
+        return make_handle(slot_index, _slots[slot_index].generation);
+    }
+
+    auto get_socket_at(std::size_t dense_index) -> SocketType&
+    {
+        return _sockets[dense_index];
+    }
+
+    auto get_state_at(std::size_t dense_index) -> State&
+    {
+        return _states[dense_index];
+    }
+
+private:
+    static constexpr std::uint32_t NO_FREE_SLOT = UINT32_MAX;
+
+    struct Slot
+    {
+        std::uint32_t generation = 0; // odd while occupied, even while free
+        std::uint32_t index = 0;      // dense index while occupied, next free slot while free
+    };
+
+    static constexpr auto make_handle(std::uint32_t slot_index, std::uint32_t generation) -> ConnectionHandle
+    {
+        return ConnectionHandle{(static_cast<std::uint64_t>(generation) << 32) | slot_index};
+    }
+
+    static constexpr auto get_slot_index(ConnectionHandle handle) -> std::uint32_t
+    {
+        return static_cast<std::uint32_t>(handle.value);
+    }
+
+    static constexpr auto get_generation(ConnectionHandle handle) -> std::uint32_t
+    {
+        return static_cast<std::uint32_t>(handle.value >> 32);
+    }
+
+    auto find(ConnectionHandle handle) const -> const Slot*
+    {
+        const std::uint32_t slot_index = get_slot_index(handle);
+        if (slot_index >= _slots.size())
+            return nullptr;
+
+        // free slots have even generations, which no handle carries
+        const Slot& slot = _slots[slot_index];
+        if (slot.generation != get_generation(handle) || 0 == slot.generation % 2)
+            return nullptr;
+
+        return &slot;
+    }
+
+private:
+    std::vector<Slot> _slots;
+    std::uint32_t _free_head = NO_FREE_SLOT;
+
+    // dense, parallel arrays
+    std::vector<SocketType> _sockets;
+    std::vector<State> _states;
+    std::vector<std::uint32_t> _dense_to_slot;
+};
+
+} // namespace ds
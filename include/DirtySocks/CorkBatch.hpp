@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <system_error>
+#include <vector>
+
+namespace ds
+{
+
+class TcpSocket;
+
+/// @brief Corks a `TcpSocket` for the scope, so its writes there go out in full segments, then uncorks it.
+class CorkGuard final
+{
+public:
+    /// @brief On error (e.g. `SystemErrc::operation_not_supported`), the socket is left as is.
+    CorkGuard(TcpSocket& socket, std::error_code&);
+
+    /// @brief Uncork, sending what's left right away.
+    ~CorkGuard();
+
+    CorkGuard(const CorkGuard&) = delete;
+    CorkGuard& operator=(const CorkGuard&) = delete;
+
+private:
+    TcpSocket& _socket;
+    bool _corked;
+};
+
+/// @brief Corks sockets as they're written to during a batch (e.g. an event loop iteration),
+/// and uncorks each of them exactly once when it ends.
+///
+/// So however many small writes the handlers make, each socket sends full segments, then a single partial one
+/// at the end of the batch, with one `setsockopt()` each way. Since the batch ends before waiting for events again,
+/// nothing waits for more than the batch itself, unlike with Nagle's algorithm.
+///
+/// Each corked socket knows its batch, so it may be moved around, closed or destroyed during the batch:
+/// it's dropped from it then, and a new socket reusing the same handle (e.g. by `accept()`) isn't taken for it.
+/// So the batch must outlive its sockets, or be flushed first.
+class CorkBatch final
+{
+public:
+    CorkBatch() = default;
+
+    /// @brief `flush()`
+    ~CorkBatch();
+
+    CorkBatch(const CorkBatch&) = delete;
+    CorkBatch& operator=(const CorkBatch&) = delete;
+
+public:
+    /// @brief Cork `socket` until the end of the batch, if it isn't already. Call it before writing.
+    void cork(TcpSocket& socket, std::error_code&);
+
+    /// @brief Uncork `socket` right away, and drop it from the batch.
+    ///
+    /// Call it before handing the socket over to another batch (e.g. migrating it to another loop).
+    void uncork(TcpSocket& socket, std::error_code&);
+
+    /// @brief End the batch: uncork every socket, sending what they held back.
+    ///
+    /// Errors are ignored, as the sockets may have failed during the batch.
+    void flush();
+
+    auto get_corked_count() const -> std::size_t;
+
+private:
+    friend class TcpSocket;
+
+    // from the `TcpSocket` itself
+    void drop(TcpSocket& socket);
+    void relocate(TcpSocket& from, TcpSocket& to);
+
+    auto find(TcpSocket& socket) -> std::vector<TcpSocket*>::iterator;
+
+private:
+    std::vector<TcpSocket*> _corked;
+};
+
+} // namespace ds
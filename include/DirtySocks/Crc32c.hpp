@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ds
+{
+
+/// @brief Incremental CRC32C (Castagnoli), the one used by iSCSI, SCTP & ext4.
+///
+/// Uses the SSE4.2 `crc32` instruction (chosen at runtime) or the ARMv8 CRC extension when available,
+/// with 3 independent lanes for large inputs to hide the instruction latency.
+class Crc32c final
+{
+public:
+    void update(const void* data, std::size_t length);
+
+    /// @return CRC32C of all the data passed to `update()` since the last `reset()`
+    auto get_value() const -> std::uint32_t;
+
+    void reset();
+
+public:
+    static auto compute(const void* data, std::size_t length) -> std::uint32_t;
+
+    /// @brief Table-driven software CRC32C, which the hardware one always matches.
+    static auto compute_portable(const void* data, std::size_t length) -> std::uint32_t;
+
+    /// @return name of the implementation `compute()` dispatches to, e.g. `"sse4.2"`
+    static auto get_implementation() -> const char*;
+
+private:
+    std::uint32_t _state = 0xFFFFFFFF;
+};
+
+} // namespace ds
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace ds
+{
+
+class StreamSocket;
+
+/// @brief Splits a byte stream into frames ending with a delimiter, e.g. `"\n"`, `"\r\n"` or `"\r\n\r\n"`.
+///
+/// Delimiters are searched with SIMD (AVX2, SSE2 or NEON, chosen at runtime),
+/// and the scan position is kept across partial reads, so no byte is scanned twice.
+///
+/// Frames are returned as views into the internal buffer, which stay valid until the next `prepare()`.
+class DelimiterFramer final
+{
+public:
+    static constexpr std::size_t DEFAULT_MAX_FRAME_LENGTH = 64 * 1024;
+
+    /// @param delimiter must not be empty (asserted, and `next_frame()` sets `SystemErrc::invalid_argument` if it is)
+    /// @param max_frame_length longer frames are reported as `StreamErrc::FRAME_TOO_LONG`
+    explicit DelimiterFramer(std::string_view delimiter, std::size_t max_frame_length = DEFAULT_MAX_FRAME_LENGTH);
+
+public:
+    /// @brief Receive once from `socket` into the internal buffer.
+    ///
+    /// Same as `StreamSocket::receive()`, so `received_length == 0` means the peer closed the stream.
+    void receive_from(StreamSocket& socket, std::size_t& received_length, std::error_code&);
+
+    /// @brief Get a writable space of at least `min_length` bytes at the end of the buffer.
+    ///
+    /// This invalidates the frames returned so far.
+    auto prepare(std::size_t min_length) -> std::span<char>;
+
+    /// @brief Mark `length` bytes written to the space from `prepare()` as received.
+    void commit(std::size_t length);
+
+    /// @brief Copy `data` into the buffer. (`prepare()` & `commit()`)
+    void feed(const void* data, std::size_t length);
+
+    /// @brief Pop the next complete frame, without its delimiter.
+    ///
+    /// `StreamErrc::FRAME_TOO_LONG` is permanent: the framer stays at the oversized frame, and keeps failing.
+    /// Since the stream can't be resynchronized past it, drop the connection (or `reset()` to start over).
+    ///
+    /// @return `std::nullopt` if there's no complete frame yet, or on error
+    auto next_frame(std::error_code&) -> std::optional<std::string_view>;
+
+    /// @brief Discard all buffered bytes.
+    void reset();
+
+public:
+    /// @return number of received bytes not popped as frames yet
+    auto get_buffered_length() const -> std::size_t;
+
+    auto get_delimiter() const -> std::string_view;
+    auto get_max_frame_length() const -> std::size_t;
+
+    /// @return name of the delimiter scan implementation, e.g. `"avx2"`
+    static auto get_scan_implementation() -> const char*;
+
+private:
+    std::string _delimiter;
+    std::size_t _max_frame_length;
+
+    std::vector<char> _buffer;
+    std::size_t _begin = 0; // start of the unpopped bytes
+    std::size_t _scan = 0;  // bytes before this were scanned already
+    std::size_t _end = 0;   // end of the received bytes
+};
+
+} // namespace ds
@@ -25,10 +25,12 @@ namespace ds
 enum class AddrInfoErrc;
 enum class SystemErrc;
 enum class SocketSelectorErrc;
+enum class StreamErrc;
 
 auto make_error_code(AddrInfoErrc) -> std::error_code;
 auto make_error_code(SystemErrc) -> std::error_code;
 auto make_error_code(SocketSelectorErrc) -> std::error_code;
+auto make_error_code(StreamErrc) -> std::error_code;
 
 enum class AddrInfoErrc
 {
@@ -137,6 +139,15 @@ enum class SocketSelectorErrc
     FD_VALUE_TOO_BIG,
 };
 
+enum class StreamErrc
+{
+    END_OF_STREAM = 1,
+    FRAME_TOO_LONG,
+    CHECKSUM_MISMATCH,
+    MALFORMED_FRAME,
+    DEADLINE_EXCEEDED,
+};
+
 } // namespace ds
 
 namespace std
@@ -157,4 +168,9 @@ struct is_error_code_enum<ds::SocketSelectorErrc> : true_type
 {
 };
 
+template <>
+struct is_error_code_enum<ds::StreamErrc> : true_type
+{
+};
+
 } // namespace std
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "DirtySocks/CorkBatch.hpp"
+#include "DirtySocks/Mailbox.hpp"
+#include "DirtySocks/PollSelector.hpp"
+#include "DirtySocks/TcpListener.hpp"
+#include "DirtySocks/TcpSocket.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <system_error>
+#include <unordered_map>
+
+namespace ds
+{
+
+class Rebalancer;
+class Runtime;
+struct RuntimeConfig;
+
+/// @brief One of the `Runtime`'s event loops, each run by its own thread pinned to its own CPU.
+///
+/// Everything here belongs to the loop's thread; other loops reach it only with `post()`.
+class EventLoop final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    using Task = Mailbox::Task;
+    using EventHandler = std::function<void(EventLoop&, const PollSelector::Ready&)>;
+
+    /// @brief Drives the loop's timers, e.g. `PacedSender::run()`, `RpcConnection::expire()` or `ReliablePeer` resends.
+    ///
+    /// @return when to be called again at the latest (`std::nullopt` for no timer), as the loop waits until then
+    using TimerHandler = std::function<std::optional<Clock::time_point>(EventLoop&, Clock::time_point now)>;
+
+    /// @brief A connection on its way to another loop.
+    struct MigratedConnection
+    {
+        TcpSocket socket;
+        Mailbox::Outbox pending_send; // sent by the target loop before anything else
+        std::shared_ptr<void> state;  // the app's own, e.g. with its receive buffer
+    };
+
+    /// @brief Adopts a migrated connection on the target loop.
+    ///
+    /// Pending sends that would block stay in the mailbox, keyed by the returned address, so the socket must
+    /// stay there until they're flushed or discarded. Not in a `ConnectionTable`'s own socket array, which moves
+    /// its sockets on `insert()` & `erase()`; use `ConnectionTable<State, std::unique_ptr<TcpSocket>>` instead.
+    ///
+    /// @return where the socket was moved to, so its pending sends resume there (`nullptr` drops the connection)
+    using MigrationHandler = std::function<TcpSocket*(EventLoop&, MigratedConnection&)>;
+
+    /// @brief Asked by the `Rebalancer` to migrate the connection of `token` to loop `target_index`.
+    using ShedHandler = std::function<void(EventLoop&, std::uint64_t token, std::size_t target_index)>;
+
+    // reserved selector tokens, which no `ConnectionHandle` can be (its upper half is odd)
+    static constexpr std::uint64_t LISTENER_TOKEN = 0;
+    static constexpr std::uint64_t MAILBOX_TOKEN = 1;
+
+public:
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+public:
+    auto get_index() const -> std::size_t;
+    auto get_cpu() const -> unsigned;
+
+    auto get_runtime() -> Runtime&;
+
+    /// @brief Add sockets here, with any tokens but the reserved ones.
+    auto get_selector() -> PollSelector&;
+
+    /// @brief The loop's own non-blocking `SO_REUSEPORT` listener, if `RuntimeConfig::listen_address` was set.
+    auto get_listener() -> TcpListener&;
+
+    auto get_mailbox() -> Mailbox&;
+
+    /// @brief Memory for the loop's buffers & connection state, pre-faulted by its pinned thread.
+    ///
+    /// The kernel places pages on the node of the CPU that first touches them, so this is local to the loop's CPU.
+    /// Not thread-safe, like everything else here.
+    auto get_memory_resource() -> std::pmr::memory_resource*;
+
+    /// @brief Handle every selector event except the mailbox's.
+    void set_event_handler(EventHandler);
+
+    void set_migration_handler(MigrationHandler);
+
+    /// @brief Opt in to the `Rebalancer`, which then also tracks the handling time of each token.
+    void set_shed_handler(ShedHandler);
+
+    /// @brief Called once per iteration, after the events are handled (and before the first wait), so keep it cheap.
+    ///
+    /// Its sends are corked along with the handlers' ones.
+    void set_timer_handler(TimerHandler);
+
+public:
+    /// @brief Run `task` on loop `loop_index`, which can be this one.
+    void post(std::size_t loop_index, Task task, std::error_code&);
+
+    /// @brief Move `socket`, with its pending sends & `state`, to loop `target_index`.
+    ///
+    /// The socket is removed from the selector and moved from right away, so drop its entry afterwards;
+    /// the target's migration handler adopts it. Unread & unsent bytes stay in the kernel, so nothing is lost.
+    ///
+    /// Sends already posted to the mailbox for it move along in order, but later ones would refer to the old object;
+    /// so threads replying later (e.g. `ThreadPool` workers) should post tasks that look the connection up instead.
+    ///
+    /// On error, the socket stays here with its pending sends, out of the selector.
+    /// So like for the `MigrationHandler`, `socket` must have a stable address. (see `Mailbox`)
+    void migrate(TcpSocket& socket, std::size_t target_index, std::shared_ptr<void> state, std::error_code&);
+
+    /// @brief Cork `socket` until the end of this iteration, then send whatever its handlers wrote, at once.
+    ///
+    /// Call it before writing, as many times as needed; each socket is uncorked once, before waiting for events.
+    /// See `CorkBatch`.
+    void cork(TcpSocket& socket, std::error_code&);
+
+    /// @brief Uncork `socket` right away, e.g. to send a reply that must not wait for the end of the iteration.
+    void uncork(TcpSocket& socket, std::error_code&);
+
+    /// @brief Time spent outside of waiting for events, since the start. (any thread)
+    auto get_busy_time() const -> std::chrono::nanoseconds;
+
+private:
+    friend class Rebalancer;
+    friend class Runtime;
+
+    EventLoop(Runtime&, std::size_t index, unsigned cpu);
+
+    // on the loop's thread
+    void init(const RuntimeConfig&, std::error_code&);
+    void run(std::error_code&);
+
+    void stop();
+
+    void adopt(MigratedConnection&);
+
+    auto run_timers() -> std::optional<Clock::time_point>;
+
+    // for the `Rebalancer`
+    void shed(std::size_t target_index, double load_fraction);
+    void reset_token_loads();
+
+private:
+    Runtime& _runtime;
+    const std::size_t _index;
+    const unsigned _cpu;
+
+    // declared in the order they must be destroyed in reverse
+    std::unique_ptr<std::byte[]> _arena_memory;
+    std::optional<std::pmr::monotonic_buffer_resource> _arena;
+    std::optional<std::pmr::unsynchronized_pool_resource> _pool;
+
+    PollSelector _selector;
+    Mailbox _mailbox;
+    TcpListener _listener;
+    CorkBatch _cork_batch;
+
+    EventHandler _event_handler;
+    MigrationHandler _migration_handler;
+    ShedHandler _shed_handler;
+    TimerHandler _timer_handler;
+    bool _stopping = false;
+
+    std::atomic<std::int64_t> _busy_ns{0};
+    std::unordered_map<std::uint64_t, Clock::duration> _token_loads; // handling time since the last rebalance
+};
+
+} // namespace ds
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "DirtySocks/Socket.hpp"
+
+#include <system_error>
+
+namespace ds
+{
+
+/// @brief Wakes up a thread blocked in `SocketSelector::select()` from another thread.
+///
+/// Add this to the read set of the selector, and `consume()` it when it's readable.
+///
+/// On Linux, this is an `eventfd`.
+/// Elsewhere, it's a non-blocking loopback UDP socket connected to itself,
+/// because Win32 `::select()` only accepts sockets.
+class EventNotifier final : public Socket
+{
+public:
+    EventNotifier() = default;
+
+public:
+    void open(std::error_code&);
+
+    /// @brief Make the notifier readable.
+    ///
+    /// This is safe to call from any thread while the notifier is open.
+    /// Notifying an already notified notifier is a no-op.
+    void notify(std::error_code&);
+
+    /// @brief Reset the notifier to non-readable.
+    void consume(std::error_code&);
+
+private:
+    EventNotifier(SOCKET, bool non_blocking);
+};
+
+} // namespace ds
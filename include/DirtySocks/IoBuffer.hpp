@@ -2,6 +2,11 @@
 
 #include "DirtySocks/PlatformSocket.hpp"
 
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <span>
+
 namespace ds
 {
 
@@ -17,4 +22,66 @@ using IoBuffer = iovec;
 
 #endif
 
+/// @brief Max number of buffers for a single vectored send/receive call. (`IOV_MAX`)
+#ifdef IOV_MAX
+inline constexpr std::size_t MAX_IO_BUFFERS = IOV_MAX;
+#else
+inline constexpr std::size_t MAX_IO_BUFFERS = 1024;
+#endif
+
+auto get_total_length(std::span<const IoBuffer> buffers) -> std::size_t;
+
+/// @brief Advance `buffers` in place past `length` bytes, e.g. after a short write.
+///
+/// Fully consumed (and empty) buffers at the front are dropped from the span,
+/// and the first partially consumed one is adjusted.
+void advance_io_buffers(std::span<IoBuffer>& buffers, std::size_t length);
+
+/// @brief Number of queued chunks gathered into a single `sendmsg()`, e.g. by `OutboundQueue`.
+inline constexpr std::size_t MAX_BUFFERS_PER_SEND = 64;
+
+/// @brief Point `out_buffers` at the unsent bytes of a queue of chunks (anything with `data()` & `size()`),
+/// from `first_offset` into the first one, and up to `max_length` bytes.
+///
+/// @return number of buffers filled in, at most `out_buffers.size()`
+template <typename Chunks>
+auto gather_io_buffers(const Chunks& chunks, std::size_t first_offset, std::size_t max_length,
+                       std::span<IoBuffer> out_buffers, std::size_t& gathered_length) -> std::size_t
+{
+    std::size_t count = 0;
+    gathered_length = 0;
+    for (std::size_t i = 0; i < chunks.size() && count < out_buffers.size() && gathered_length < max_length; ++i)
+    {
+        const auto& chunk = chunks[i];
+        const std::size_t offset = (0 == i) ? first_offset : 0;
+        const std::size_t length = std::min(chunk.size() - offset, max_length - gathered_length);
+
+        // the bytes are never written, `IoBuffer` just isn't const
+        out_buffers[count].iov_base = const_cast<char*>(reinterpret_cast<const char*>(chunk.data() + offset));
+        out_buffers[count].iov_len = static_cast<decltype(out_buffers[count].iov_len)>(length);
+        ++count;
+        gathered_length += length;
+    }
+    return count;
+}
+
+/// @brief Pop the fully sent chunks off the front of the queue, and advance `first_offset` into the next one.
+template <typename Chunks>
+void consume_sent_chunks(Chunks& chunks, std::size_t& first_offset, std::size_t sent_length)
+{
+    while (sent_length > 0)
+    {
+        const std::size_t chunk_remaining = chunks.front().size() - first_offset;
+        if (sent_length < chunk_remaining)
+        {
+            first_offset += sent_length;
+            return;
+        }
+
+        sent_length -= chunk_remaining;
+        chunks.pop_front();
+        first_offset = 0;
+    }
+}
+
 } // namespace ds
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "DirtySocks/Crc32c.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <vector>
+
+namespace ds
+{
+
+class StreamSocket;
+
+enum class FrameChecksum
+{
+    NONE,
+    CRC32C, // 4-byte CRC32C trailer after the payload
+};
+
+/// @brief Splits a byte stream into binary frames: `[payload length (u32 LE)][payload][CRC32C (u32 LE), optional]`
+///
+/// With `FrameChecksum::CRC32C`, the payload is checksummed as it's committed, not in a second pass over the frame,
+/// and a mismatch is reported as `StreamErrc::CHECKSUM_MISMATCH`. Errors leave the stream unusable, see `next_frame()`.
+///
+/// Frames are returned as views into the internal buffer, which stay valid until the next `prepare()`.
+class LengthPrefixedFramer final
+{
+public:
+    static constexpr std::size_t HEADER_LENGTH = 4;
+    static constexpr std::size_t TRAILER_LENGTH = 4;
+    static constexpr std::size_t DEFAULT_MAX_FRAME_LENGTH = 1024 * 1024;
+
+    /// @param max_frame_length longer payloads are reported as `StreamErrc::FRAME_TOO_LONG`, which is permanent
+    explicit LengthPrefixedFramer(FrameChecksum checksum = FrameChecksum::NONE,
+                                  std::size_t max_frame_length = DEFAULT_MAX_FRAME_LENGTH);
+
+public:
+    /// @brief Receive once from `socket` into the internal buffer.
+    ///
+    /// Same as `StreamSocket::receive()`, so `received_length == 0` means the peer closed the stream.
+    void receive_from(StreamSocket& socket, std::size_t& received_length, std::error_code&);
+
+    /// @brief Get a writable space of at least `min_length` bytes at the end of the buffer.
+    ///
+    /// This invalidates the frames returned so far.
+    auto prepare(std::size_t min_length) -> std::span<std::byte>;
+
+    /// @brief Mark `length` bytes written to the space from `prepare()` as received.
+    void commit(std::size_t length);
+
+    /// @brief Copy `data` into the buffer. (`prepare()` & `commit()`)
+    void feed(const void* data, std::size_t length);
+
+    /// @brief Pop the next complete frame's payload.
+    ///
+    /// `StreamErrc::FRAME_TOO_LONG` & `StreamErrc::CHECKSUM_MISMATCH` are permanent: the framer stays at the bad
+    /// frame, and keeps failing. The stream is unusable then, so drop the connection (or `reset()` to start over).
+    ///
+    /// @return `std::nullopt` if there's no complete frame yet, or on error
+    auto next_frame(std::error_code&) -> std::optional<std::span<const std::byte>>;
+
+    /// @brief Discard all buffered bytes.
+    void reset();
+
+public:
+    /// @return number of received bytes not popped as frames yet
+    auto get_buffered_length() const -> std::size_t;
+
+    auto get_checksum() const -> FrameChecksum;
+    auto get_max_frame_length() const -> std::size_t;
+
+public:
+    // encoding
+
+    /// @brief Append a whole frame of `payload` to `out`.
+    static void append_frame(std::vector<std::byte>& out, std::span<const std::byte> payload, FrameChecksum);
+
+    // for sending `payload` in place, e.g. with `StreamSocket::send_all(std::span<IoBuffer>&, ...)`
+    static auto encode_header(std::size_t payload_length) -> std::array<std::byte, HEADER_LENGTH>;
+    static auto encode_trailer(std::span<const std::byte> payload) -> std::array<std::byte, TRAILER_LENGTH>;
+
+private:
+    bool parse_header(std::error_code&);
+    void update_checksum();
+
+private:
+    FrameChecksum _checksum;
+    std::size_t _max_frame_length;
+
+    std::vector<std::byte> _buffer;
+    std::size_t _begin = 0; // start of the current frame
+    std::size_t _end = 0;   // end of the received bytes
+
+    // current frame
+    std::optional<std::uint32_t> _payload_length; // `std::nullopt` until the header arrives
+    std::size_t _checksummed_length = 0;          // payload bytes checksummed so far
+    Crc32c _crc;
+};
+
+} // namespace ds
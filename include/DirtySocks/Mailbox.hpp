@@ -0,0 +1,128 @@
+#pragma once
+
+#include "DirtySocks/EventNotifier.hpp"
+#include "DirtySocks/MpscQueue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <system_error>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace ds
+{
+
+class TcpSocket;
+
+/// @brief Lets other threads submit sends & closures to the thread that owns an event loop.
+///
+/// Posting never blocks: messages go through a lock-free `MpscQueue`,
+/// and the owner's `EventNotifier` is notified only when the mailbox goes from empty to non-empty.
+///
+/// The owner thread adds `get_notifier()` to the read set of its selector, and calls `drain()` when it's readable.
+/// All sends posted for a socket since the last `drain()` are flushed together, in posted order.
+///
+/// Pending sends are keyed by the socket's address, so a socket with any must neither move nor be destroyed
+/// until they're flushed or discarded. (e.g. keep it behind a `std::unique_ptr` in a `ConnectionTable`)
+class Mailbox final
+{
+public:
+    using Task = std::function<void()>;
+    using SendErrorHandler = std::function<void(TcpSocket&, const std::error_code&)>;
+
+    /// @brief Unsent data of a socket.
+    struct Outbox
+    {
+        std::deque<std::vector<std::byte>> chunks;
+        std::size_t first_chunk_offset = 0;
+        std::size_t length = 0; // unsent bytes of all chunks
+    };
+
+public:
+    Mailbox() = default;
+
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+public:
+    /// @brief Open the notifier. (owner thread)
+    void open(std::error_code&);
+    void close();
+
+    auto get_notifier() const -> const EventNotifier&;
+
+public:
+    /// @brief Run `task` on the owner thread. (any thread)
+    void post(Task task, std::error_code&);
+
+    /// @brief Send `data` to `sock` on the owner thread. (any thread)
+    ///
+    /// `sock` must stay alive until its sends are flushed or dropped by the owner.
+    void post_send(TcpSocket& sock, std::vector<std::byte> data, std::error_code&);
+
+public:
+    /// @brief Run posted tasks & flush posted sends. (owner thread)
+    ///
+    /// Sends that would block stay pending; watch `has_pending_send()` sockets for writability and `flush()` them.
+    /// Other send errors drop the pending data of that socket, and are reported to the send error handler.
+    ///
+    /// @return number of messages processed
+    auto drain(std::error_code&) -> std::size_t;
+
+    /// @brief Send as much pending data of `sock` as possible. (owner thread)
+    void flush(TcpSocket& sock, std::error_code&);
+
+    bool has_pending_send(const TcpSocket&) const;
+
+    /// @brief Bytes of `sock` still queued in user space, e.g. for `Backpressure::measure_backlog()`. (owner thread)
+    auto get_pending_send_length(const TcpSocket&) const -> std::size_t;
+
+    /// @brief Drop pending sends of `sock`, e.g. before closing it. (owner thread)
+    ///
+    /// This includes sends posted for it that weren't drained yet.
+    void discard_pending_send(const TcpSocket&);
+
+    /// @brief Remove & return pending sends of `sock`, e.g. to move it to another thread. (owner thread)
+    ///
+    /// This includes sends posted for it that weren't drained yet; posted tasks still run in order on `drain()`.
+    auto take_pending_send(const TcpSocket&) -> Outbox;
+
+    /// @brief Queue `outbox` ahead of any pending sends of `sock`, and flush them. (owner thread)
+    void restore_pending_send(TcpSocket& sock, Outbox outbox, std::error_code&);
+
+    void set_send_error_handler(SendErrorHandler);
+
+private:
+    struct SendRequest
+    {
+        TcpSocket* socket;
+        std::vector<std::byte> data;
+    };
+
+    using Message = std::variant<Task, SendRequest>;
+
+private:
+    void queue_send(SendRequest&);
+
+    // moves all queued sends to the outboxes, holding back queued tasks for `drain()`
+    void collect_sends();
+    void forget_touched(const TcpSocket&);
+
+    void signal(std::error_code&);
+
+private:
+    MpscQueue<Message> _queue;
+    std::atomic<bool> _signaled{false};
+    EventNotifier _notifier;
+
+    // owner thread only
+    std::unordered_map<const TcpSocket*, Outbox> _outboxes;
+    std::vector<TcpSocket*> _touched_sockets; // null if taken or discarded within `drain()`
+    std::deque<Task> _deferred_tasks;
+    SendErrorHandler _send_error_handler;
+};
+
+} // namespace ds
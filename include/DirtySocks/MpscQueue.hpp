@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+namespace ds
+{
+
+/// @brief Unbounded lock-free multi-producer single-consumer queue. (Dmitry Vyukov's node-based one)
+///
+/// `push()` is wait-free and can be called from any thread.
+/// `try_pop()` must be called only from the single consumer thread.
+template <typename T>
+class MpscQueue final
+{
+public:
+    MpscQueue() : _tail(new Node), _head(_tail.load(std::memory_order_relaxed))
+    {
+    }
+
+    ~MpscQueue()
+    {
+        while (try_pop())
+            ;
+        delete _head;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+public:
+    void push(T value)
+    {
+        Node* node = new Node;
+        node->value.emplace(std::move(value));
+
+        Node* prev = _tail.exchange(node, std::memory_order_acq_rel);
+        // consumer can't see `node` until this store, so `try_pop()` might spuriously return `std::nullopt` meanwhile
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    auto try_pop() -> std::optional<T>
+    {
+        Node* next = _head->next.load(std::memory_order_acquire);
+        if (!next)
+            return std::nullopt;
+
+        // `next` becomes the new stub node
+        std::optional<T> result = std::move(next->value);
+        next->value.reset();
+
+        delete _head;
+        _head = next;
+
+        return result;
+    }
+
+    /// @brief Check emptiness from the consumer thread.
+    bool empty() const
+    {
+        return nullptr == _head->next.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node*> next{nullptr};
+        std::optional<T> value;
+    };
+
+private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<Node*> _tail; // producers side
+    alignas(CACHE_LINE_SIZE) Node* _head;              // consumer side (stub node)
+};
+
+} // namespace ds
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "DirtySocks/SharedBuffer.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <span>
+#include <system_error>
+
+namespace ds
+{
+
+class StreamSocket;
+
+/// @brief A socket's queue of unsent `SharedBuffer`s, sent with gathered writes.
+///
+/// Each buffer is released as soon as it's fully sent, so a broadcast payload is freed
+/// once the slowest socket has flushed it.
+class OutboundQueue final
+{
+public:
+    void push(SharedBuffer);
+
+    /// @brief Send as much as the socket takes now.
+    ///
+    /// Would-block isn't an error: it stops with the rest still queued, so watch the socket for writability.
+    /// Other errors leave the queue as is, and are set to `ec`.
+    ///
+    /// @param sent_length bytes sent by this call
+    void flush(StreamSocket&, std::size_t& sent_length, std::error_code&);
+
+    void clear();
+
+public:
+    bool empty() const;
+
+    /// @return unsent bytes of all queued buffers
+    auto get_length() const -> std::size_t;
+
+    auto get_buffers_count() const -> std::size_t;
+
+private:
+    friend void broadcast(const SharedBuffer&, std::span<OutboundQueue* const>);
+
+private:
+    std::deque<SharedBuffer> _buffers;
+    std::size_t _first_buffer_offset = 0;
+    std::size_t _length = 0; // unsent bytes of all buffers
+};
+
+/// @brief Queue `buffer` to all `queues`, sharing its bytes.
+///
+/// The use count is bumped once for all of them, so it's one atomic operation no matter how many queues.
+/// Null queues are skipped.
+void broadcast(const SharedBuffer& buffer, std::span<OutboundQueue* const> queues);
+
+} // namespace ds
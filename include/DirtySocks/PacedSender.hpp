@@ -0,0 +1,117 @@
+#pragma once
+
+#include "DirtySocks/TokenBucket.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace ds
+{
+
+class StreamSocket;
+
+/// @brief User-space pacing of many stream sockets, each rate-limited by its own `TokenBucket`.
+///
+/// For where `Socket::set_max_pacing_rate()` isn't available.
+///
+/// Data beyond a socket's tokens is queued, and the socket is put on a single min-heap by when its tokens suffice,
+/// so thousands of sockets share one timer: use `get_next_wakeup()` as the selector timeout, then call `run()`.
+///
+/// This only stores raw pointers to added sockets, so they should be `remove()`d before they're destroyed.
+class PacedSender final
+{
+public:
+    using Clock = TokenBucket::Clock;
+    using SendErrorHandler = std::function<void(StreamSocket&, const std::error_code&)>;
+
+    /// @brief Smallest send made once tokens trickle in, not to pace out a segment per byte. (or `burst`, if smaller)
+    static constexpr std::size_t MIN_SEND_LENGTH = 1460;
+
+public:
+    /// @param rate bytes per second; with `0` (or a `0` burst), queued data waits for `set_rate()`
+    /// @param burst bytes that can go out at once
+    void add(StreamSocket&, std::uint64_t rate, std::size_t burst, Clock::time_point now);
+
+    /// @brief Stop pacing `sock`, dropping its queued data.
+    void remove(const StreamSocket&);
+
+    void set_rate(StreamSocket&, std::uint64_t rate, std::size_t burst, Clock::time_point now);
+
+public:
+    /// @brief Send `data` to an added socket, as much as its tokens allow now, and queue the rest.
+    ///
+    /// Errors other than would-block drop the queued data of `sock`, and are set to `ec`.
+    void send(StreamSocket&, std::vector<std::byte> data, Clock::time_point now, std::error_code&);
+
+    /// @brief Send the queued data of sockets whose tokens are due.
+    ///
+    /// Send errors drop the queued data of that socket, and are reported to the send error handler.
+    void run(Clock::time_point now);
+
+    /// @return when `run()` should be called next, or `std::nullopt` if nothing is queued
+    auto get_next_wakeup() -> std::optional<Clock::time_point>;
+
+    /// @brief Resume a socket that was blocked by a full kernel send buffer.
+    void on_writable(StreamSocket&, Clock::time_point now);
+
+    /// @brief Whether `sock` waits for writability; watch it with the selector until `on_writable()`.
+    bool is_blocked(const StreamSocket&) const;
+
+    auto get_pending_send_length(const StreamSocket&) const -> std::size_t;
+
+    void set_send_error_handler(SendErrorHandler);
+
+private:
+    struct Entry
+    {
+        explicit Entry(TokenBucket bucket) : bucket(bucket)
+        {
+        }
+
+        TokenBucket bucket;
+
+        std::deque<std::vector<std::byte>> chunks;
+        std::size_t first_chunk_offset = 0;
+        std::size_t length = 0; // unsent bytes of all chunks
+
+        bool blocked = false;
+        std::uint64_t schedule_id = 0; // matches the live heap item; older ones are stale
+    };
+
+    struct Wakeup
+    {
+        Clock::time_point time;
+        StreamSocket* socket;
+        std::uint64_t schedule_id;
+
+        // for a min-heap with the `std::*_heap()` functions
+        bool operator<(const Wakeup& other) const
+        {
+            return time > other.time;
+        }
+    };
+
+private:
+    void flush(StreamSocket&, Entry&, Clock::time_point now, std::error_code&);
+
+    static auto get_min_send_length(const Entry&) -> std::size_t;
+    void schedule_refill(StreamSocket&, Entry&, std::size_t min_length, Clock::time_point now);
+    void schedule(StreamSocket&, Entry&, Clock::time_point time);
+    bool is_stale(const Wakeup&) const;
+
+private:
+    std::unordered_map<const StreamSocket*, Entry> _entries;
+
+    std::vector<Wakeup> _wakeups; // min-heap, with lazily skipped stale items
+    std::uint64_t _next_schedule_id = 1;
+
+    SendErrorHandler _send_error_handler;
+};
+
+} // namespace ds
@@ -16,6 +16,7 @@
 
 #include <WS2tcpip.h>
 #include <WinSock2.h>
+#include <afunix.h>
 
 #else // POSIX
 
@@ -28,6 +29,7 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/uio.h>
+#include <sys/un.h>
 #include <unistd.h>
 
 using SOCKET = int;
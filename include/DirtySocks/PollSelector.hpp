@@ -0,0 +1,157 @@
+#pragma once
+
+#include "DirtySocks/EnumAsFlags.hpp"
+#include "DirtySocks/PlatformSocket.hpp"
+#include "DirtySocks/SpinStats.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace ds
+{
+
+class Socket;
+
+enum class PollInterest
+{
+    NONE = 0,
+
+    READ = (1 << 0),
+    WRITE = (1 << 1),
+    EXCEPT = (1 << 2), // out-of-band data
+};
+
+ENUM_AS_FLAGS(PollInterest);
+
+/// @brief `::poll()` based selector, with the same API as `SocketSelector`.
+///
+/// Unlike `SocketSelector`, there's no limit on the number of sockets nor on the descriptor values.
+///
+/// Registrations are kept in a contiguous `pollfd` array with a parallel token array,
+/// and removal is O(1) swap-and-pop via a socket-to-index map.
+///
+/// Each socket can carry a 64-bit token (defaults to its handle), which `for_each_ready()` hands back.
+class PollSelector final
+{
+public:
+    struct Ready
+    {
+        std::uint64_t token;
+        bool read;
+        bool write;
+        bool except;
+    };
+
+public:
+    /// @return number of sockets with any events
+    int select(timeval* timeout, std::error_code&);
+
+    // result is never changed until another `select()` is called
+    bool has_read(const Socket&) const;
+    bool has_write(const Socket&) const;
+    bool has_except(const Socket&) const;
+
+    /// @brief Calls `func(const Ready&)` for each socket with any events in the last `select()`.
+    ///
+    /// Sockets can be added or removed within `func`; Removed ones are not reported afterwards,
+    /// and added ones are not reported until the next `select()`.
+    template <typename Func>
+    void for_each_ready(Func&& func);
+
+public:
+    void add_to_read_set(const Socket&, std::error_code&);
+    void add_to_write_set(const Socket&, std::error_code&);
+    void add_to_except_set(const Socket&, std::error_code&);
+
+    void remove_from_read_set(const Socket&);
+    void remove_from_write_set(const Socket&);
+    void remove_from_except_set(const Socket&);
+
+    void clear_read_set();
+    void clear_write_set();
+    void clear_except_set();
+
+    /// @brief Adds `interest` to the socket, and sets its token.
+    void add(const Socket&, PollInterest interest, std::uint64_t token, std::error_code&);
+
+    /// @brief Removes the socket from all sets.
+    void remove(const Socket&);
+
+public:
+    auto read_set_count() -> std::size_t;
+    auto write_set_count() -> std::size_t;
+    auto except_set_count() -> std::size_t;
+
+public:
+    /// @brief Low-latency mode: poll non-blockingly for `spin_duration` before falling back to the blocking wait.
+    ///
+    /// This trades CPU time for the scheduler wake-up latency; check `get_spin_stats()` for the cost.
+    /// (`0` disables spinning, which is the default)
+    void set_spin_duration(std::chrono::microseconds spin_duration);
+    auto get_spin_duration() const -> std::chrono::microseconds;
+
+    auto get_spin_stats() const -> const SpinStats&;
+    void reset_spin_stats();
+
+private:
+    int poll_once(timeval* timeout, std::error_code&);
+
+    void add_interest(SOCKET, short events, const std::uint64_t* token);
+    void remove_interest(SOCKET, short events);
+    void clear_interest(short events);
+
+    void erase_at(std::size_t index);
+    void compact();
+
+    auto find(const Socket&) const -> const pollfd*;
+    auto get_ready(std::size_t index) const -> Ready;
+
+private:
+    std::vector<pollfd> _pollfds;
+    std::vector<std::uint64_t> _tokens; // parallel to `_pollfds`
+    std::unordered_map<SOCKET, std::size_t> _indices;
+
+    std::size_t _read_count = 0;
+    std::size_t _write_count = 0;
+    std::size_t _except_count = 0;
+
+    // removals within `for_each_ready()` leave holes here, to keep the indices stable
+    bool _iterating = false;
+    std::size_t _holes_count = 0;
+
+    std::chrono::microseconds _spin_duration{0};
+    SpinStats _spin_stats;
+};
+
+template <typename Func>
+void PollSelector::for_each_ready(Func&& func)
+{
+    struct IterationGuard
+    {
+        bool& iterating;
+        ~IterationGuard()
+        {
+            iterating = false;
+        }
+    };
+
+    _iterating = true;
+    IterationGuard guard{_iterating};
+
+    // elements added within `func` are appended with no events, so they're skipped anyway
+    for (std::size_t i = 0; i < _pollfds.size(); ++i)
+    {
+        if (0 == _pollfds[i].revents || INVALID_SOCKET == _pollfds[i].fd)
+            continue;
+
+        const Ready ready = get_ready(i);
+        if (ready.read || ready.write || ready.except)
+            func(ready);
+    }
+}
+
+} // namespace ds
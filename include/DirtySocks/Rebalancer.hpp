@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace ds
+{
+
+class Runtime;
+
+struct RebalancerConfig
+{
+    std::chrono::milliseconds period{1000};
+
+    /// a loop busier than this (fraction of the period) sheds connections...
+    double high_utilization = 0.75;
+
+    /// ...to the least busy loop, if that one is less busy by at least this much
+    double min_difference = 0.25;
+};
+
+/// @brief Moves hot connections off overloaded `EventLoop`s of a `Runtime`.
+///
+/// Each period, it compares how busy the loops were, and if the busiest one is over the threshold,
+/// it asks that loop to shed its hottest connections (by handling time) to the least busy one,
+/// worth half the difference between them. Loops opt in with `EventLoop::set_shed_handler()`.
+///
+/// It only reads the loops' busy times, and posts to their mailboxes.
+class Rebalancer final
+{
+public:
+    /// @param runtime already started, and outliving this
+    explicit Rebalancer(Runtime& runtime, RebalancerConfig config = {});
+
+    /// @brief `stop()`
+    ~Rebalancer();
+
+    Rebalancer(const Rebalancer&) = delete;
+    Rebalancer& operator=(const Rebalancer&) = delete;
+
+public:
+    /// @brief Call `rebalance()` every period, on a thread of its own.
+    void start();
+    void stop();
+
+    /// @brief Compare the loops since the last call, and have the busiest one shed load if needed.
+    ///
+    /// The first call only takes the baseline. Call it either directly, or with `start()`, not both.
+    void rebalance(std::error_code&);
+
+    /// @return busy fraction of the loop in the last `rebalance()` window
+    auto get_utilization(std::size_t loop_index) const -> double;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    Runtime& _runtime;
+    const RebalancerConfig _config;
+
+    std::vector<std::chrono::nanoseconds> _last_busy_times;
+    Clock::time_point _last_time;
+    std::vector<double> _utilizations;
+
+    std::thread _thread;
+    mutable std::mutex _mutex; // guards the rebalancing state & `_stopping`
+    std::condition_variable _stop_cv;
+    bool _stopping = false;
+};
+
+} // namespace ds
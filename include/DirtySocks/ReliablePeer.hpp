@@ -0,0 +1,229 @@
+#pragma once
+
+#include "DirtySocks/SequenceBuffer.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <vector>
+
+namespace ds
+{
+
+class SocketAddress;
+class UdpSocket;
+
+enum class ChannelDelivery
+{
+    /// may be lost, duplicated or reordered
+    UNRELIABLE,
+
+    /// may be lost, but never older than one already delivered (e.g. state snapshots)
+    UNRELIABLE_SEQUENCED,
+
+    /// resent until acked, and delivered in order (of its own channel only)
+    RELIABLE_ORDERED,
+};
+
+/// @brief Both peers must use the same one.
+struct ReliablePeerConfig
+{
+    std::vector<ChannelDelivery> channels{ChannelDelivery::RELIABLE_ORDERED, ChannelDelivery::UNRELIABLE_SEQUENCED,
+                                          ChannelDelivery::UNRELIABLE};
+
+    /// datagram length, within the path MTU to avoid IP fragmentation (1200 fits the IPv6 minimum of 1280)
+    std::size_t max_packet_length = 1200;
+
+    /// capped to what fits a packet along with the headers
+    std::size_t max_message_length = 1024;
+
+    /// unacked messages per reliable channel, rounded up to a power of two; the receiver buffers as many out of order
+    std::size_t reliable_window = 64;
+
+    /// bytes of unreliable messages queued until the next `write_packet()`
+    std::size_t unreliable_queue_length = 16 * 1024;
+
+    std::chrono::milliseconds initial_rto{100};
+    std::chrono::milliseconds min_rto{10};
+    std::chrono::milliseconds max_rto{1000};
+};
+
+struct ReliablePeerStats
+{
+    std::uint64_t packets_sent = 0;
+    std::uint64_t packets_received = 0;
+    std::uint64_t packets_acked = 0;
+    std::uint64_t packets_lost = 0; // unacked while later ones were
+    std::uint64_t messages_resent = 0;
+};
+
+/// @brief One side of a message channel over a datagram socket, with optional reliability, like for realtime games.
+///
+/// Several `ChannelDelivery` channels share a single stream of packets, so a lost reliable message only holds up
+/// its own channel, instead of everything behind it like with TCP.
+///
+/// Each packet packs as many queued messages as fit, and acks the last 32 received packets with a bitfield,
+/// so a single packet that gets through acks all of those. A reliable message is resent when its packet is acked
+/// neither within the RTO (from the smoothed RTT, like TCP), nor along with 3 later ones (fast resend).
+///
+/// It's transport-agnostic: feed it received datagrams with `read_packet()`, and send what `write_packet()` writes
+/// (or `flush()` it to a `UdpSocket`). Time is always passed in, so a whole event loop can share one clock reading.
+///
+/// All the memory is allocated up front, so nothing is allocated in the steady state.
+///
+/// Wire format, in little-endian:
+/// * packet: `[sequence:16][ack:16][ack bits:32]` then messages; ack bit `i` acks packet `ack - i`
+/// * message: `[channel:8][message id:16][length:16][payload]`
+class ReliablePeer final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief Called for each delivered message, from `read_packet()`; it must not destroy this peer.
+    using MessageHandler = std::function<void(std::size_t channel, std::span<const std::byte> message)>;
+
+    static constexpr std::size_t PACKET_HEADER_LENGTH = 8;
+    static constexpr std::size_t MESSAGE_HEADER_LENGTH = 5;
+
+public:
+    explicit ReliablePeer(ReliablePeerConfig config = {});
+
+    void set_message_handler(MessageHandler);
+
+public:
+    /// @brief Queue `message` on `channel`, to be sent by the next `write_packet()`s.
+    ///
+    /// Errors:
+    /// * `SystemErrc::invalid_argument`: no such channel
+    /// * `SystemErrc::message_size`: longer than `max_message_length`
+    /// * `SystemErrc::no_buffer_space`: the reliable window, or the unreliable queue, is full
+    void send(std::size_t channel, std::span<const std::byte> message, std::error_code&);
+
+    /// @brief Write the next packet, if there's anything to send.
+    ///
+    /// That's queued & due messages, or an ack of the packets received since the last one.
+    ///
+    /// @param packet at least `max_packet_length` long
+    /// @return `false` if there was nothing to send
+    bool write_packet(std::span<std::byte> packet, std::size_t& packet_length, Clock::time_point now);
+
+    /// @brief Process the acks of a received datagram, and deliver its messages to the handler.
+    ///
+    /// Duplicate packets are ignored. A malformed one sets `StreamErrc::MALFORMED_FRAME`,
+    /// after delivering the messages before the malformed part.
+    void read_packet(std::span<const std::byte> packet, Clock::time_point now, std::error_code&);
+
+    /// @brief Send packets to `remote` until there's nothing left to send.
+    ///
+    /// A datagram that would block is dropped like it was lost on the way, so it's not an error.
+    void flush(UdpSocket& socket, const SocketAddress& remote, Clock::time_point now, std::error_code&);
+
+    /// @brief `flush()` to the connected address of `socket`.
+    void flush(UdpSocket& socket, Clock::time_point now, std::error_code&);
+
+public:
+    /// @return when the earliest unacked reliable message is due for a resend, to `flush()` again by then
+    auto get_resend_time() const -> std::optional<Clock::time_point>;
+
+    /// @return smoothed RTT, `0` until the first sample
+    auto get_rtt() const -> Clock::duration;
+    auto get_rto() const -> Clock::duration;
+
+    auto get_stats() const -> const ReliablePeerStats&;
+
+private:
+    struct MessageRef
+    {
+        std::uint8_t channel;
+        std::uint16_t id;
+    };
+
+    static constexpr std::size_t MAX_RELIABLE_PER_PACKET = 32;
+
+    struct SentPacket
+    {
+        Clock::time_point sent_time;
+        bool acked;
+        bool lost;
+        std::uint8_t reliable_count;
+        std::array<MessageRef, MAX_RELIABLE_PER_PACKET> reliable;
+    };
+
+    struct ReceivedPacket
+    {
+    };
+
+    struct PendingMessage
+    {
+        std::vector<std::byte> data; // sized to `max_message_length` up front
+        std::size_t length = 0;
+        Clock::time_point resend_time;
+        std::uint16_t packet_sequence = 0; // where it was last sent
+        std::uint32_t send_count = 0;
+    };
+
+    struct Channel
+    {
+        ChannelDelivery delivery;
+        std::uint16_t next_send_id = 0;
+
+        // reliable only
+        std::uint16_t oldest_unacked_id = 0;
+        SequenceBuffer<PendingMessage> send_window;
+        std::uint16_t next_receive_id = 0;
+        SequenceBuffer<PendingMessage> receive_window; // arrived ahead of `next_receive_id`
+
+        // sequenced only
+        bool received_any = false;
+        std::uint16_t last_receive_id = 0;
+    };
+
+private:
+    void send_packets(UdpSocket&, const SocketAddress*, Clock::time_point now, std::error_code&);
+
+    /// @param sample_rtt only for the packet the ack names, as the ones acked through its bitfield
+    /// may have waited for a lost ack
+    void process_ack(std::uint16_t sequence, bool sample_rtt, Clock::time_point now);
+    void ack_message(const MessageRef&);
+    void resend_lost(std::uint16_t sequence, Clock::time_point now);
+
+    /// @return `false` if malformed
+    bool deliver_messages(std::span<const std::byte> messages);
+    void deliver_reliable(Channel&, std::size_t channel, std::uint16_t id, std::span<const std::byte> message);
+
+    void update_rtt(Clock::duration sample);
+    auto get_backoff_rto(std::uint32_t send_count) const -> Clock::duration;
+
+private:
+    const ReliablePeerConfig _config;
+
+    MessageHandler _message_handler;
+    std::vector<Channel> _channels;
+
+    std::uint16_t _next_packet_sequence = 0;
+    SequenceBuffer<SentPacket> _sent_packets;
+
+    bool _received_any = false;
+    std::uint16_t _remote_sequence = 0; // latest received
+    SequenceBuffer<ReceivedPacket> _received_packets;
+    bool _ack_pending = false;
+
+    std::vector<std::byte> _unreliable_queue; // encoded messages, up to `_unreliable_length`
+    std::size_t _unreliable_length = 0;
+
+    std::vector<std::byte> _packet_buffer; // for `flush()`
+
+    bool _has_rtt = false;
+    Clock::duration _srtt{0};
+    Clock::duration _rttvar{0};
+    Clock::duration _rto;
+
+    ReliablePeerStats _stats;
+};
+
+} // namespace ds
@@ -0,0 +1,284 @@
+#pragma once
+
+#include "DirtySocks/LengthPrefixedFramer.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ds
+{
+
+class StreamSocket;
+
+/// @brief Both peers must use the same one.
+struct RpcConfig
+{
+    FrameChecksum checksum = FrameChecksum::NONE;
+
+    /// of a whole message, header included
+    std::size_t max_frame_length = LengthPrefixedFramer::DEFAULT_MAX_FRAME_LENGTH;
+
+    /// calls awaiting their responses, beyond which `call()` fails
+    std::size_t max_outstanding_calls = 4096;
+};
+
+struct RpcStats
+{
+    std::uint64_t calls = 0;
+    std::uint64_t calls_timed_out = 0;
+    std::uint64_t responses_received = 0;
+    std::uint64_t late_responses = 0; // to calls already timed out, or failed
+    std::uint64_t requests_received = 0;
+    std::uint64_t responses_sent = 0;
+};
+
+/// @brief Outcome of a call, viewed in the received frame; valid only within the `ResponseHandler`.
+struct RpcResponse
+{
+    /// set locally: `StreamErrc::DEADLINE_EXCEEDED`, or what `fail_all()` was given
+    std::error_code ec;
+
+    /// from the callee: `0` for success, or what it passed to `respond_error()`
+    std::uint16_t status = 0;
+
+    std::span<const std::byte> payload;
+};
+
+/// @brief `RpcResponse`, owning its payload, for futures & coroutines.
+struct RpcResult
+{
+    std::error_code ec;
+    std::uint16_t status = 0;
+    std::vector<std::byte> payload;
+};
+
+struct RpcRequest
+{
+    std::uint32_t stream_id;
+    std::uint16_t method;
+    std::span<const std::byte> payload; // valid only within the `RequestHandler`
+
+    /// caller's deadline, from its remaining time when it arrived; not worth answering past it
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+};
+
+/// @brief Many concurrent calls multiplexed over one stream connection, each tagged with its own stream id.
+///
+/// Calls are pipelined: they're written back to back without waiting for the earlier responses,
+/// and the callee may respond in any order, e.g. as its async work completes. Each response completes
+/// its own call, so a slow one doesn't hold up the others behind it.
+/// Both sides can call each other on the same connection, as each side's stream ids are its own.
+///
+/// Every call has a deadline, after which it fails with `StreamErrc::DEADLINE_EXCEEDED` and its late response
+/// is dropped. The remaining time is sent along, so the callee can skip calls nobody waits for anymore.
+///
+/// It's transport-agnostic like `ReliablePeer`: messages are framed with a `LengthPrefixedFramer`,
+/// and buffered to be sent with `flush()`, so a whole batch of calls goes out in a single send.
+///
+/// Handlers are called from `receive_from()`, `feed()`, `expire()` & `fail_all()`, and may call or respond
+/// right away, but must not destroy this connection. Nothing here is thread-safe.
+///
+/// Wire format, in little-endian, within each frame:
+/// `[stream id:32][kind:8][reserved:8][method or status:16][timeout (ms, 0 for none):32][payload]`
+class RpcConnection final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    using ResponseHandler = std::function<void(const RpcResponse&)>;
+    using RequestHandler = std::function<void(RpcConnection&, const RpcRequest&)>;
+
+    class CallAwaiter;
+
+    static constexpr std::size_t HEADER_LENGTH = 12;
+
+    /// reserved status, e.g. for unknown methods
+    static constexpr std::uint16_t UNHANDLED_STATUS = 0xFFFF;
+
+    /// for calls that never time out
+    static constexpr Clock::time_point NO_DEADLINE = Clock::time_point::max();
+
+public:
+    explicit RpcConnection(RpcConfig config = {});
+
+    /// @brief Fails the outstanding calls with `SystemErrc::operation_canceled`.
+    ///
+    /// Their handlers run from here, and so do `async_call()` coroutines, which must not touch this connection
+    /// once resumed; so rather `fail_all()` first, and let them finish before destroying it.
+    ~RpcConnection();
+
+    RpcConnection(RpcConnection&&) = default;
+    RpcConnection& operator=(RpcConnection&&) = default;
+
+    /// @brief Handle the peer's calls; without it, they're answered with `UNHANDLED_STATUS`.
+    void set_request_handler(RequestHandler);
+
+public:
+    // caller
+
+    /// @brief Queue a call of `method`, whose response (or failure) is passed to `handler` later.
+    ///
+    /// `deadline` is sent as the time remaining since `now`.
+    ///
+    /// Errors, which leave `handler` uncalled:
+    /// * `SystemErrc::no_buffer_space`: `max_outstanding_calls` are already outstanding
+    /// * `StreamErrc::FRAME_TOO_LONG`: `payload` doesn't fit `max_frame_length`
+    ///
+    /// @return stream id of the call
+    auto call(std::uint16_t method, std::span<const std::byte> payload, Clock::time_point deadline,
+              Clock::time_point now, ResponseHandler handler, std::error_code&) -> std::uint32_t;
+
+    /// @brief `call()`, completing a future instead, e.g. to hand the result over to another thread.
+    ///
+    /// The future is always valid; on error, it's ready right away with the same error.
+    auto call(std::uint16_t method, std::span<const std::byte> payload, Clock::time_point deadline,
+              Clock::time_point now, std::error_code&) -> std::future<RpcResult>;
+
+    /// @brief `call()` from a coroutine: `RpcResult result = co_await connection.async_call(...);`
+    ///
+    /// The coroutine is resumed by whatever completes the call, on this connection's thread.
+    /// `payload` is sent before suspending, so it only has to live until then.
+    auto async_call(std::uint16_t method, std::span<const std::byte> payload, Clock::time_point deadline,
+                    Clock::time_point now) -> CallAwaiter;
+
+public:
+    // callee
+
+    /// @brief Answer the peer's call `stream_id`, at any time and in any order.
+    void respond(std::uint32_t stream_id, std::span<const std::byte> payload, std::error_code&);
+
+    /// @brief Answer the peer's call `stream_id` with an app-defined failure, which must not be `0`.
+    void respond_error(std::uint32_t stream_id, std::uint16_t status, std::error_code&);
+
+public:
+    // I/O
+
+    /// @brief Receive once from `socket`, and handle every complete message.
+    ///
+    /// Same as `StreamSocket::receive()`, so `received_length == 0` means the peer closed the stream:
+    /// `fail_all()` then. Malformed messages set `StreamErrc::MALFORMED_FRAME`, and the connection is unusable.
+    void receive_from(StreamSocket& socket, std::size_t& received_length, Clock::time_point now, std::error_code&);
+
+    /// @brief Handle every complete message of `data`, received some other way.
+    void feed(const void* data, std::size_t length, Clock::time_point now, std::error_code&);
+
+    /// @brief Send the buffered messages, as much as the socket takes now.
+    ///
+    /// Would-block isn't an error: it stops with the rest still buffered, so watch the socket for writability.
+    void flush(StreamSocket& socket, std::size_t& sent_length, std::error_code&);
+
+    /// @brief Fail the calls past their deadlines with `StreamErrc::DEADLINE_EXCEEDED`.
+    void expire(Clock::time_point now);
+
+    /// @brief Fail every outstanding call with `ec`, e.g. once the connection is closed.
+    void fail_all(const std::error_code& ec);
+
+public:
+    /// @return earliest deadline of the outstanding calls, to `expire()` by then
+    auto get_next_deadline() -> std::optional<Clock::time_point>;
+
+    auto get_outstanding_count() const -> std::size_t;
+
+    /// @return bytes waiting for `flush()`
+    auto get_send_buffered_length() const -> std::size_t;
+
+    auto get_stats() const -> const RpcStats&;
+
+private:
+    enum class Kind : std::uint8_t
+    {
+        REQUEST = 1,
+        RESPONSE = 2,
+    };
+
+    struct Call
+    {
+        ResponseHandler handler;
+        Clock::time_point deadline;
+    };
+
+    struct Deadline
+    {
+        Clock::time_point time;
+        std::uint32_t stream_id;
+
+        // min-heap
+        bool operator<(const Deadline& other) const
+        {
+            return time > other.time;
+        }
+    };
+
+private:
+    void append_message(std::uint32_t stream_id, Kind, std::uint16_t method_or_status, std::uint32_t timeout_ms,
+                        std::span<const std::byte> payload, std::error_code&);
+
+    void handle_frames(Clock::time_point now, std::error_code&);
+    bool handle_frame(std::span<const std::byte> frame, Clock::time_point now);
+
+    void complete(std::uint32_t stream_id, const RpcResponse&);
+
+    void pop_stale_deadlines();
+
+private:
+    RpcConfig _config;
+    RequestHandler _request_handler;
+
+    LengthPrefixedFramer _framer;
+
+    std::vector<std::byte> _send_buffer; // framed messages, sent from `_send_offset`
+    std::size_t _send_offset = 0;
+
+    std::uint32_t _next_stream_id = 1;
+    std::unordered_map<std::uint32_t, Call> _calls;
+    std::vector<Deadline> _deadlines; // heap, with entries of completed calls left until they surface
+
+    RpcStats _stats;
+};
+
+class RpcConnection::CallAwaiter final
+{
+public:
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    /// @return `false` to resume right away, if the call couldn't be made
+    bool await_suspend(std::coroutine_handle<> handle);
+
+    auto await_resume() -> RpcResult
+    {
+        return std::move(_result);
+    }
+
+private:
+    friend class RpcConnection;
+
+    CallAwaiter(RpcConnection& connection, std::uint16_t method, std::span<const std::byte> payload,
+                Clock::time_point deadline, Clock::time_point now)
+        : _connection(connection), _method(method), _payload(payload), _deadline(deadline), _now(now)
+    {
+    }
+
+private:
+    RpcConnection& _connection;
+    std::uint16_t _method;
+    std::span<const std::byte> _payload;
+    Clock::time_point _deadline;
+    Clock::time_point _now;
+
+    RpcResult _result;
+};
+
+} // namespace ds
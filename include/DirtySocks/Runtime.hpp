@@ -0,0 +1,84 @@
+#pragma once
+
+#include "DirtySocks/EventLoop.hpp"
+#include "DirtySocks/SocketAddress.hpp"
+#include "DirtySocks/SocketOptions.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace ds
+{
+
+struct RuntimeConfig
+{
+    /// CPUs to run a loop on, one each (empty for every CPU the process may run on)
+    std::vector<unsigned> cpus;
+
+    /// each loop listens on it with its own `SO_REUSEPORT` listener, so the kernel spreads connections among them
+    std::optional<SocketAddress> listen_address;
+    int listen_backlog = SOMAXCONN;
+
+    /// for the listeners, and so the accepted connections (`SO_REUSEPORT` is always set)
+    SocketOptions listen_options;
+
+    /// bytes each loop pre-faults for `EventLoop::get_memory_resource()`; beyond that, it allocates as needed
+    std::size_t arena_size = 4 * 1024 * 1024;
+};
+
+/// @brief Thread-per-core runtime: one `EventLoop` per CPU, each on its own pinned thread.
+///
+/// Loops share nothing; they talk only by posting tasks to each other's `Mailbox`.
+///
+/// Threads are pinned on Linux & Windows; elsewhere, they're left to the scheduler.
+class Runtime final
+{
+public:
+    /// @brief Runs on each loop's thread once all loops are set up, e.g. to set the loop's event handler.
+    using InitHandler = std::function<void(EventLoop&)>;
+
+public:
+    Runtime() = default;
+
+    /// @brief `stop()`, ignoring its error.
+    ~Runtime();
+
+    Runtime(const Runtime&) = delete;
+    Runtime& operator=(const Runtime&) = delete;
+
+public:
+    /// @brief Spawn & pin the loops, and wait until they're all set up.
+    ///
+    /// If any of them fails (e.g. to pin or listen), all are stopped and its error is set.
+    void start(const RuntimeConfig&, InitHandler, std::error_code&);
+
+    /// @brief Stop & join the loops, after they run the tasks posted before.
+    ///
+    /// Tear down per-loop state by posting to each loop first.
+    /// A selector or mailbox error ends a loop early; the first such error is set to `ec`.
+    void stop(std::error_code&);
+
+    /// @brief Run `task` on loop `loop_index`. (any thread)
+    void post(std::size_t loop_index, EventLoop::Task task, std::error_code&);
+
+    auto get_loops_count() const -> std::size_t;
+
+    /// @brief Only use a loop on its own thread (e.g. in a task posted to it), except for its thread-safe getters.
+    auto get_loop(std::size_t loop_index) -> EventLoop&;
+
+public:
+    /// @return CPUs the process may run on
+    static auto get_available_cpus() -> std::vector<unsigned>;
+
+private:
+    std::vector<std::unique_ptr<EventLoop>> _loops;
+    std::vector<std::thread> _threads;
+    std::vector<std::error_code> _exit_errors; // parallel to `_loops`, written by their threads
+};
+
+} // namespace ds
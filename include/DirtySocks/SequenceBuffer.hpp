@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ds
+{
+
+/// @return whether 16-bit sequence `a` comes after `b`, across the wrap-around
+constexpr bool is_sequence_newer(std::uint16_t a, std::uint16_t b)
+{
+    return a != b && static_cast<std::uint16_t>(a - b) < 0x8000;
+}
+
+/// @brief Fixed ring of entries, indexed by 16-bit sequence numbers.
+///
+/// A sequence shares its slot with the ones `capacity` apart, so inserting a newer one evicts the older.
+/// Entries are never destroyed, only reused, so their memory (e.g. a buffer sized up front) is too.
+template <typename T>
+class SequenceBuffer final
+{
+public:
+    /// @param capacity rounded up to a power of two (up to 65536), so slots stay consistent across the wrap-around
+    /// @param prototype copied into every slot
+    explicit SequenceBuffer(std::size_t capacity, const T& prototype = T{})
+        : _entries(std::bit_ceil(std::clamp<std::size_t>(capacity, 1, 0x10000)), prototype),
+          _sequences(_entries.size(), EMPTY)
+    {
+    }
+
+public:
+    /// @brief Claim the slot of `sequence`.
+    /// @return its entry, still holding whatever it held before
+    auto insert(std::uint16_t sequence) -> T&
+    {
+        const std::size_t index = get_index(sequence);
+        _sequences[index] = sequence;
+        return _entries[index];
+    }
+
+    /// @return `nullptr` if `sequence` isn't in its slot
+    auto find(std::uint16_t sequence) -> T*
+    {
+        const std::size_t index = get_index(sequence);
+        return (_sequences[index] == sequence) ? &_entries[index] : nullptr;
+    }
+
+    auto find(std::uint16_t sequence) const -> const T*
+    {
+        const std::size_t index = get_index(sequence);
+        return (_sequences[index] == sequence) ? &_entries[index] : nullptr;
+    }
+
+    bool contains(std::uint16_t sequence) const
+    {
+        return _sequences[get_index(sequence)] == sequence;
+    }
+
+    void remove(std::uint16_t sequence)
+    {
+        const std::size_t index = get_index(sequence);
+        if (_sequences[index] == sequence)
+            _sequences[index] = EMPTY;
+    }
+
+    void clear()
+    {
+        _sequences.assign(_sequences.size(), EMPTY);
+    }
+
+    auto get_capacity() const -> std::size_t
+    {
+        return _entries.size();
+    }
+
+private:
+    auto get_index(std::uint16_t sequence) const -> std::size_t
+    {
+        return sequence & (_entries.size() - 1);
+    }
+
+private:
+    static constexpr std::uint32_t EMPTY = UINT32_MAX; // no 16-bit sequence
+
+    std::vector<T> _entries;
+    std::vector<std::uint32_t> _sequences;
+};
+
+} // namespace ds
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+namespace ds
+{
+
+class OutboundQueue;
+
+/// @brief Immutable, reference-counted bytes, to queue the same payload to many sockets without copying it.
+///
+/// The count and the bytes share one allocation, and copying a `SharedBuffer` just bumps the count,
+/// so it can sit in any number of `OutboundQueue`s (on any threads) at once, and is freed after the last one.
+class SharedBuffer final
+{
+public:
+    SharedBuffer() = default;
+    ~SharedBuffer();
+
+    SharedBuffer(const SharedBuffer&) noexcept;
+    SharedBuffer& operator=(const SharedBuffer&) noexcept;
+
+    SharedBuffer(SharedBuffer&&) noexcept;
+    SharedBuffer& operator=(SharedBuffer&&) noexcept;
+
+public:
+    static auto copy_from(const void* data, std::size_t length) -> SharedBuffer;
+
+    /// @brief Allocate `length` bytes and let `fill(std::span<std::byte>)` write them, before anyone can share them.
+    template <typename Fill>
+    static auto create(std::size_t length, Fill&& fill) -> SharedBuffer;
+
+public:
+    auto data() const -> const std::byte*;
+    auto size() const -> std::size_t;
+    bool empty() const;
+
+    auto as_span() const -> std::span<const std::byte>;
+
+    /// @return number of `SharedBuffer`s sharing the bytes (`0` if empty)
+    auto get_use_count() const -> std::uint32_t;
+
+private:
+    friend void broadcast(const SharedBuffer&, std::span<OutboundQueue* const>);
+
+    struct Header
+    {
+        std::atomic<std::uint32_t> use_count;
+        std::size_t length;
+    };
+
+    explicit SharedBuffer(Header* header) : _header(header)
+    {
+    }
+
+    static auto allocate(std::size_t length) -> Header*;
+    static auto get_bytes(Header*) -> std::byte*;
+
+    void release();
+
+private:
+    Header* _header = nullptr;
+};
+
+template <typename Fill>
+auto SharedBuffer::create(std::size_t length, Fill&& fill) -> SharedBuffer
+{
+    Header* header = allocate(length);
+    std::forward<Fill>(fill)(std::span<std::byte>(get_bytes(header), length));
+    return SharedBuffer(header);
+}
+
+} // namespace ds
@@ -5,6 +5,8 @@
 #include "DirtySocks/IpVersion.hpp"
 #include "DirtySocks/SocketAddress.hpp"
 
+#include <chrono>
+#include <cstdint>
 #include <optional>
 #include <system_error>
 
@@ -30,10 +32,30 @@ public:
 public:
     void close();
 
+    /// @brief Give up the ownership of the handle, without closing it. (e.g. to `BasicSocket::adopt()` it)
+    auto release() -> SOCKET;
+
 public:
+    /// @brief Set non-blocking mode.
+    ///
+    /// If the OS socket is not created yet (e.g. before `TcpSocket::connect()`), it's applied on creation.
     void set_non_blocking(bool non_blocking, std::error_code&);
     bool is_non_blocking() const;
 
+public:
+    /// @brief Busy-poll the device queue for up to `budget` on blocking receives, instead of sleeping right away.
+    /// (`SO_BUSY_POLL`, and `SO_PREFER_BUSY_POLL` if `prefer` is `true`)
+    ///
+    /// Raising the budget might require `CAP_NET_ADMIN`.
+    /// This is Linux only, otherwise `SystemErrc::operation_not_supported` is set.
+    void set_busy_poll(std::chrono::microseconds budget, bool prefer, std::error_code&);
+
+    /// @brief Cap the egress rate in bytes per second, paced by the kernel. (`SO_MAX_PACING_RATE`)
+    ///
+    /// TCP paces itself, but other protocols need the `fq` qdisc on the egress device.
+    /// This is Linux only, otherwise `SystemErrc::operation_not_supported` is set; see `PacedSender` for those.
+    void set_max_pacing_rate(std::uint64_t bytes_per_second, std::error_code&);
+
 public:
     auto get_local_address(std::error_code&) const -> std::optional<SocketAddress>;
 
@@ -51,10 +73,23 @@ protected:
     Socket(SOCKET, bool non_blocking);
 
     void init_handle(IpVersion, Protocol, std::error_code&);
+    void init_handle(int family, Protocol, std::error_code&);
 
 private:
     SOCKET _handle = INVALID_SOCKET;
     bool _non_blocking = false;
 };
 
+// trivial accessors are inlined, as they're called on every selector & send/receive call
+
+inline bool Socket::is_non_blocking() const
+{
+    return _non_blocking;
+}
+
+inline auto Socket::get_handle() const -> SOCKET
+{
+    return _handle;
+}
+
 } // namespace ds
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "DirtySocks/PlatformSocket.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <system_error>
+
+namespace ds
+{
+
+class Socket;
+
+/// @brief TCP Fast Open option for `TcpListener::listen()`.
+struct TcpFastOpen
+{
+    /// max number of pending TFO requests that haven't completed the handshake yet
+    /// (ignored on Windows & macOS, where it's just enabled)
+    int queue_length;
+};
+
+/// @brief Probing of idle connections, to find out dead peers. (`SO_KEEPALIVE`)
+struct TcpKeepAlive
+{
+    std::chrono::seconds idle{7200};   // before the first probe (`TCP_KEEPIDLE`)
+    std::chrono::seconds interval{75}; // between probes (`TCP_KEEPINTVL`)
+    int count = 9;                     // unanswered probes before dropping the connection (`TCP_KEEPCNT`)
+};
+
+/// @brief Typed set of socket options, applied in one go as soon as the socket is created, before it's bound.
+///
+/// Only the options set here are applied. Pass it to `TcpSocket::connect()` or `TcpListener::listen()`, e.g.
+/// `SocketOptions().no_delay().receive_buffer_size(1 << 20)`.
+///
+/// Accepted sockets get the listener's options from the kernel (Linux, Windows & BSDs pass them on),
+/// except `SO_PRIORITY` & `TCP_QUICKACK`, which `TcpListener::accept()` sets again.
+///
+/// An option the platform doesn't support sets `SystemErrc::no_protocol_option`.
+class SocketOptions final
+{
+public:
+    /// @brief Send small writes right away. (`TCP_NODELAY`)
+    auto no_delay(bool enabled = true) -> SocketOptions&;
+
+    /// @brief Kernel buffer sizes, in bytes. (`SO_SNDBUF` & `SO_RCVBUF`)
+    ///
+    /// Set before connecting, so the TCP window scale is negotiated for it. Linux doubles it for its bookkeeping.
+    auto send_buffer_size(int bytes) -> SocketOptions&;
+    auto receive_buffer_size(int bytes) -> SocketOptions&;
+
+    auto keep_alive(TcpKeepAlive) -> SocketOptions&;
+
+    /// @brief Ack right away, instead of waiting to piggyback the ack on a reply. (`TCP_QUICKACK`, Linux only)
+    ///
+    /// The kernel may go back to delayed acks on its own, so set it again after receiving if it matters.
+    auto quick_ack(bool enabled = true) -> SocketOptions&;
+
+    /// @brief Drop the connection once sent data stays unacked for `timeout`. (`TCP_USER_TIMEOUT`, Linux only)
+    auto user_timeout(std::chrono::milliseconds timeout) -> SocketOptions&;
+
+    /// @brief DSCP & ECN bits of sent packets. (`IP_TOS`, or `IPV6_TCLASS`)
+    auto type_of_service(std::uint8_t tos) -> SocketOptions&;
+
+    /// @brief Priority of sent packets among the device queues. (`SO_PRIORITY`, Linux only)
+    auto priority(int priority) -> SocketOptions&;
+
+    auto reuse_address(bool enabled = true) -> SocketOptions&;
+
+    /// @brief See `TcpListener::set_reuse_port()`.
+    auto reuse_port(bool enabled = true) -> SocketOptions&;
+
+public:
+    // for listeners only, ignored by `TcpSocket::connect()`
+
+    /// @brief Wake up `accept()` only once the client sent data, or after `timeout`. (`TCP_DEFER_ACCEPT`, Linux only)
+    auto defer_accept(std::chrono::seconds timeout) -> SocketOptions&;
+
+    /// @brief See `TcpListener::listen()`.
+    auto fast_open(TcpFastOpen) -> SocketOptions&;
+
+public:
+    /// @brief Apply every set option to an already created socket.
+    void apply(Socket&, std::error_code&) const;
+
+private:
+    friend class TcpListener;
+    friend class TcpSocket;
+
+    enum class Target
+    {
+        ANY,
+        CONNECTING,
+        LISTENING,
+        ACCEPTED, // only what isn't inherited from the listener
+    };
+
+    void apply(SOCKET, int family, Target, std::error_code&) const;
+
+private:
+    std::optional<bool> _no_delay;
+    std::optional<int> _send_buffer_size;
+    std::optional<int> _receive_buffer_size;
+    std::optional<TcpKeepAlive> _keep_alive;
+    std::optional<bool> _quick_ack;
+    std::optional<std::chrono::milliseconds> _user_timeout;
+    std::optional<std::uint8_t> _type_of_service;
+    std::optional<int> _priority;
+    std::optional<bool> _reuse_address;
+    std::optional<bool> _reuse_port;
+    std::optional<std::chrono::seconds> _defer_accept;
+    std::optional<TcpFastOpen> _fast_open;
+};
+
+} // namespace ds
@@ -2,6 +2,9 @@
 
 #include "DirtySocks/PlatformSocket.hpp"
 
+#include "DirtySocks/SpinStats.hpp"
+
+#include <chrono>
 #include <cstddef>
 #include <system_error>
 
@@ -44,6 +47,17 @@ public:
     auto write_set_count() -> std::size_t;
     auto except_set_count() -> std::size_t;
 
+public:
+    /// @brief Low-latency mode: poll non-blockingly for `spin_duration` before falling back to the blocking wait.
+    ///
+    /// This trades CPU time for the scheduler wake-up latency; check `get_spin_stats()` for the cost.
+    /// (`0` disables spinning, which is the default)
+    void set_spin_duration(std::chrono::microseconds spin_duration);
+    auto get_spin_duration() const -> std::chrono::microseconds;
+
+    auto get_spin_stats() const -> const SpinStats&;
+    void reset_spin_stats();
+
 private:
     struct Set
     {
@@ -66,10 +80,16 @@ private:
 #endif
     };
 
+private:
+    int select_once(timeval* timeout, std::error_code&);
+
 private:
     Set _read_set;
     Set _write_set;
     Set _except_set;
+
+    std::chrono::microseconds _spin_duration{0};
+    SpinStats _spin_stats;
 };
 
 } // namespace ds
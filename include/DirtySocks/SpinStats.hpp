@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ds
+{
+
+/// @brief Counters of the spin-then-block policy of a selector, to judge its CPU cost.
+struct SpinStats
+{
+    std::uint64_t spin_polls = 0;     // non-blocking polls made while spinning
+    std::uint64_t spin_wakeups = 0;   // selections that found ready sockets while spinning
+    std::uint64_t blocking_waits = 0; // selections that fell back to the blocking kernel wait
+};
+
+} // namespace ds
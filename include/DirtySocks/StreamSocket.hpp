@@ -0,0 +1,81 @@
+#pragma once
+
+#include "DirtySocks/IoBuffer.hpp"
+#include "DirtySocks/Socket.hpp"
+
+#include <cstddef>
+#include <span>
+#include <system_error>
+
+namespace ds
+{
+
+/// @brief Connected stream socket, shared by `TcpSocket` & `UnixSocket`.
+class StreamSocket : public Socket
+{
+public:
+    void send(const void* data, std::size_t data_length, std::size_t& sent_length, std::error_code&);
+    void send(const void* data, std::size_t data_length, std::error_code&);
+
+    void send(std::span<IoBuffer> buffers, std::size_t& sent_length, std::error_code&);
+    void send(std::span<IoBuffer> buffers, std::error_code&);
+
+#ifdef _WIN32
+    void send(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped,
+              LPWSAOVERLAPPED_COMPLETION_ROUTINE completion_routine, std::error_code&);
+    void send(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped, std::error_code&);
+#endif
+
+    void receive(void* data, std::size_t data_length, std::size_t& received_length, std::error_code&);
+
+    void receive(std::span<IoBuffer> buffers, std::size_t& received_length, std::error_code&);
+
+#ifdef _WIN32
+    void receive(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped,
+                 LPWSAOVERLAPPED_COMPLETION_ROUTINE completion_routine, std::error_code&);
+    void receive(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped, std::error_code&);
+#endif
+
+public:
+    /// @brief Send all of `data`, looping over short writes.
+    ///
+    /// On a non-blocking socket, this stops with `SocketErrc::WOULD_BLOCK`;
+    /// resume by calling again with `data + sent_length`.
+    void send_all(const void* data, std::size_t data_length, std::size_t& sent_length, std::error_code&);
+
+    /// @brief Send all of `buffers`, in chunks of at most `MAX_IO_BUFFERS` buffers.
+    ///
+    /// `buffers` is advanced in place past the sent bytes, and it's empty when everything is sent.
+    /// On a non-blocking socket, this stops with `SocketErrc::WOULD_BLOCK`; resume by calling again with the same span.
+    void send_all(std::span<IoBuffer>& buffers, std::size_t& sent_length, std::error_code&);
+
+    /// @brief Receive exactly `data_length` bytes. (with `MSG_WAITALL` on a blocking socket)
+    ///
+    /// If the peer closes the stream before that, `StreamErrc::END_OF_STREAM` is set.
+    /// On a non-blocking socket, this stops with `SocketErrc::WOULD_BLOCK`;
+    /// resume by calling again with `data + received_length`.
+    void receive_exact(void* data, std::size_t data_length, std::size_t& received_length, std::error_code&);
+
+    /// @brief Fill all of `buffers`, in chunks of at most `MAX_IO_BUFFERS` buffers.
+    ///
+    /// `buffers` is advanced in place past the received bytes, and it's empty when everything is received.
+    void receive_exact(std::span<IoBuffer>& buffers, std::size_t& received_length, std::error_code&);
+
+public:
+    /// @brief Bytes received by the kernel but not read yet. (`FIONREAD`)
+    auto get_receive_queue_length(std::error_code&) const -> std::size_t;
+
+    /// @brief Bytes in the kernel send queue, both unsent & unacknowledged ones.
+    ///
+    /// `SIOCOUTQ` on Linux, `SO_NWRITE` on Apple platforms, otherwise `SystemErrc::operation_not_supported` is set.
+    auto get_send_queue_length(std::error_code&) const -> std::size_t;
+
+protected:
+    StreamSocket() = default;
+    StreamSocket(SOCKET, bool non_blocking);
+
+private:
+    void receive_with_flags(std::span<IoBuffer> buffers, int flags, std::size_t& received_length, std::error_code&);
+};
+
+} // namespace ds
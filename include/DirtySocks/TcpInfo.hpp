@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+namespace ds
+{
+
+/// @brief Typed snapshot of the kernel's `TCP_INFO` for a connected `TcpSocket`.
+///
+/// Fields the running kernel doesn't report are left zero.
+/// Sizes & rates are normalized to bytes, so they're comparable across platforms.
+struct TcpInfo
+{
+    std::chrono::microseconds smoothed_rtt{};
+    std::chrono::microseconds rtt_variance{};
+    std::chrono::microseconds min_rtt{};
+
+    std::uint64_t congestion_window = 0; // bytes
+    std::uint32_t send_mss = 0;          // bytes
+
+    /// bytes; none while still in the initial slow start, or if not reported
+    std::optional<std::uint64_t> slow_start_threshold;
+
+    std::uint32_t retransmits = 0;       // consecutive RTO timeouts not yet recovered
+    std::uint32_t total_retransmits = 0; // segments retransmitted over the whole connection
+    std::uint32_t unacked = 0;           // segments in flight
+    std::uint32_t sacked = 0;            // segments selectively acked by the peer
+    std::uint32_t lost = 0;              // segments considered lost
+
+    std::uint64_t bytes_acked = 0;
+    std::uint64_t bytes_received = 0;
+    std::uint32_t not_sent_bytes = 0; // written by us, but not sent yet
+
+    std::uint64_t delivery_rate = 0; // bytes per second
+    std::uint64_t pacing_rate = 0;   // bytes per second
+};
+
+} // namespace ds
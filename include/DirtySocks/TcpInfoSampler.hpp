@@ -0,0 +1,80 @@
+#pragma once
+
+#include "DirtySocks/TcpInfo.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <system_error>
+#include <vector>
+
+namespace ds
+{
+
+class TcpSocket;
+
+/// @brief Periodically polls `TCP_INFO` for a set of sockets.
+///
+/// Call `sample_if_due()` from your event loop; it costs one `getsockopt()` per socket per interval,
+/// and nothing at all between intervals.
+///
+/// This only stores raw pointers to added sockets, so added sockets should outlive this to avoid dangling pointers.
+class TcpInfoSampler final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Sample
+    {
+        TcpInfo info;
+        Clock::time_point sampled_at;
+        std::error_code error; // error of the last sampling on this socket
+    };
+
+public:
+    explicit TcpInfoSampler(Clock::duration interval);
+
+public:
+    /// @brief Sample all sockets, if `interval` has elapsed since the last sampling.
+    /// @return `true` if sampled
+    bool sample_if_due(Clock::time_point now);
+
+    /// @brief Sample all sockets right now.
+    ///
+    /// A failure on one socket doesn't stop the others; it's stored in `Sample::error` instead.
+    void sample(Clock::time_point now);
+
+    /// @return latest sample of the socket, or `nullptr` if it's not added or never sampled yet
+    auto get(const TcpSocket&) const -> const Sample*;
+
+    /// @brief Useful for calculating the timeout of `SocketSelector::select()`.
+    auto get_next_sample_time() const -> Clock::time_point;
+
+    auto get_interval() const -> Clock::duration;
+    void set_interval(Clock::duration);
+
+public:
+    void add(const TcpSocket&);
+    void remove(const TcpSocket&);
+    void clear();
+
+    auto count() const -> std::size_t;
+
+private:
+    struct Entry
+    {
+        const TcpSocket* socket;
+        Sample sample;
+        bool sampled;
+    };
+
+private:
+    auto find(const TcpSocket&) const -> std::vector<Entry>::const_iterator;
+
+private:
+    std::vector<Entry> _entries;
+
+    Clock::duration _interval;
+    Clock::time_point _next_sample_time{};
+};
+
+} // namespace ds
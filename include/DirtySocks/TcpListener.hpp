@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DirtySocks/Socket.hpp"
+#include "DirtySocks/SocketOptions.hpp"
 
 #include <cstdint>
 #include <system_error>
@@ -15,13 +16,34 @@ class TcpListener final : public Socket
 {
 public:
     void listen(const SocketAddress&, int backlog, std::error_code&);
+
+    /// @brief Listen with TCP Fast Open enabled, so clients can carry their first request in the SYN.
+    ///
+    /// If the platform doesn't support it, `SystemErrc::no_protocol_option` is set.
+    void listen(const SocketAddress&, int backlog, TcpFastOpen, std::error_code&);
     void listen(const SocketAddress&, std::error_code&);
 
+    /// @brief Listen with `options` applied before binding; accepted sockets inherit them.
+    void listen(const SocketAddress&, int backlog, const SocketOptions& options, std::error_code&);
+
+    /// @brief Let several listeners bind the same address and port. (`SO_REUSEPORT`)
+    ///
+    /// On Linux, the kernel spreads incoming connections among them, e.g. one listener per event loop.
+    /// It's applied on `listen()`; If the platform doesn't support it, `SystemErrc::no_protocol_option` is set.
+    void set_reuse_port(bool reuse_port, std::error_code&);
+
+    /// @brief Accept a connection, non-blocking if the listener is.
+    ///
+    /// On Linux, it takes a single `accept4()`, with the socket flags set on the spot.
     void accept(TcpSocket& out_socket, SocketAddress&, std::error_code&);
     void accept(TcpSocket& out_socket, std::error_code&);
 
 private:
     void accept(TcpSocket& out_socket, sockaddr*, socklen_t*, std::error_code&);
+
+private:
+    bool _reuse_port = false;
+    SocketOptions _options; // of the last `listen()`, for the accepted sockets
 };
 
 } // namespace ds
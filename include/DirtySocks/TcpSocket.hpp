@@ -1,8 +1,10 @@
 #pragma once
 
-#include "DirtySocks/IoBuffer.hpp"
-#include "DirtySocks/Socket.hpp"
 #include "DirtySocks/SocketAddress.hpp"
+#include "DirtySocks/SocketOptions.hpp"
+#include "DirtySocks/StreamSocket.hpp"
+#include "DirtySocks/TcpInfo.hpp"
+#include "DirtySocks/Timestamping.hpp"
 
 #include <cstddef>
 #include <cstdint>
@@ -13,43 +15,108 @@
 namespace ds
 {
 
-class TcpSocket final : public Socket
+class CorkBatch;
+
+class TcpSocket final : public StreamSocket
 {
 public:
     TcpSocket() = default;
 
+    /// @brief Drops it from its `CorkBatch`, if any.
+    ~TcpSocket() override;
+
+    /// @brief Its `CorkBatch`, if any, follows it.
+    TcpSocket(TcpSocket&&) noexcept;
+    TcpSocket& operator=(TcpSocket&&) noexcept;
+
+public:
+    /// @brief Close, dropping it from its `CorkBatch`, if any, so its handle can't pass for this socket once reused.
+    void close();
+
+    /// @brief Give up the ownership of the handle, uncorked & out of its `CorkBatch`, if any.
+    auto release() -> SOCKET;
+
 public:
     void connect(const SocketAddress&, std::error_code&);
 
-    void send(const void* data, std::size_t data_length, std::size_t& sent_length, std::error_code&);
-    void send(const void* data, std::size_t data_length, std::error_code&);
+    /// @brief Connect with `options` applied first, e.g. the buffer sizes, which must be set before the handshake.
+    void connect(const SocketAddress&, const SocketOptions& options, std::error_code&);
 
-    void send(std::span<IoBuffer> buffers, std::size_t& sent_length, std::error_code&);
-    void send(std::span<IoBuffer> buffers, std::error_code&);
+    /// @brief Connect with TCP Fast Open, carrying the first `data` in the SYN if a TFO cookie is cached.
+    ///
+    /// Without a cookie (or TFO support), this transparently falls back to a regular handshake.
+    /// Check `sent_length`: on a non-blocking socket without a cookie, nothing is sent yet
+    /// (`SystemErrc::operation_in_progress` is set), so send `data` again once the socket is writable.
+    void connect(const SocketAddress&, const void* data, std::size_t data_length, std::size_t& sent_length,
+                 std::error_code&);
 
-#ifdef _WIN32
-    void send(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped,
-              LPWSAOVERLAPPED_COMPLETION_ROUTINE completion_routine, std::error_code&);
-    void send(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped, std::error_code&);
-#endif
+public:
+    using StreamSocket::receive;
 
-    void receive(void* data, std::size_t data_length, std::size_t& received_length, std::error_code&);
+    /// @brief Opt-in kernel timestamping. (`SO_TIMESTAMPING`, software timestamps only)
+    ///
+    /// TX byte offsets count from `0` when TX timestamping is turned on, i.e. called with any TX flag while none
+    /// was set; later calls keep counting. So call it once connected, as the kernel rejects TX flags before.
+    /// This is Linux only, otherwise `SystemErrc::operation_not_supported` is set.
+    void set_timestamping(TimestampingFlags, std::error_code&);
 
-    void receive(std::span<IoBuffer> buffers, std::size_t& received_length, std::error_code&);
+    /// @brief Receive, along with the RX timestamp of the most recent packet among the received data.
+    ///
+    /// `rx_timestamp` is `std::nullopt` if `TimestampingFlags::RX_SOFTWARE` is not enabled.
+    void receive(void* data, std::size_t data_length, std::size_t& received_length,
+                 std::optional<KernelTimestamp>& rx_timestamp, std::error_code&);
+    void receive(std::span<IoBuffer> buffers, std::size_t& received_length,
+                 std::optional<KernelTimestamp>& rx_timestamp, std::error_code&);
 
-#ifdef _WIN32
-    void receive(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped,
-                 LPWSAOVERLAPPED_COMPLETION_ROUTINE completion_routine, std::error_code&);
-    void receive(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped, std::error_code&);
-#endif
+    /// @brief Read pending TX timestamps off the error queue, without blocking.
+    ///
+    /// Call this when the socket reports an error condition (`POLLERR`), or periodically.
+    /// It reads until the error queue is empty or `out_timestamps` is full.
+    void read_tx_timestamps(std::span<TxTimestamp> out_timestamps, std::size_t& read_count, std::error_code&);
 
 public:
     auto get_remote_address(std::error_code&) const -> std::optional<SocketAddress>;
 
+    /// @brief Get a snapshot of `TCP_INFO` (RTT, congestion window, retransmits, delivery rate, ...)
+    ///
+    /// Supported on Linux & Windows 10 1703+, otherwise `SystemErrc::operation_not_supported` is set.
+    auto get_tcp_info(std::error_code&) const -> std::optional<TcpInfo>;
+
+public:
+    /// @brief Bytes in the kernel send queue not sent yet, excluding the unacknowledged ones.
+    ///
+    /// `SIOCOUTQNSD`, Linux only, otherwise `SystemErrc::operation_not_supported` is set.
+    auto get_unsent_length(std::error_code&) const -> std::size_t;
+
+    /// @brief Report the socket as writable only while its unsent bytes are below `bytes`. (`TCP_NOTSENT_LOWAT`)
+    ///
+    /// This keeps the kernel send queue short, so the backlog stays in user space where it can be watched.
+    /// Supported on Linux & Apple platforms, otherwise `SystemErrc::operation_not_supported` is set.
+    void set_not_sent_low_watermark(std::uint32_t bytes, std::error_code&);
+    auto get_not_sent_low_watermark(std::error_code&) const -> std::uint32_t;
+
+public:
+    /// @brief Send small writes right away, instead of holding them back while data is unacked. (`TCP_NODELAY`)
+    ///
+    /// To set it along with other options on connect, see `SocketOptions`.
+    void set_no_delay(bool no_delay, std::error_code&);
+
+    /// @brief Hold back partial segments while corked, and send them when uncorked. (`TCP_CORK`)
+    ///
+    /// Full segments still go out, and Linux sends the rest after 200ms anyway. Prefer `CorkGuard` or `CorkBatch`,
+    /// which can't forget to uncork. This is `TCP_NOPUSH` on BSDs, where some (e.g. macOS) only send the rest
+    /// with the next write; elsewhere, `SystemErrc::operation_not_supported` is set.
+    void set_cork(bool cork, std::error_code&);
+
 private:
+    friend class CorkBatch;
     friend class TcpListener;
+    friend class UnixSocket;
 
     TcpSocket(SOCKET, bool non_blocking);
+
+private:
+    CorkBatch* _cork_batch = nullptr; // corked until the end of its batch
 };
 
 } // namespace ds
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "DirtySocks/Mailbox.hpp"
+#include "DirtySocks/MpscQueue.hpp"
+#include "DirtySocks/WorkStealingDeque.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ds
+{
+
+/// @brief Work-stealing thread pool, to keep CPU-bound handlers off the I/O threads.
+///
+/// Each worker owns a Chase-Lev deque; idle workers steal from the others.
+/// Tasks submitted from outside the pool go through a shared lock-free queue, so I/O threads never block,
+/// and are taken in order by whichever worker is idle first, so none waits behind a busy worker.
+///
+/// Tasks must not throw.
+class ThreadPool final
+{
+public:
+    using Task = std::function<void()>;
+
+public:
+    /// @param workers_count number of worker threads (`0` for `std::thread::hardware_concurrency()`)
+    explicit ThreadPool(std::size_t workers_count = 0);
+
+    /// @brief Run all submitted tasks, and join the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+public:
+    /// @brief Run `task` on a worker. (any thread)
+    void submit(Task task);
+
+    /// @brief Run `work` on a worker, then run `reply(result)` on the thread that owns `reply_to`. (any thread)
+    ///
+    /// This is how an I/O loop offloads a heavy request, and sends the response from its own thread.
+    template <typename Work, typename Reply>
+    void submit(Work work, Mailbox& reply_to, Reply reply);
+
+    auto get_workers_count() const -> std::size_t;
+
+private:
+    struct Worker
+    {
+        WorkStealingDeque<Task*> deque;
+        std::atomic<std::uint32_t> wake_epoch{0};
+        std::atomic<bool> sleeping{false};
+        std::uint32_t steal_seed;
+        std::thread thread;
+    };
+
+private:
+    void run_worker(std::size_t index);
+
+    auto find_task(Worker&) -> Task*;
+    auto take_injected_task() -> Task*;
+    auto steal_task(Worker&) -> Task*;
+
+    void wake(Worker&);
+    void wake_idle_peer();
+
+private:
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    // tasks submitted from outside the pool, consumed by one worker at a time
+    MpscQueue<Task*> _injector;
+    std::atomic<bool> _injector_taken{false};
+
+    std::atomic<std::size_t> _sleeping_count{0};
+    std::atomic<bool> _stopping{false};
+};
+
+template <typename Work, typename Reply>
+void ThreadPool::submit(Work work, Mailbox& reply_to, Reply reply)
+{
+    submit([work = std::move(work), &reply_to, reply = std::move(reply)]() mutable {
+        // mailbox notification never fails short of a broken notifier, and there's no one to report it to here
+        std::error_code ec;
+
+        if constexpr (std::is_void_v<std::invoke_result_t<Work&>>)
+        {
+            work();
+            reply_to.post(std::move(reply), ec);
+        }
+        else
+        {
+            auto result = std::make_shared<std::invoke_result_t<Work&>>(work());
+            reply_to.post([reply = std::move(reply), result = std::move(result)]() mutable { reply(std::move(*result)); },
+                          ec);
+        }
+    });
+}
+
+} // namespace ds
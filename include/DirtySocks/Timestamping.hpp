@@ -0,0 +1,49 @@
+#pragma once
+
+#include "DirtySocks/EnumAsFlags.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+namespace ds
+{
+
+/// @brief Kernel timestamps to record with `SO_TIMESTAMPING`.
+enum class TimestampingFlags
+{
+    NONE = 0,
+
+    RX_SOFTWARE = (1 << 0), // when the packet entered the stack
+    TX_SCHED = (1 << 1),    // when the data entered the packet scheduler (qdisc)
+    TX_SOFTWARE = (1 << 2), // when the data left the stack for the device driver
+    TX_ACK = (1 << 3),      // when all the data was acknowledged by the peer (TCP only)
+
+    TX_ALL = TX_SCHED | TX_SOFTWARE | TX_ACK,
+    ALL = RX_SOFTWARE | TX_ALL,
+};
+
+ENUM_AS_FLAGS(TimestampingFlags);
+
+/// @brief Kernel timestamp (`CLOCK_REALTIME`)
+using KernelTimestamp = std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>;
+
+/// @brief Send-side timestamp, read off the socket error queue.
+struct TxTimestamp
+{
+    enum class Kind
+    {
+        SCHED,
+        SOFTWARE,
+        ACK,
+    };
+
+    Kind kind;
+
+    /// Offset of the last byte of the timestamped `send()` call, counting from `0`
+    /// since TX timestamping was turned on. (wraps around at 2^32)
+    std::uint32_t byte_offset;
+
+    KernelTimestamp timestamp;
+};
+
+} // namespace ds
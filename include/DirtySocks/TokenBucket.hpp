@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ds
+{
+
+/// @brief Token bucket rate limiter, in bytes.
+///
+/// It refills at `rate` bytes per second, up to `burst` bytes.
+/// Time is always passed in, so a whole event loop can share one clock reading.
+///
+/// For datagrams, `try_consume()` each whole datagram; `PacedSender` uses it for stream sockets.
+class TokenBucket final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+public:
+    /// @brief Starts full.
+    TokenBucket(std::uint64_t rate, std::size_t burst, Clock::time_point now);
+
+    auto get_available(Clock::time_point now) -> std::size_t;
+
+    /// @return `false` without consuming anything, if less than `bytes` are available
+    bool try_consume(std::size_t bytes, Clock::time_point now);
+
+    /// @brief Consume up to the available bytes.
+    void consume(std::size_t bytes, Clock::time_point now);
+
+    /// @return how long until `bytes` (capped to `burst`) are available, `0` if they already are,
+    /// or `Clock::duration::max()` if they never will be (`rate == 0`)
+    auto get_wait_time(std::size_t bytes, Clock::time_point now) -> Clock::duration;
+
+public:
+    auto get_rate() const -> std::uint64_t;
+    auto get_burst() const -> std::size_t;
+
+    void set_rate(std::uint64_t rate, std::size_t burst, Clock::time_point now);
+
+private:
+    void refill(Clock::time_point now);
+
+private:
+    std::uint64_t _rate; // bytes per second
+    std::size_t _burst;
+
+    double _tokens;
+    Clock::time_point _last_refill;
+};
+
+} // namespace ds
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "DirtySocks/IoBuffer.hpp"
+#include "DirtySocks/IpVersion.hpp"
+#include "DirtySocks/Socket.hpp"
+#include "DirtySocks/SocketAddress.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <system_error>
+
+namespace ds
+{
+
+/// @brief A datagram slot for `UdpSocket::receive_batch()`.
+struct ReceivedDatagram
+{
+    /// where to receive; a longer datagram is truncated
+    std::span<std::byte> buffer;
+
+    std::size_t length = 0;
+    bool truncated = false;
+    std::optional<SocketAddress> sender;
+};
+
+/// @brief UDP socket, with multicast support.
+///
+/// To consume a multicast group, along with other local consumers:
+/// `open()`, `set_reuse_address()`, `bind()` to the any address with the group's port, then `join_group()`.
+class UdpSocket final : public Socket
+{
+public:
+    /// @brief Create an unbound socket, to set options before `bind()`, or for sending only.
+    void open(IpVersion, std::error_code&);
+
+    /// @brief Bind to `addr`. (creates the socket if needed)
+    void bind(const SocketAddress& addr, std::error_code&);
+
+    /// @brief Set the default destination for `send()`, and only receive from it. (creates the socket if needed)
+    void connect(const SocketAddress& addr, std::error_code&);
+
+    /// @brief Let several sockets bind the same address and port. (`SO_REUSEADDR`, plus `SO_REUSEPORT` on BSDs)
+    ///
+    /// Call it before `bind()`.
+    void set_reuse_address(bool reuse, std::error_code&);
+
+public:
+    // send to the connected address
+    void send(const void* data, std::size_t data_length, std::size_t& sent_length, std::error_code&);
+    void send(std::span<IoBuffer> buffers, std::size_t& sent_length, std::error_code&);
+
+    void send_to(const void* data, std::size_t data_length, const SocketAddress&, std::size_t& sent_length,
+                 std::error_code&);
+    void send_to(std::span<IoBuffer> buffers, const SocketAddress&, std::size_t& sent_length, std::error_code&);
+
+    void receive(void* data, std::size_t data_length, std::size_t& received_length, std::error_code&);
+    void receive(std::span<IoBuffer> buffers, std::size_t& received_length, std::error_code&);
+
+    void receive_from(void* data, std::size_t data_length, std::size_t& received_length, SocketAddress& sender,
+                      std::error_code&);
+    void receive_from(std::span<IoBuffer> buffers, std::size_t& received_length, SocketAddress& sender,
+                      std::error_code&);
+
+    /// @brief Receive up to `datagrams.size()` datagrams, with a single `recvmmsg()` per 64 of them on Linux.
+    ///
+    /// This waits for the first one only (if blocking), then takes what's already queued.
+    /// Elsewhere, only non-blocking sockets receive more than one, with `recvmsg()` until it would block.
+    ///
+    /// An error after the first datagram just ends the batch; it's set to `ec` only if nothing was received.
+    ///
+    /// @param received_count number of filled `datagrams`, from the front
+    void receive_batch(std::span<ReceivedDatagram> datagrams, std::size_t& received_count, std::error_code&);
+
+public:
+    /// @brief Join a multicast group. (`MCAST_JOIN_GROUP`)
+    /// @param group group address, its port is ignored
+    /// @param interface_index interface to join on (e.g. from `if_nametoindex()`), `0` lets the routing table pick
+    void join_group(const SocketAddress& group, std::uint32_t interface_index, std::error_code&);
+
+    /// @brief Join a multicast group, only receiving from `source`. (`MCAST_JOIN_SOURCE_GROUP`)
+    void join_group(const SocketAddress& group, const SocketAddress& source, std::uint32_t interface_index,
+                    std::error_code&);
+
+    void leave_group(const SocketAddress& group, std::uint32_t interface_index, std::error_code&);
+    void leave_group(const SocketAddress& group, const SocketAddress& source, std::uint32_t interface_index,
+                     std::error_code&);
+
+    /// @brief Hops that sent multicast datagrams may take. (`1` by default, staying on the local network)
+    void set_multicast_ttl(int ttl, std::error_code&);
+
+    /// @brief Whether sent multicast datagrams are looped back to local members. (enabled by default)
+    void set_multicast_loopback(bool loopback, std::error_code&);
+
+    /// @brief Interface to send multicast datagrams on, instead of the routing table's pick.
+    void set_multicast_interface(std::uint32_t interface_index, std::error_code&);
+
+public:
+    auto get_remote_address(std::error_code&) const -> std::optional<SocketAddress>;
+
+private:
+    void send_message(std::span<IoBuffer> buffers, const SocketAddress*, std::size_t& sent_length,
+                      std::error_code&);
+    void receive_message(std::span<IoBuffer> buffers, std::size_t& received_length, SocketAddress* sender,
+                         std::error_code&);
+
+    void change_membership(bool join, const SocketAddress& group, const SocketAddress* source,
+                           std::uint32_t interface_index, std::error_code&);
+
+    // recorded by `open()`, as `getsockname()` fails on an unbound socket on Windows
+    auto get_ip_version(std::error_code&) const -> IpVersion;
+
+private:
+    IpVersion _ip_version = IpVersion::NONE;
+};
+
+} // namespace ds
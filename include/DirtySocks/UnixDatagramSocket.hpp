@@ -0,0 +1,62 @@
+#pragma once
+
+#include "DirtySocks/IoBuffer.hpp"
+#include "DirtySocks/Socket.hpp"
+#include "DirtySocks/UnixSocketAddress.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <system_error>
+
+namespace ds
+{
+
+/// @brief Unix domain datagram socket.
+///
+/// Message boundaries are preserved, and messages are never lost nor reordered,
+/// but a send blocks (or would block) while the receiver's queue is full.
+///
+/// Not supported on Windows.
+class UnixDatagramSocket final : public Socket
+{
+public:
+    /// @brief Create an unbound socket, for sending with `send_to()` only.
+    void open(std::error_code&);
+
+    /// @brief Create a socket bound to `addr`.
+    void bind(const UnixSocketAddress& addr, std::error_code&);
+
+    /// @brief Set the default destination for `send()`, and only receive from it. (creates the socket if needed)
+    void connect(const UnixSocketAddress& addr, std::error_code&);
+
+public:
+    // send to the connected address
+    void send(const void* data, std::size_t data_length, std::size_t& sent_length, std::error_code&);
+    void send(std::span<IoBuffer> buffers, std::size_t& sent_length, std::error_code&);
+
+    void send_to(const void* data, std::size_t data_length, const UnixSocketAddress&, std::size_t& sent_length,
+                 std::error_code&);
+    void send_to(std::span<IoBuffer> buffers, const UnixSocketAddress&, std::size_t& sent_length, std::error_code&);
+
+    void receive(void* data, std::size_t data_length, std::size_t& received_length, std::error_code&);
+    void receive(std::span<IoBuffer> buffers, std::size_t& received_length, std::error_code&);
+
+    /// @param sender filled with the sender's address (unnamed if the sender didn't bind)
+    void receive_from(void* data, std::size_t data_length, std::size_t& received_length, UnixSocketAddress& sender,
+                      std::error_code&);
+    void receive_from(std::span<IoBuffer> buffers, std::size_t& received_length, UnixSocketAddress& sender,
+                      std::error_code&);
+
+public:
+    auto get_local_address(std::error_code&) const -> std::optional<UnixSocketAddress>;
+    auto get_remote_address(std::error_code&) const -> std::optional<UnixSocketAddress>;
+
+private:
+    void send_message(std::span<IoBuffer> buffers, const UnixSocketAddress*, std::size_t& sent_length,
+                      std::error_code&);
+    void receive_message(std::span<IoBuffer> buffers, std::size_t& received_length, UnixSocketAddress* sender,
+                         std::error_code&);
+};
+
+} // namespace ds
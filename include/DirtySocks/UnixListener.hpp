@@ -0,0 +1,27 @@
+#pragma once
+
+#include "DirtySocks/Socket.hpp"
+#include "DirtySocks/UnixSocketAddress.hpp"
+
+#include <optional>
+#include <system_error>
+
+namespace ds
+{
+
+class UnixSocket;
+
+class UnixListener final : public Socket
+{
+public:
+    void listen(const UnixSocketAddress&, int backlog, std::error_code&);
+    void listen(const UnixSocketAddress&, std::error_code&);
+
+    void accept(UnixSocket& out_socket, UnixSocketAddress&, std::error_code&);
+    void accept(UnixSocket& out_socket, std::error_code&);
+
+public:
+    auto get_local_address(std::error_code&) const -> std::optional<UnixSocketAddress>;
+};
+
+} // namespace ds
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "DirtySocks/StreamSocket.hpp"
+#include "DirtySocks/UnixSocketAddress.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <system_error>
+
+namespace ds
+{
+
+class TcpSocket;
+
+/// @brief Unix domain stream socket, for same-host IPC without the TCP stack.
+class UnixSocket final : public StreamSocket
+{
+public:
+    UnixSocket() = default;
+
+public:
+    void connect(const UnixSocketAddress&, std::error_code&);
+
+    /// @brief Create a pair of connected sockets with `socketpair()`, e.g. before `fork()`.
+    ///
+    /// This is POSIX only, otherwise `SystemErrc::operation_not_supported` is set.
+    static void create_pair(UnixSocket& out_socket1, UnixSocket& out_socket2, std::error_code&);
+
+public:
+    /// @brief Max number of handles passed with a single message. (`SCM_MAX_FD` of Linux)
+    static constexpr std::size_t MAX_HANDLES_PER_MESSAGE = 253;
+
+    /// @brief Pass socket handles to the peer process with `SCM_RIGHTS`, along with some data.
+    ///
+    /// The peer gets its own duplicates, so close yours after sending if you're handing off connections.
+    /// Handles are attached to the first byte of `data`, so `data_length` must not be `0`.
+    ///
+    /// This is POSIX only, otherwise `SystemErrc::operation_not_supported` is set.
+    ///
+    /// @param handles up to `MAX_HANDLES_PER_MESSAGE` handles
+    void send_handles(std::span<const SOCKET> handles, const void* data, std::size_t data_length,
+                      std::size_t& sent_length, std::error_code&);
+
+    /// @brief Receive socket handles passed with `send_handles()`, along with some data.
+    ///
+    /// If more handles were passed than `out_handles` can hold, the extra ones are closed by the kernel,
+    /// and `SystemErrc::message_size` is set. (handles that fit are still received)
+    void receive_handles(std::span<SOCKET> out_handles, std::size_t& received_handles_count, void* data,
+                         std::size_t data_length, std::size_t& received_length, std::error_code&);
+
+    /// @brief `receive_handles()`, but rewrap the handles as `TcpSocket`s.
+    ///
+    /// Non-blocking state is shared with the sender's handle, and it's reflected to `is_non_blocking()`.
+    void receive_sockets(std::span<TcpSocket> out_sockets, std::size_t& received_sockets_count, void* data,
+                         std::size_t data_length, std::size_t& received_length, std::error_code&);
+
+public:
+    auto get_local_address(std::error_code&) const -> std::optional<UnixSocketAddress>;
+    auto get_remote_address(std::error_code&) const -> std::optional<UnixSocketAddress>;
+
+private:
+    friend class UnixListener;
+
+    UnixSocket(SOCKET, bool non_blocking);
+};
+
+} // namespace ds
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "DirtySocks/PlatformSocket.hpp"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace ds
+{
+
+/// @brief BSD socket `sockaddr_un` abstraction (Unix domain socket path)
+///
+/// This supports filesystem paths, and Linux abstract namespace names.
+class UnixSocketAddress final
+{
+public:
+    /// @brief Construct a socket address with `sockaddr` directly
+    /// @param addr_len length returned by `accept()`, `getsockname()`, `recvfrom()`, ...
+    UnixSocketAddress(const sockaddr& addr, socklen_t addr_len);
+
+    /// @brief Construct an unnamed socket address
+    UnixSocketAddress() noexcept;
+
+public:
+    /// @brief Get a filesystem path address.
+    ///
+    /// Binding to it creates a socket file, which is NOT removed on close.
+    /// Remove the stale file yourself before binding again, or it fails with `SystemErrc::address_in_use`.
+    ///
+    /// @param path filesystem path (e.g. `/run/my-service.sock`)
+    /// @return socket address, or `std::nullopt` if the path is too long or contains a null character
+    static auto from_path(std::string_view path, std::error_code&) -> std::optional<UnixSocketAddress>;
+
+    /// @brief Get a Linux abstract namespace address, which doesn't create any file.
+    ///
+    /// This is Linux only, otherwise `SystemErrc::address_family_not_supported` is set.
+    ///
+    /// @param name name without the leading null character
+    static auto from_abstract_name(std::string_view name, std::error_code&) -> std::optional<UnixSocketAddress>;
+
+public:
+    bool is_unnamed() const;
+    bool is_abstract() const;
+
+    /// @return filesystem path, or abstract name without the leading null character
+    auto get_path() const -> std::string;
+
+    auto get_sockaddr() const -> const sockaddr&;
+    auto get_sockaddr_len() const -> socklen_t;
+
+private:
+    sockaddr_un _addr;
+    socklen_t _addr_len;
+};
+
+} // namespace ds
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace ds
+{
+
+/// @brief Chase-Lev work-stealing deque. (the C11 memory model version by Lê et al.)
+///
+/// The owner thread calls `push()` & `pop()` on the bottom end, and any other thread can `steal()` from the top end.
+/// It grows without bound; retired arrays are kept until destruction, as thieves might still be reading them.
+template <typename T>
+class WorkStealingDeque final
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Store pointers or handles in WorkStealingDeque.");
+
+public:
+    explicit WorkStealingDeque(std::size_t initial_capacity = 256)
+    {
+        std::size_t capacity = 1;
+        while (capacity < initial_capacity)
+            capacity <<= 1;
+
+        _arrays.push_back(std::make_unique<Array>(static_cast<std::int64_t>(capacity)));
+        _array.store(_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+public:
+    /// @brief Push an item to the bottom. (owner thread)
+    void push(T item)
+    {
+        const std::int64_t b = _bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = _top.load(std::memory_order_acquire);
+        Array* array = _array.load(std::memory_order_relaxed);
+
+        if (b - t > array->capacity - 1)
+            array = grow(array, t, b);
+
+        array->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /// @brief Pop an item from the bottom. (owner thread)
+    auto pop() -> std::optional<T>
+    {
+        const std::int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        Array* array = _array.load(std::memory_order_relaxed);
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = _top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            // empty
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        std::optional<T> result = array->get(b);
+        if (t == b)
+        {
+            // last item, race against thieves
+            if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                result.reset();
+            _bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    /// @brief Steal an item from the top. (any thread)
+    ///
+    /// This might fail spuriously when it loses a race against the owner or another thief.
+    auto steal() -> std::optional<T>
+    {
+        std::int64_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = _bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+            return std::nullopt;
+
+        Array* array = _array.load(std::memory_order_acquire);
+        T item = array->get(t);
+        if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return std::nullopt;
+
+        return item;
+    }
+
+    /// @brief Approximate number of items.
+    auto size() const -> std::size_t
+    {
+        const std::int64_t b = _bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = _top.load(std::memory_order_relaxed);
+        return static_cast<std::size_t>(b > t ? b - t : 0);
+    }
+
+private:
+    struct Array
+    {
+        explicit Array(std::int64_t capacity_)
+            : capacity(capacity_), mask(capacity_ - 1), items(std::make_unique<std::atomic<T>[]>(capacity_))
+        {
+        }
+
+        auto get(std::int64_t index) const -> T
+        {
+            return items[index & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t index, T item)
+        {
+            items[index & mask].store(item, std::memory_order_relaxed);
+        }
+
+        const std::int64_t capacity;
+        const std::int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+    };
+
+private:
+    auto grow(Array* old_array, std::int64_t top, std::int64_t bottom) -> Array*
+    {
+        auto new_array = std::make_unique<Array>(old_array->capacity * 2);
+        for (std::int64_t i = top; i < bottom; ++i)
+            new_array->put(i, old_array->get(i));
+
+        Array* result = new_array.get();
+        _arrays.push_back(std::move(new_array));
+        _array.store(result, std::memory_order_release);
+        return result;
+    }
+
+private:
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> _top{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> _bottom{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<Array*> _array;
+
+    std::vector<std::unique_ptr<Array>> _arrays; // owner thread only
+};
+
+} // namespace ds
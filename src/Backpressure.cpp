@@ -0,0 +1,110 @@
+#include "DirtySocks/Backpressure.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/TcpSocket.hpp"
+
+#include <algorithm>
+
+namespace ds
+{
+
+Backpressure::Backpressure(std::size_t low_watermark, std::size_t high_watermark,
+                           std::optional<Clock::duration> slow_consumer_deadline)
+    : _low_watermark(std::min(low_watermark, high_watermark)), _high_watermark(high_watermark),
+      _slow_consumer_deadline(slow_consumer_deadline)
+{
+}
+
+auto Backpressure::update(std::size_t backlog, Clock::time_point now) -> Event
+{
+    _backlog = backlog;
+
+    if (!_paused_since)
+    {
+        if (backlog < _high_watermark)
+            return Event::NONE;
+
+        _paused_since = now;
+        return Event::PAUSE;
+    }
+
+    if (backlog <= _low_watermark)
+    {
+        _paused_since.reset();
+        _slow_consumer = false;
+        return Event::RESUME;
+    }
+
+    if (!_slow_consumer && _slow_consumer_deadline && now - *_paused_since >= *_slow_consumer_deadline)
+    {
+        _slow_consumer = true;
+        return Event::SLOW_CONSUMER;
+    }
+
+    return Event::NONE;
+}
+
+auto Backpressure::measure_backlog(const TcpSocket& sock, std::size_t queued_length, std::error_code& ec)
+    -> std::size_t
+{
+    std::size_t kernel_length = sock.get_unsent_length(ec);
+    if (ec == SystemErrc::operation_not_supported)
+    {
+        kernel_length = sock.get_send_queue_length(ec);
+        if (ec == SystemErrc::operation_not_supported)
+        {
+            ec.clear();
+            kernel_length = 0;
+        }
+    }
+
+    return queued_length + kernel_length;
+}
+
+bool Backpressure::is_paused() const
+{
+    return _paused_since.has_value();
+}
+
+bool Backpressure::is_slow_consumer() const
+{
+    return _slow_consumer;
+}
+
+auto Backpressure::get_backlog() const -> std::size_t
+{
+    return _backlog;
+}
+
+auto Backpressure::get_paused_since() const -> std::optional<Clock::time_point>
+{
+    return _paused_since;
+}
+
+auto Backpressure::get_low_watermark() const -> std::size_t
+{
+    return _low_watermark;
+}
+
+auto Backpressure::get_high_watermark() const -> std::size_t
+{
+    return _high_watermark;
+}
+
+void Backpressure::set_watermarks(std::size_t low_watermark, std::size_t high_watermark)
+{
+    _low_watermark = std::min(low_watermark, high_watermark);
+    _high_watermark = high_watermark;
+}
+
+auto Backpressure::get_slow_consumer_deadline() const -> std::optional<Clock::duration>
+{
+    return _slow_consumer_deadline;
+}
+
+void Backpressure::set_slow_consumer_deadline(std::optional<Clock::duration> deadline)
+{
+    _slow_consumer_deadline = deadline;
+}
+
+} // namespace ds
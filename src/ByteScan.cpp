@@ -0,0 +1,185 @@
+#include "ByteScan.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || \
+    (defined(_M_IX86) && _M_IX86_FP >= 2)
+#define DS_BYTE_SCAN_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DS_TARGET_AVX2
+#else
+#define DS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#define DS_BYTE_SCAN_NEON
+#include <arm_neon.h>
+#endif
+
+namespace ds
+{
+
+namespace
+{
+
+using FindByte = auto (*)(const char*, const char*, char) -> const char*;
+
+auto find_byte_scalar(const char* first, const char* last, char byte) -> const char*
+{
+    for (; first != last; ++first)
+        if (*first == byte)
+            return first;
+    return last;
+}
+
+#ifdef DS_BYTE_SCAN_X86
+
+auto find_byte_sse2(const char* first, const char* last, char byte) -> const char*
+{
+    if (last - first < 16)
+        return find_byte_scalar(first, last, byte);
+
+    const __m128i needle = _mm_set1_epi8(byte);
+    for (; last - first >= 16; first += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+        if (mask)
+            return first + std::countr_zero(mask);
+    }
+    if (first == last)
+        return last;
+
+    // the tail with an overlapping load, ignoring the bytes already scanned
+    const auto tail_length = static_cast<int>(last - first);
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(last - 16));
+    const auto mask =
+        static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle))) >> (16 - tail_length);
+    return (mask) ? first + std::countr_zero(mask) : last;
+}
+
+DS_TARGET_AVX2 auto find_byte_avx2(const char* first, const char* last, char byte) -> const char*
+{
+    const char* const begin = first;
+    const __m256i needle = _mm256_set1_epi8(byte);
+
+    // 2 vectors per round, to keep both load ports busy
+    for (; last - first >= 64; first += 64)
+    {
+        const __m256i chunk0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        const __m256i chunk1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + 32));
+        const __m256i eq0 = _mm256_cmpeq_epi8(chunk0, needle);
+        const __m256i eq1 = _mm256_cmpeq_epi8(chunk1, needle);
+        if (!_mm256_testz_si256(_mm256_or_si256(eq0, eq1), _mm256_or_si256(eq0, eq1)))
+        {
+            const auto mask0 = static_cast<std::uint32_t>(_mm256_movemask_epi8(eq0));
+            if (mask0)
+                return first + std::countr_zero(mask0);
+            return first + 32 + std::countr_zero(static_cast<std::uint32_t>(_mm256_movemask_epi8(eq1)));
+        }
+    }
+    for (; last - first >= 32; first += 32)
+    {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+        if (mask)
+            return first + std::countr_zero(mask);
+    }
+    if (first == last)
+        return last;
+    if (last - begin < 32)
+        return find_byte_sse2(first, last, byte);
+
+    // the tail with an overlapping load, ignoring the bytes already scanned
+    const auto tail_length = static_cast<int>(last - first);
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(last - 32));
+    const auto mask =
+        static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle))) >> (32 - tail_length);
+    return (mask) ? first + std::countr_zero(mask) : last;
+}
+
+bool has_avx2()
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+
+    // OS must save the YMM registers
+    __cpuid(regs, 1);
+    const bool osxsave = regs[2] & (1 << 27);
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(regs, 7, 0);
+    return regs[1] & (1 << 5);
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // DS_BYTE_SCAN_X86
+
+#ifdef DS_BYTE_SCAN_NEON
+
+auto find_byte_neon(const char* first, const char* last, char byte) -> const char*
+{
+    const uint8x16_t needle = vdupq_n_u8(static_cast<std::uint8_t>(byte));
+    for (; last - first >= 16; first += 16)
+    {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const std::uint8_t*>(first));
+        const uint8x16_t eq = vceqq_u8(chunk, needle);
+
+        // narrow each byte of `eq` to a nibble, to get a 64-bit mask
+        const std::uint64_t mask =
+            vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        if (mask)
+            return first + std::countr_zero(mask) / 4;
+    }
+    return find_byte_scalar(first, last, byte);
+}
+
+#endif // DS_BYTE_SCAN_NEON
+
+struct Implementation
+{
+    FindByte find_byte;
+    const char* name;
+};
+
+auto select_implementation() -> Implementation
+{
+#if defined(DS_BYTE_SCAN_X86)
+    if (has_avx2())
+        return {find_byte_avx2, "avx2"};
+    return {find_byte_sse2, "sse2"};
+#elif defined(DS_BYTE_SCAN_NEON)
+    return {find_byte_neon, "neon"};
+#else
+    return {find_byte_scalar, "scalar"};
+#endif
+}
+
+auto get_implementation() -> const Implementation&
+{
+    static const Implementation implementation = select_implementation();
+    return implementation;
+}
+
+} // namespace
+
+auto find_byte(const char* first, const char* last, char byte) -> const char*
+{
+    return get_implementation().find_byte(first, last, byte);
+}
+
+auto get_find_byte_implementation() -> const char*
+{
+    return get_implementation().name;
+}
+
+} // namespace ds
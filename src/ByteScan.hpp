@@ -0,0 +1,14 @@
+#pragma once
+
+namespace ds
+{
+
+/// @brief `memchr()` with the widest SIMD available at runtime. (AVX2, SSE2, NEON or scalar)
+///
+/// @return pointer to the first `byte` in [`first`, `last`), or `last` if none
+auto find_byte(const char* first, const char* last, char byte) -> const char*;
+
+/// @return name of the implementation `find_byte()` dispatches to
+auto get_find_byte_implementation() -> const char*;
+
+} // namespace ds
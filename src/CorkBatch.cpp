@@ -0,0 +1,97 @@
+#include "DirtySocks/CorkBatch.hpp"
+
+#include "DirtySocks/TcpSocket.hpp"
+
+#include "TcpCork.hpp"
+
+#include <algorithm>
+
+namespace ds
+{
+
+CorkGuard::CorkGuard(TcpSocket& socket, std::error_code& ec) : _socket(socket)
+{
+    _socket.set_cork(true, ec);
+    _corked = !ec;
+}
+
+CorkGuard::~CorkGuard()
+{
+    if (!_corked)
+        return;
+
+    std::error_code ec;
+    _socket.set_cork(false, ec);
+}
+
+CorkBatch::~CorkBatch()
+{
+    flush();
+}
+
+void CorkBatch::cork(TcpSocket& socket, std::error_code& ec)
+{
+    ec.clear();
+
+    // corked already, by this batch or another one which will uncork it
+    if (socket._cork_batch)
+        return;
+
+    set_tcp_cork(socket.get_handle(), true, ec);
+    if (ec)
+        return;
+
+    _corked.push_back(&socket);
+    socket._cork_batch = this;
+}
+
+void CorkBatch::uncork(TcpSocket& socket, std::error_code& ec)
+{
+    ec.clear();
+
+    if (this != socket._cork_batch)
+        return;
+
+    drop(socket);
+    set_tcp_cork(socket.get_handle(), false, ec);
+}
+
+void CorkBatch::flush()
+{
+    std::error_code ec;
+    for (TcpSocket* socket : _corked)
+    {
+        set_tcp_cork(socket->get_handle(), false, ec);
+        socket->_cork_batch = nullptr;
+    }
+
+    // keeps the capacity, so a steady batch doesn't allocate
+    _corked.clear();
+}
+
+auto CorkBatch::get_corked_count() const -> std::size_t
+{
+    return _corked.size();
+}
+
+void CorkBatch::drop(TcpSocket& socket)
+{
+    // the order doesn't matter, so swap & pop
+    const auto it = find(socket);
+    *it = _corked.back();
+    _corked.pop_back();
+
+    socket._cork_batch = nullptr;
+}
+
+void CorkBatch::relocate(TcpSocket& from, TcpSocket& to)
+{
+    *find(from) = &to;
+}
+
+auto CorkBatch::find(TcpSocket& socket) -> std::vector<TcpSocket*>::iterator
+{
+    return std::find(_corked.begin(), _corked.end(), &socket);
+}
+
+} // namespace ds
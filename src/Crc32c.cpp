@@ -0,0 +1,259 @@
+#include "DirtySocks/Crc32c.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define DS_CRC32C_SSE42
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DS_TARGET_SSE42
+#else
+#define DS_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+#elif defined(__ARM_FEATURE_CRC32)
+#define DS_CRC32C_ARMV8
+#include <arm_acle.h>
+#endif
+
+namespace ds
+{
+
+namespace
+{
+
+// all the `extend_*()` work on the raw CRC register, without the initial & final inversions
+
+using Extend = auto (*)(std::uint32_t, const unsigned char*, std::size_t) -> std::uint32_t;
+
+constexpr std::uint32_t POLYNOMIAL = 0x82F63B78; // reversed 0x1EDC6F41
+
+// slicing-by-8 tables
+constexpr auto make_tables() -> std::array<std::array<std::uint32_t, 256>, 8>
+{
+    std::array<std::array<std::uint32_t, 256>, 8> tables{};
+    for (std::uint32_t i = 0; i < 256; ++i)
+    {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 1) ? (crc >> 1) ^ POLYNOMIAL : (crc >> 1);
+        tables[0][i] = crc;
+    }
+    for (std::size_t k = 1; k < 8; ++k)
+        for (std::uint32_t i = 0; i < 256; ++i)
+            tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+    return tables;
+}
+
+constexpr auto TABLES = make_tables();
+
+auto load_u64(const unsigned char* data) -> std::uint64_t
+{
+    std::uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+auto extend_portable(std::uint32_t crc, const unsigned char* data, std::size_t length) -> std::uint32_t
+{
+    for (; length >= 8; data += 8, length -= 8)
+    {
+        // little-endian, independent of the host byte order
+        const std::uint32_t low =
+            crc ^ (static_cast<std::uint32_t>(data[0]) | static_cast<std::uint32_t>(data[1]) << 8 |
+                   static_cast<std::uint32_t>(data[2]) << 16 | static_cast<std::uint32_t>(data[3]) << 24);
+        crc = TABLES[7][low & 0xFF] ^ TABLES[6][(low >> 8) & 0xFF] ^ TABLES[5][(low >> 16) & 0xFF] ^
+              TABLES[4][low >> 24] ^ TABLES[3][data[4]] ^ TABLES[2][data[5]] ^ TABLES[1][data[6]] ^
+              TABLES[0][data[7]];
+    }
+    for (; length > 0; ++data, --length)
+        crc = (crc >> 8) ^ TABLES[0][(crc ^ *data) & 0xFF];
+    return crc;
+}
+
+#if defined(DS_CRC32C_SSE42) || defined(DS_CRC32C_ARMV8)
+
+// inputs of at least `3 * LANE_LENGTH` bytes are split into 3 lanes, and their CRCs are combined
+constexpr std::size_t LANE_LENGTH = 1024;
+
+/// @brief Tables to advance a CRC register past `LANE_LENGTH` zero bytes, i.e. `x^(8 * LANE_LENGTH) mod P`.
+struct LaneShift
+{
+    std::array<std::array<std::uint32_t, 256>, 4> tables;
+
+    LaneShift()
+    {
+        // it's linear, so tabulate the shifted image of each bit
+        static constexpr unsigned char ZEROS[LANE_LENGTH] = {};
+        std::uint32_t bit_images[32];
+        for (int bit = 0; bit < 32; ++bit)
+            bit_images[bit] = extend_portable(std::uint32_t(1) << bit, ZEROS, LANE_LENGTH);
+
+        for (int k = 0; k < 4; ++k)
+            for (std::uint32_t byte = 0; byte < 256; ++byte)
+            {
+                std::uint32_t image = 0;
+                for (int bit = 0; bit < 8; ++bit)
+                    if (byte & (1 << bit))
+                        image ^= bit_images[8 * k + bit];
+                tables[k][byte] = image;
+            }
+    }
+
+    auto shift(std::uint32_t crc) const -> std::uint32_t
+    {
+        return tables[0][crc & 0xFF] ^ tables[1][(crc >> 8) & 0xFF] ^ tables[2][(crc >> 16) & 0xFF] ^
+               tables[3][crc >> 24];
+    }
+};
+
+auto get_lane_shift() -> const LaneShift&
+{
+    static const LaneShift lane_shift;
+    return lane_shift;
+}
+
+#endif
+
+#ifdef DS_CRC32C_SSE42
+
+DS_TARGET_SSE42 auto extend_sse42(std::uint32_t crc, const unsigned char* data, std::size_t length) -> std::uint32_t
+{
+    if (length >= 3 * LANE_LENGTH)
+    {
+        const LaneShift& lane_shift = get_lane_shift();
+        do
+        {
+            // `crc32` has 3 cycles of latency but a throughput of 1, so 3 lanes keep it busy
+            std::uint64_t crc0 = crc, crc1 = 0, crc2 = 0;
+            for (std::size_t i = 0; i < LANE_LENGTH; i += 8)
+            {
+                crc0 = _mm_crc32_u64(crc0, load_u64(data + i));
+                crc1 = _mm_crc32_u64(crc1, load_u64(data + LANE_LENGTH + i));
+                crc2 = _mm_crc32_u64(crc2, load_u64(data + 2 * LANE_LENGTH + i));
+            }
+            crc = lane_shift.shift(lane_shift.shift(static_cast<std::uint32_t>(crc0)) ^
+                                   static_cast<std::uint32_t>(crc1)) ^
+                  static_cast<std::uint32_t>(crc2);
+
+            data += 3 * LANE_LENGTH;
+            length -= 3 * LANE_LENGTH;
+        } while (length >= 3 * LANE_LENGTH);
+    }
+
+    std::uint64_t crc64 = crc;
+    for (; length >= 8; data += 8, length -= 8)
+        crc64 = _mm_crc32_u64(crc64, load_u64(data));
+    crc = static_cast<std::uint32_t>(crc64);
+
+    for (; length > 0; ++data, --length)
+        crc = _mm_crc32_u8(crc, *data);
+    return crc;
+}
+
+bool has_sse42()
+{
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 1);
+    return regs[2] & (1 << 20);
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+#endif // DS_CRC32C_SSE42
+
+#ifdef DS_CRC32C_ARMV8
+
+auto extend_armv8(std::uint32_t crc, const unsigned char* data, std::size_t length) -> std::uint32_t
+{
+    if (length >= 3 * LANE_LENGTH)
+    {
+        const LaneShift& lane_shift = get_lane_shift();
+        do
+        {
+            std::uint32_t crc0 = crc, crc1 = 0, crc2 = 0;
+            for (std::size_t i = 0; i < LANE_LENGTH; i += 8)
+            {
+                crc0 = __crc32cd(crc0, load_u64(data + i));
+                crc1 = __crc32cd(crc1, load_u64(data + LANE_LENGTH + i));
+                crc2 = __crc32cd(crc2, load_u64(data + 2 * LANE_LENGTH + i));
+            }
+            crc = lane_shift.shift(lane_shift.shift(crc0) ^ crc1) ^ crc2;
+
+            data += 3 * LANE_LENGTH;
+            length -= 3 * LANE_LENGTH;
+        } while (length >= 3 * LANE_LENGTH);
+    }
+
+    for (; length >= 8; data += 8, length -= 8)
+        crc = __crc32cd(crc, load_u64(data));
+    for (; length > 0; ++data, --length)
+        crc = __crc32cb(crc, *data);
+    return crc;
+}
+
+#endif // DS_CRC32C_ARMV8
+
+struct Implementation
+{
+    Extend extend;
+    const char* name;
+};
+
+auto select_implementation() -> Implementation
+{
+#if defined(DS_CRC32C_SSE42)
+    if (has_sse42())
+        return {extend_sse42, "sse4.2"};
+    return {extend_portable, "portable"};
+#elif defined(DS_CRC32C_ARMV8)
+    return {extend_armv8, "armv8"};
+#else
+    return {extend_portable, "portable"};
+#endif
+}
+
+auto get_selected_implementation() -> const Implementation&
+{
+    static const Implementation implementation = select_implementation();
+    return implementation;
+}
+
+} // namespace
+
+void Crc32c::update(const void* data, std::size_t length)
+{
+    _state = get_selected_implementation().extend(_state, static_cast<const unsigned char*>(data), length);
+}
+
+auto Crc32c::get_value() const -> std::uint32_t
+{
+    return ~_state;
+}
+
+void Crc32c::reset()
+{
+    _state = 0xFFFFFFFF;
+}
+
+auto Crc32c::compute(const void* data, std::size_t length) -> std::uint32_t
+{
+    Crc32c crc;
+    crc.update(data, length);
+    return crc.get_value();
+}
+
+auto Crc32c::compute_portable(const void* data, std::size_t length) -> std::uint32_t
+{
+    return ~extend_portable(0xFFFFFFFF, static_cast<const unsigned char*>(data), length);
+}
+
+auto Crc32c::get_implementation() -> const char*
+{
+    return get_selected_implementation().name;
+}
+
+} // namespace ds
@@ -0,0 +1,145 @@
+#include "DirtySocks/DelimiterFramer.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/StreamSocket.hpp"
+
+#include "ByteScan.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace ds
+{
+
+namespace
+{
+
+constexpr std::size_t RECEIVE_CHUNK_LENGTH = 16 * 1024;
+
+} // namespace
+
+DelimiterFramer::DelimiterFramer(std::string_view delimiter, std::size_t max_frame_length)
+    : _delimiter(delimiter), _max_frame_length(max_frame_length)
+{
+    assert(!_delimiter.empty() && "DelimiterFramer needs a delimiter");
+}
+
+void DelimiterFramer::receive_from(StreamSocket& socket, std::size_t& received_length, std::error_code& ec)
+{
+    const std::span<char> space = prepare(RECEIVE_CHUNK_LENGTH);
+
+    socket.receive(space.data(), space.size(), received_length, ec);
+    if (!ec)
+        commit(received_length);
+}
+
+auto DelimiterFramer::prepare(std::size_t min_length) -> std::span<char>
+{
+    if (_buffer.size() - _end < min_length)
+    {
+        // move the unpopped bytes to the front
+        if (_begin > 0)
+        {
+            std::memmove(_buffer.data(), _buffer.data() + _begin, _end - _begin);
+            _scan -= _begin;
+            _end -= _begin;
+            _begin = 0;
+        }
+
+        if (_buffer.size() - _end < min_length)
+            _buffer.resize(std::max(_buffer.size() * 2, _end + min_length));
+    }
+
+    return std::span<char>(_buffer.data() + _end, _buffer.size() - _end);
+}
+
+void DelimiterFramer::commit(std::size_t length)
+{
+    _end += length;
+}
+
+void DelimiterFramer::feed(const void* data, std::size_t length)
+{
+    std::memcpy(prepare(length).data(), data, length);
+    commit(length);
+}
+
+auto DelimiterFramer::next_frame(std::error_code& ec) -> std::optional<std::string_view>
+{
+    ec.clear();
+
+    // release builds skip the constructor's assert
+    if (_delimiter.empty())
+    {
+        ec = SystemErrc::invalid_argument;
+        return std::nullopt;
+    }
+
+    const char* data = _buffer.data();
+    const std::size_t delimiter_length = _delimiter.size();
+
+    // search the last byte of the delimiter, and compare the rest only on hits
+    while (_scan < _end)
+    {
+        const char* found = find_byte(data + _scan, data + _end, _delimiter.back());
+        if (found == data + _end)
+        {
+            _scan = _end;
+            break;
+        }
+
+        const std::size_t delimiter_end = static_cast<std::size_t>(found - data) + 1;
+        _scan = delimiter_end;
+
+        if (delimiter_end - _begin < delimiter_length ||
+            0 != std::memcmp(data + delimiter_end - delimiter_length, _delimiter.data(), delimiter_length - 1))
+            continue;
+
+        const std::string_view frame(data + _begin, delimiter_end - delimiter_length - _begin);
+        if (frame.size() > _max_frame_length)
+        {
+            ec = StreamErrc::FRAME_TOO_LONG;
+            return std::nullopt;
+        }
+
+        _begin = delimiter_end;
+        if (_begin == _end)
+            _begin = _scan = _end = 0; // rewind for free while empty
+
+        return frame;
+    }
+
+    // unfinished frame is already too long
+    if (_end - _begin > _max_frame_length + delimiter_length - 1)
+        ec = StreamErrc::FRAME_TOO_LONG;
+
+    return std::nullopt;
+}
+
+void DelimiterFramer::reset()
+{
+    _begin = _scan = _end = 0;
+}
+
+auto DelimiterFramer::get_buffered_length() const -> std::size_t
+{
+    return _end - _begin;
+}
+
+auto DelimiterFramer::get_delimiter() const -> std::string_view
+{
+    return _delimiter;
+}
+
+auto DelimiterFramer::get_max_frame_length() const -> std::size_t
+{
+    return _max_frame_length;
+}
+
+auto DelimiterFramer::get_scan_implementation() -> const char*
+{
+    return get_find_byte_implementation();
+}
+
+} // namespace ds
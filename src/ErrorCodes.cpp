@@ -135,6 +135,45 @@ private:
     SocketSelectorErrorCategory() = default;
 };
 
+class StreamErrorCategory : public std::error_category
+{
+public:
+    static auto instance() -> StreamErrorCategory&
+    {
+        static StreamErrorCategory category;
+        return category;
+    }
+
+public:
+    auto name() const noexcept -> const char* override
+    {
+        return "DirtySocks::StreamError";
+    }
+
+    auto message(int error_value) const -> std::string override
+    {
+        switch (static_cast<StreamErrc>(error_value))
+        {
+        case StreamErrc::END_OF_STREAM:
+            return "Peer closed the stream before the expected data arrived";
+        case StreamErrc::FRAME_TOO_LONG:
+            return "Frame exceeded the maximum length";
+        case StreamErrc::CHECKSUM_MISMATCH:
+            return "Frame checksum mismatch";
+        case StreamErrc::MALFORMED_FRAME:
+            return "Malformed frame";
+        case StreamErrc::DEADLINE_EXCEEDED:
+            return "Deadline exceeded";
+        default:
+            break;
+        }
+        return "(Invalid error message)";
+    }
+
+private:
+    StreamErrorCategory() = default;
+};
+
 } // namespace
 
 auto make_error_code(AddrInfoErrc errc) -> std::error_code
@@ -152,4 +191,9 @@ auto make_error_code(SocketSelectorErrc errc) -> std::error_code
     return std::error_code(static_cast<int>(errc), SocketSelectorErrorCategory::instance());
 }
 
+auto make_error_code(StreamErrc errc) -> std::error_code
+{
+    return std::error_code(static_cast<int>(errc), StreamErrorCategory::instance());
+}
+
 } // namespace ds
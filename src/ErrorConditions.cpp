@@ -53,7 +53,8 @@ public:
 
         case SocketErrc::DISCONNECTED:
             return ec == SystemErrc::network_reset || ec == SystemErrc::connection_aborted ||
-                   ec == SystemErrc::connection_reset || ec == SystemErrc::broken_pipe || ec == SystemErrc::timed_out;
+                   ec == SystemErrc::connection_reset || ec == SystemErrc::broken_pipe || ec == SystemErrc::timed_out ||
+                   ec == StreamErrc::END_OF_STREAM;
 
         default:
             break;
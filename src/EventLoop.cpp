@@ -0,0 +1,355 @@
+#include "DirtySocks/EventLoop.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/Runtime.hpp"
+#include "DirtySocks/System.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ds
+{
+
+namespace
+{
+
+void pin_current_thread(unsigned cpu, std::error_code& ec)
+{
+    ec.clear();
+
+#if defined(__linux__)
+    if (cpu >= CPU_SETSIZE)
+    {
+        ec = SystemErrc::invalid_argument;
+        return;
+    }
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+
+    // returns the error instead of setting `errno`
+    if (const int result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set); 0 != result)
+        ec = std::error_code(result, std::system_category());
+#elif defined(_WIN32)
+    if (cpu >= sizeof(DWORD_PTR) * 8)
+    {
+        ec = SystemErrc::invalid_argument;
+        return;
+    }
+
+    if (0 == SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu))
+        ec = std::error_code(static_cast<int>(GetLastError()), std::system_category());
+#else
+    // no thread affinity API, e.g. on macOS
+    (void)cpu;
+#endif
+}
+
+// rounded up, not to wake up before the deadline
+auto to_timeout(std::chrono::steady_clock::duration remaining) -> timeval
+{
+    const auto us = std::max<std::int64_t>(0, std::chrono::ceil<std::chrono::microseconds>(remaining).count());
+
+    timeval result;
+    result.tv_sec = static_cast<decltype(result.tv_sec)>(us / 1'000'000);
+    result.tv_usec = static_cast<decltype(result.tv_usec)>(us % 1'000'000);
+    return result;
+}
+
+} // namespace
+
+auto EventLoop::get_index() const -> std::size_t
+{
+    return _index;
+}
+
+auto EventLoop::get_cpu() const -> unsigned
+{
+    return _cpu;
+}
+
+auto EventLoop::get_runtime() -> Runtime&
+{
+    return _runtime;
+}
+
+auto EventLoop::get_selector() -> PollSelector&
+{
+    return _selector;
+}
+
+auto EventLoop::get_listener() -> TcpListener&
+{
+    return _listener;
+}
+
+auto EventLoop::get_mailbox() -> Mailbox&
+{
+    return _mailbox;
+}
+
+auto EventLoop::get_memory_resource() -> std::pmr::memory_resource*
+{
+    return &*_pool;
+}
+
+void EventLoop::set_event_handler(EventHandler handler)
+{
+    _event_handler = std::move(handler);
+}
+
+void EventLoop::set_migration_handler(MigrationHandler handler)
+{
+    _migration_handler = std::move(handler);
+}
+
+void EventLoop::set_shed_handler(ShedHandler handler)
+{
+    _shed_handler = std::move(handler);
+}
+
+void EventLoop::set_timer_handler(TimerHandler handler)
+{
+    _timer_handler = std::move(handler);
+}
+
+void EventLoop::post(std::size_t loop_index, Task task, std::error_code& ec)
+{
+    _runtime.post(loop_index, std::move(task), ec);
+}
+
+void EventLoop::migrate(TcpSocket& socket, std::size_t target_index, std::shared_ptr<void> state,
+                        std::error_code& ec)
+{
+    ec.clear();
+
+    if (target_index >= _runtime.get_loops_count())
+    {
+        ec = SystemErrc::invalid_argument;
+        return;
+    }
+
+    // no more events here; whatever arrives meanwhile waits in the kernel for the target loop
+    _selector.remove(socket);
+
+    // the target loop's batch can't uncork it
+    std::error_code uncork_ec;
+    _cork_batch.uncork(socket, uncork_ec);
+
+    // `std::function` must be copyable, hence the `std::shared_ptr`
+    auto connection = std::make_shared<MigratedConnection>();
+    connection->pending_send = _mailbox.take_pending_send(socket);
+    connection->socket = std::move(socket);
+    connection->state = std::move(state);
+
+    Runtime& runtime = _runtime;
+    _runtime.post(
+        target_index, [&runtime, target_index, connection] { runtime.get_loop(target_index).adopt(*connection); },
+        ec);
+    if (ec)
+    {
+        socket = std::move(connection->socket);
+
+        std::error_code restore_ec;
+        _mailbox.restore_pending_send(socket, std::move(connection->pending_send), restore_ec);
+    }
+}
+
+void EventLoop::cork(TcpSocket& socket, std::error_code& ec)
+{
+    _cork_batch.cork(socket, ec);
+}
+
+void EventLoop::uncork(TcpSocket& socket, std::error_code& ec)
+{
+    _cork_batch.uncork(socket, ec);
+}
+
+auto EventLoop::get_busy_time() const -> std::chrono::nanoseconds
+{
+    return std::chrono::nanoseconds(_busy_ns.load(std::memory_order_relaxed));
+}
+
+EventLoop::EventLoop(Runtime& runtime, std::size_t index, unsigned cpu) : _runtime(runtime), _index(index), _cpu(cpu)
+{
+}
+
+void EventLoop::init(const RuntimeConfig& config, std::error_code& ec)
+{
+    pin_current_thread(_cpu, ec);
+    if (ec)
+        return;
+
+    // first touch from the pinned thread, so the pages land on its NUMA node
+    if (0 != config.arena_size)
+    {
+        _arena_memory = std::make_unique_for_overwrite<std::byte[]>(config.arena_size);
+        std::memset(_arena_memory.get(), 0, config.arena_size);
+        _arena.emplace(_arena_memory.get(), config.arena_size, std::pmr::new_delete_resource());
+    }
+    else
+        _arena.emplace(std::pmr::new_delete_resource());
+    _pool.emplace(&*_arena);
+
+    _mailbox.open(ec);
+    if (ec)
+        return;
+    _selector.add(_mailbox.get_notifier(), PollInterest::READ, MAILBOX_TOKEN, ec);
+    if (ec)
+        return;
+
+    if (!config.listen_address)
+        return;
+
+    _listener.set_non_blocking(true, ec);
+    if (ec)
+        return;
+    _listener.listen(*config.listen_address, config.listen_backlog, SocketOptions(config.listen_options).reuse_port(),
+                     ec);
+    if (ec)
+        return;
+
+#if defined(__linux__) && defined(SO_INCOMING_CPU)
+    // just a hint to prefer this listener for connections handled on its CPU, so its result doesn't matter
+    const int cpu = static_cast<int>(_cpu);
+    setsockopt(_listener.get_handle(), SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu));
+#endif
+
+    _selector.add(_listener, PollInterest::READ, LISTENER_TOKEN, ec);
+}
+
+void EventLoop::run(std::error_code& ec)
+{
+    ec.clear();
+
+    auto busy_start = Clock::now();
+    auto wakeup = run_timers();
+    _cork_batch.flush();
+
+    while (!_stopping && !ec)
+    {
+        const auto now = Clock::now();
+        _busy_ns.fetch_add(std::chrono::nanoseconds(now - busy_start).count(), std::memory_order_relaxed);
+
+        timeval timeout;
+        if (wakeup)
+            timeout = to_timeout(*wakeup - now);
+        _selector.select(wakeup ? &timeout : nullptr, ec);
+        busy_start = Clock::now();
+        if (ec)
+        {
+            if (SystemErrc::interrupted == ec)
+                ec.clear();
+            continue;
+        }
+
+        _selector.for_each_ready([this, &ec](const PollSelector::Ready& ready) {
+            if (MAILBOX_TOKEN == ready.token)
+                _mailbox.drain(ec);
+            else if (!_event_handler)
+                return;
+            else if (!_shed_handler || LISTENER_TOKEN == ready.token)
+                _event_handler(*this, ready);
+            else
+            {
+                const auto handling_start = Clock::now();
+                _event_handler(*this, ready);
+                _token_loads[ready.token] += Clock::now() - handling_start;
+            }
+        });
+
+        wakeup = run_timers();
+
+        // before waiting again, so nothing is held back for longer than this iteration
+        _cork_batch.flush();
+    }
+
+    // stop receiving connections, so they go to the other listeners
+    _listener.close();
+}
+
+auto EventLoop::run_timers() -> std::optional<Clock::time_point>
+{
+    if (!_timer_handler)
+        return std::nullopt;
+
+    return _timer_handler(*this, Clock::now());
+}
+
+void EventLoop::stop()
+{
+    _stopping = true;
+}
+
+void EventLoop::adopt(MigratedConnection& connection)
+{
+    TcpSocket* socket = _migration_handler ? _migration_handler(*this, connection) : nullptr;
+    if (!socket)
+        return;
+
+    // send errors go to the mailbox's send error handler
+    std::error_code ec;
+    _mailbox.restore_pending_send(*socket, std::move(connection.pending_send), ec);
+}
+
+void EventLoop::shed(std::size_t target_index, double load_fraction)
+{
+    if (!_shed_handler)
+        return;
+
+    std::vector<std::pair<std::uint64_t, Clock::duration>> loads;
+    loads.reserve(_token_loads.size());
+    for (const auto& [token, load] : _token_loads)
+    {
+        if (Clock::duration::zero() != load)
+            loads.emplace_back(token, load);
+    }
+    reset_token_loads();
+
+    std::sort(loads.begin(), loads.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+    Clock::duration total_load{0};
+    for (const auto& [token, load] : loads)
+        total_load += load;
+
+    const auto goal = std::chrono::duration_cast<Clock::duration>(total_load * load_fraction);
+
+    // hottest first, skipping ones that would overshoot (e.g. a single connection hogging the loop),
+    // as they'd only move the hot spot, and then be moved back
+    Clock::duration shed_load{0};
+    for (const auto& [token, load] : loads)
+    {
+        if (shed_load >= goal)
+            break;
+        if (shed_load + load > goal + goal / 2)
+            continue;
+
+        _shed_handler(*this, token, target_index);
+        shed_load += load;
+    }
+}
+
+void EventLoop::reset_token_loads()
+{
+    // zeroed rather than cleared, so busy tokens keep their nodes instead of allocating them again each period;
+    // only those idle for a whole period (e.g. closed or migrated) are dropped
+    for (auto it = _token_loads.begin(); it != _token_loads.end();)
+    {
+        if (Clock::duration::zero() == it->second)
+            it = _token_loads.erase(it);
+        else
+        {
+            it->second = Clock::duration::zero();
+            ++it;
+        }
+    }
+}
+
+} // namespace ds
@@ -0,0 +1,110 @@
+#include "DirtySocks/EventNotifier.hpp"
+
+#include "DirtySocks/ErrorConditions.hpp"
+#include "DirtySocks/SocketAddress.hpp"
+#include "DirtySocks/System.hpp"
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+#include <cstdint>
+
+namespace ds
+{
+
+void EventNotifier::open(std::error_code& ec)
+{
+    ec.clear();
+
+#ifdef __linux__
+    SOCKET handle = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (INVALID_SOCKET == handle)
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    *this = EventNotifier(handle, true);
+#else
+    init_handle(IpVersion::V4, Socket::Protocol::UDP, ec);
+    if (ec)
+        return;
+
+    const SocketAddress loopback(127, 0, 0, 1, 0);
+    if (SOCKET_ERROR == ::bind(get_handle(), &loopback.get_sockaddr(), loopback.get_sockaddr_len()))
+    {
+        ec = System::get_last_error_code();
+        close();
+        return;
+    }
+
+    auto bound_addr = get_local_address(ec);
+    if (ec)
+    {
+        close();
+        return;
+    }
+
+    if (SOCKET_ERROR == ::connect(get_handle(), &bound_addr->get_sockaddr(), bound_addr->get_sockaddr_len()))
+    {
+        ec = System::get_last_error_code();
+        close();
+        return;
+    }
+
+    set_non_blocking(true, ec);
+    if (ec)
+        close();
+#endif
+}
+
+void EventNotifier::notify(std::error_code& ec)
+{
+    ec.clear();
+
+#ifdef __linux__
+    const std::uint64_t one = 1;
+    const auto ret = ::write(get_handle(), &one, sizeof(one));
+#else
+    const char one = 1;
+    const auto ret = ::send(get_handle(), &one, sizeof(one), 0);
+#endif
+
+    if (SOCKET_ERROR == ret)
+    {
+        ec = System::get_last_error_code();
+        // counter or buffer is full, which means it's already readable
+        if (ec == SocketErrc::WOULD_BLOCK)
+            ec.clear();
+    }
+}
+
+void EventNotifier::consume(std::error_code& ec)
+{
+    ec.clear();
+
+#ifdef __linux__
+    std::uint64_t counter;
+    const auto ret = ::read(get_handle(), &counter, sizeof(counter));
+#else
+    char buf[64];
+    auto ret = ::recv(get_handle(), buf, sizeof(buf), 0);
+    while (SOCKET_ERROR != ret)
+        ret = ::recv(get_handle(), buf, sizeof(buf), 0);
+#endif
+
+    if (SOCKET_ERROR == ret)
+    {
+        ec = System::get_last_error_code();
+        // nothing left to consume
+        if (ec == SocketErrc::WOULD_BLOCK)
+            ec.clear();
+    }
+}
+
+EventNotifier::EventNotifier(SOCKET handle, bool non_blocking) : Socket(handle, non_blocking)
+{
+}
+
+} // namespace ds
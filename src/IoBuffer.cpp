@@ -0,0 +1,30 @@
+#include "DirtySocks/IoBuffer.hpp"
+
+namespace ds
+{
+
+auto get_total_length(std::span<const IoBuffer> buffers) -> std::size_t
+{
+    std::size_t total = 0;
+    for (const IoBuffer& buffer : buffers)
+        total += buffer.iov_len;
+    return total;
+}
+
+void advance_io_buffers(std::span<IoBuffer>& buffers, std::size_t length)
+{
+    std::size_t consumed = 0;
+    while (consumed < buffers.size() && length >= buffers[consumed].iov_len)
+        length -= buffers[consumed++].iov_len;
+
+    buffers = buffers.subspan(consumed);
+
+    if (0 != length && !buffers.empty())
+    {
+        IoBuffer& first = buffers.front();
+        first.iov_base = static_cast<char*>(first.iov_base) + length;
+        first.iov_len -= static_cast<decltype(first.iov_len)>(length);
+    }
+}
+
+} // namespace ds
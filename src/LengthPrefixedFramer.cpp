@@ -0,0 +1,202 @@
+#include "DirtySocks/LengthPrefixedFramer.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/StreamSocket.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ds
+{
+
+namespace
+{
+
+constexpr std::size_t RECEIVE_CHUNK_LENGTH = 16 * 1024;
+
+auto encode_u32(std::uint32_t value) -> std::array<std::byte, 4>
+{
+    return {std::byte(value & 0xFF), std::byte((value >> 8) & 0xFF), std::byte((value >> 16) & 0xFF),
+            std::byte(value >> 24)};
+}
+
+auto decode_u32(const std::byte* data) -> std::uint32_t
+{
+    return std::to_integer<std::uint32_t>(data[0]) | std::to_integer<std::uint32_t>(data[1]) << 8 |
+           std::to_integer<std::uint32_t>(data[2]) << 16 | std::to_integer<std::uint32_t>(data[3]) << 24;
+}
+
+} // namespace
+
+LengthPrefixedFramer::LengthPrefixedFramer(FrameChecksum checksum, std::size_t max_frame_length)
+    : _checksum(checksum), _max_frame_length(max_frame_length)
+{
+}
+
+void LengthPrefixedFramer::receive_from(StreamSocket& socket, std::size_t& received_length, std::error_code& ec)
+{
+    const std::span<std::byte> space = prepare(RECEIVE_CHUNK_LENGTH);
+
+    socket.receive(space.data(), space.size(), received_length, ec);
+    if (!ec)
+        commit(received_length);
+}
+
+auto LengthPrefixedFramer::prepare(std::size_t min_length) -> std::span<std::byte>
+{
+    if (_buffer.size() - _end < min_length)
+    {
+        // move the current frame to the front
+        if (_begin > 0)
+        {
+            std::memmove(_buffer.data(), _buffer.data() + _begin, _end - _begin);
+            _end -= _begin;
+            _begin = 0;
+        }
+
+        if (_buffer.size() - _end < min_length)
+            _buffer.resize(std::max(_buffer.size() * 2, _end + min_length));
+    }
+
+    return std::span<std::byte>(_buffer.data() + _end, _buffer.size() - _end);
+}
+
+void LengthPrefixedFramer::commit(std::size_t length)
+{
+    _end += length;
+
+    // checksum while the received bytes are still hot in cache
+    update_checksum();
+}
+
+void LengthPrefixedFramer::feed(const void* data, std::size_t length)
+{
+    std::memcpy(prepare(length).data(), data, length);
+    commit(length);
+}
+
+auto LengthPrefixedFramer::next_frame(std::error_code& ec) -> std::optional<std::span<const std::byte>>
+{
+    ec.clear();
+
+    if (!_payload_length && !parse_header(ec))
+        return std::nullopt;
+
+    const std::size_t trailer_length = (FrameChecksum::CRC32C == _checksum) ? TRAILER_LENGTH : 0;
+    const std::size_t frame_length = HEADER_LENGTH + *_payload_length + trailer_length;
+    if (_end - _begin < frame_length)
+        return std::nullopt;
+
+    const std::byte* payload = _buffer.data() + _begin + HEADER_LENGTH;
+    if (FrameChecksum::CRC32C == _checksum)
+    {
+        update_checksum();
+        if (_crc.get_value() != decode_u32(payload + *_payload_length))
+        {
+            ec = StreamErrc::CHECKSUM_MISMATCH;
+            return std::nullopt;
+        }
+    }
+
+    const std::span<const std::byte> frame(payload, *_payload_length);
+
+    _begin += frame_length;
+    if (_begin == _end)
+        _begin = _end = 0; // rewind for free while empty
+    _payload_length.reset();
+
+    // start checksumming the next frame, if its header is already here
+    std::error_code next_ec;
+    parse_header(next_ec);
+
+    return frame;
+}
+
+void LengthPrefixedFramer::reset()
+{
+    _begin = _end = 0;
+    _payload_length.reset();
+}
+
+auto LengthPrefixedFramer::get_buffered_length() const -> std::size_t
+{
+    return _end - _begin;
+}
+
+auto LengthPrefixedFramer::get_checksum() const -> FrameChecksum
+{
+    return _checksum;
+}
+
+auto LengthPrefixedFramer::get_max_frame_length() const -> std::size_t
+{
+    return _max_frame_length;
+}
+
+void LengthPrefixedFramer::append_frame(std::vector<std::byte>& out, std::span<const std::byte> payload,
+                                        FrameChecksum checksum)
+{
+    const auto header = encode_header(payload.size());
+    out.insert(out.end(), header.begin(), header.end());
+    out.insert(out.end(), payload.begin(), payload.end());
+
+    if (FrameChecksum::CRC32C == checksum)
+    {
+        const auto trailer = encode_trailer(payload);
+        out.insert(out.end(), trailer.begin(), trailer.end());
+    }
+}
+
+auto LengthPrefixedFramer::encode_header(std::size_t payload_length) -> std::array<std::byte, HEADER_LENGTH>
+{
+    return encode_u32(static_cast<std::uint32_t>(payload_length));
+}
+
+auto LengthPrefixedFramer::encode_trailer(std::span<const std::byte> payload) -> std::array<std::byte, TRAILER_LENGTH>
+{
+    return encode_u32(Crc32c::compute(payload.data(), payload.size()));
+}
+
+bool LengthPrefixedFramer::parse_header(std::error_code& ec)
+{
+    if (_end - _begin < HEADER_LENGTH)
+        return false;
+
+    const std::uint32_t payload_length = decode_u32(_buffer.data() + _begin);
+    if (payload_length > _max_frame_length)
+    {
+        ec = StreamErrc::FRAME_TOO_LONG;
+        return false;
+    }
+
+    _payload_length = payload_length;
+    _checksummed_length = 0;
+    _crc.reset();
+
+    update_checksum();
+    return true;
+}
+
+void LengthPrefixedFramer::update_checksum()
+{
+    if (FrameChecksum::CRC32C != _checksum)
+        return;
+
+    if (!_payload_length)
+    {
+        std::error_code ec; // reported by `next_frame()` instead
+        if (!parse_header(ec))
+            return;
+    }
+
+    const std::size_t received_payload_length =
+        std::min<std::size_t>(*_payload_length, _end - _begin - HEADER_LENGTH);
+    if (received_payload_length <= _checksummed_length)
+        return;
+
+    _crc.update(_buffer.data() + _begin + HEADER_LENGTH + _checksummed_length,
+                received_payload_length - _checksummed_length);
+    _checksummed_length = received_payload_length;
+}
+
+} // namespace ds
@@ -0,0 +1,237 @@
+#include "DirtySocks/Mailbox.hpp"
+
+#include "DirtySocks/ErrorConditions.hpp"
+#include "DirtySocks/IoBuffer.hpp"
+#include "DirtySocks/TcpSocket.hpp"
+
+#include <iterator>
+#include <optional>
+
+namespace ds
+{
+
+void Mailbox::open(std::error_code& ec)
+{
+    _notifier.open(ec);
+}
+
+void Mailbox::close()
+{
+    _notifier.close();
+}
+
+auto Mailbox::get_notifier() const -> const EventNotifier&
+{
+    return _notifier;
+}
+
+void Mailbox::post(Task task, std::error_code& ec)
+{
+    _queue.push(std::move(task));
+    signal(ec);
+}
+
+void Mailbox::post_send(TcpSocket& sock, std::vector<std::byte> data, std::error_code& ec)
+{
+    _queue.push(SendRequest{&sock, std::move(data)});
+    signal(ec);
+}
+
+auto Mailbox::drain(std::error_code& ec) -> std::size_t
+{
+    _notifier.consume(ec);
+    if (ec)
+        return 0;
+
+    // must be cleared before popping:
+    // a producer that pushes after this store will notify again, so its message is never left behind
+    _signaled.store(false, std::memory_order_seq_cst);
+
+    std::size_t processed = 0;
+    while (true)
+    {
+        // tasks held back by `collect_sends()` were posted before anything still queued
+        std::optional<Message> message;
+        if (!_deferred_tasks.empty())
+        {
+            message.emplace(std::move(_deferred_tasks.front()));
+            _deferred_tasks.pop_front();
+        }
+        else
+            message = _queue.try_pop();
+
+        if (!message)
+            break;
+        ++processed;
+
+        if (auto* task = std::get_if<Task>(&*message))
+            (*task)();
+        else
+            queue_send(std::get<SendRequest>(*message));
+    }
+
+    // one flush per socket, no matter how many sends were posted for it
+    // (by index, as tasks run by flush error handlers can null out entries)
+    for (std::size_t i = 0; i < _touched_sockets.size(); ++i)
+    {
+        if (TcpSocket* sock = _touched_sockets[i])
+        {
+            std::error_code send_ec;
+            flush(*sock, send_ec);
+        }
+    }
+    _touched_sockets.clear();
+
+    return processed;
+}
+
+void Mailbox::flush(TcpSocket& sock, std::error_code& ec)
+{
+    ec.clear();
+
+    auto it = _outboxes.find(&sock);
+    if (it == _outboxes.end())
+        return;
+
+    auto& outbox = it->second;
+    IoBuffer buffers[MAX_BUFFERS_PER_SEND];
+
+    while (!outbox.chunks.empty())
+    {
+        std::size_t requested_length;
+        const std::size_t buffers_count =
+            gather_io_buffers(outbox.chunks, outbox.first_chunk_offset, outbox.length, buffers, requested_length);
+
+        std::size_t sent_length;
+        sock.send(std::span<IoBuffer>(buffers, buffers_count), sent_length, ec);
+        if (ec)
+        {
+            if (ec == SocketErrc::WOULD_BLOCK)
+                ec.clear();
+            else
+            {
+                _outboxes.erase(it);
+                if (_send_error_handler)
+                    _send_error_handler(sock, ec);
+            }
+            return;
+        }
+
+        outbox.length -= sent_length;
+        consume_sent_chunks(outbox.chunks, outbox.first_chunk_offset, sent_length);
+
+        // short write, kernel buffer is full
+        if (sent_length < requested_length)
+            return;
+    }
+
+    _outboxes.erase(it);
+}
+
+bool Mailbox::has_pending_send(const TcpSocket& sock) const
+{
+    return _outboxes.contains(&sock);
+}
+
+auto Mailbox::get_pending_send_length(const TcpSocket& sock) const -> std::size_t
+{
+    const auto it = _outboxes.find(&sock);
+    return (it == _outboxes.end()) ? 0 : it->second.length;
+}
+
+void Mailbox::discard_pending_send(const TcpSocket& sock)
+{
+    // including sends still queued, which would refer to `sock` after it's gone
+    collect_sends();
+
+    _outboxes.erase(&sock);
+    forget_touched(sock);
+}
+
+auto Mailbox::take_pending_send(const TcpSocket& sock) -> Outbox
+{
+    collect_sends();
+
+    auto node = _outboxes.extract(&sock);
+    forget_touched(sock);
+    return node.empty() ? Outbox{} : std::move(node.mapped());
+}
+
+void Mailbox::restore_pending_send(TcpSocket& sock, Outbox outbox, std::error_code& ec)
+{
+    ec.clear();
+    if (outbox.chunks.empty())
+        return;
+
+    auto [it, inserted] = _outboxes.try_emplace(&sock, std::move(outbox));
+    if (!inserted)
+    {
+        // `outbox` was queued before the existing ones
+        Outbox& existing = it->second;
+        if (0 != existing.first_chunk_offset)
+            existing.chunks.front().erase(existing.chunks.front().begin(),
+                                          existing.chunks.front().begin() + existing.first_chunk_offset);
+
+        outbox.length += existing.length;
+        outbox.chunks.insert(outbox.chunks.end(), std::make_move_iterator(existing.chunks.begin()),
+                             std::make_move_iterator(existing.chunks.end()));
+        existing = std::move(outbox);
+    }
+
+    flush(sock, ec);
+}
+
+void Mailbox::set_send_error_handler(SendErrorHandler handler)
+{
+    _send_error_handler = std::move(handler);
+}
+
+void Mailbox::queue_send(SendRequest& request)
+{
+    if (request.data.empty())
+        return;
+
+    auto& outbox = _outboxes[request.socket];
+    if (outbox.chunks.empty())
+        _touched_sockets.push_back(request.socket);
+    outbox.length += request.data.size();
+    outbox.chunks.push_back(std::move(request.data));
+}
+
+void Mailbox::collect_sends()
+{
+    const bool had_deferred_tasks = !_deferred_tasks.empty();
+
+    while (auto message = _queue.try_pop())
+    {
+        if (auto* task = std::get_if<Task>(&*message))
+            _deferred_tasks.push_back(std::move(*task));
+        else
+            queue_send(std::get<SendRequest>(*message));
+    }
+
+    // their producers may have skipped notifying, so make sure a `drain()` comes to run them
+    if (!had_deferred_tasks && !_deferred_tasks.empty())
+    {
+        std::error_code ec;
+        signal(ec);
+    }
+}
+
+void Mailbox::forget_touched(const TcpSocket& sock)
+{
+    // `sock` may be gone by the time `drain()` flushes the touched sockets
+    std::replace(_touched_sockets.begin(), _touched_sockets.end(), const_cast<TcpSocket*>(&sock),
+                 static_cast<TcpSocket*>(nullptr));
+}
+
+void Mailbox::signal(std::error_code& ec)
+{
+    ec.clear();
+
+    // only the producer that makes the mailbox non-empty wakes up the owner
+    if (!_signaled.exchange(true, std::memory_order_seq_cst))
+        _notifier.notify(ec);
+}
+
+} // namespace ds
@@ -0,0 +1,114 @@
+#include "DirtySocks/OutboundQueue.hpp"
+
+#include "DirtySocks/ErrorConditions.hpp"
+#include "DirtySocks/IoBuffer.hpp"
+#include "DirtySocks/StreamSocket.hpp"
+
+#include <algorithm>
+
+namespace ds
+{
+
+void OutboundQueue::push(SharedBuffer buffer)
+{
+    if (buffer.empty())
+        return;
+
+    _length += buffer.size();
+    _buffers.push_back(std::move(buffer));
+}
+
+void OutboundQueue::flush(StreamSocket& sock, std::size_t& sent_length, std::error_code& ec)
+{
+    ec.clear();
+    sent_length = 0;
+
+    IoBuffer buffers[MAX_BUFFERS_PER_SEND];
+
+    while (0 != _length)
+    {
+        std::size_t requested_length;
+        const std::size_t buffers_count =
+            gather_io_buffers(_buffers, _first_buffer_offset, _length, buffers, requested_length);
+
+        std::size_t sent;
+        sock.send(std::span<IoBuffer>(buffers, buffers_count), sent, ec);
+        if (ec)
+        {
+            if (ec == SocketErrc::WOULD_BLOCK)
+                ec.clear();
+            return;
+        }
+
+        sent_length += sent;
+
+        _length -= sent;
+        consume_sent_chunks(_buffers, _first_buffer_offset, sent);
+
+        // short write, kernel buffer is full
+        if (sent < requested_length)
+            return;
+    }
+}
+
+void OutboundQueue::clear()
+{
+    _buffers.clear();
+    _first_buffer_offset = 0;
+    _length = 0;
+}
+
+bool OutboundQueue::empty() const
+{
+    return 0 == _length;
+}
+
+auto OutboundQueue::get_length() const -> std::size_t
+{
+    return _length;
+}
+
+auto OutboundQueue::get_buffers_count() const -> std::size_t
+{
+    return _buffers.size();
+}
+
+void broadcast(const SharedBuffer& buffer, std::span<OutboundQueue* const> queues)
+{
+    if (buffer.empty())
+        return;
+
+    const auto queues_count =
+        static_cast<std::uint32_t>(std::count_if(queues.begin(), queues.end(), [](auto* q) { return q != nullptr; }));
+    if (0 == queues_count)
+        return;
+
+    // one increment for all the queues, each adopting one count
+    buffer._header->use_count.fetch_add(queues_count, std::memory_order_relaxed);
+
+    // if a `push_back()` throws, gives back the counts of the queues not reached, which can't be the last ones
+    // as `buffer` holds one; the count handed to the failed push is given back by its temporary
+    struct UnadoptedCounts
+    {
+        SharedBuffer::Header* header;
+        std::uint32_t count;
+
+        ~UnadoptedCounts()
+        {
+            if (0 != count)
+                header->use_count.fetch_sub(count, std::memory_order_relaxed);
+        }
+    } unadopted{buffer._header, queues_count};
+
+    for (OutboundQueue* queue : queues)
+    {
+        if (!queue)
+            continue;
+
+        --unadopted.count;
+        queue->_buffers.push_back(SharedBuffer(buffer._header));
+        queue->_length += buffer.size();
+    }
+}
+
+} // namespace ds
@@ -0,0 +1,201 @@
+#include "DirtySocks/PacedSender.hpp"
+
+#include "DirtySocks/ErrorConditions.hpp"
+#include "DirtySocks/IoBuffer.hpp"
+#include "DirtySocks/StreamSocket.hpp"
+
+#include <algorithm>
+
+namespace ds
+{
+
+void PacedSender::add(StreamSocket& sock, std::uint64_t rate, std::size_t burst, Clock::time_point now)
+{
+    _entries.try_emplace(&sock, TokenBucket(rate, burst, now));
+}
+
+void PacedSender::remove(const StreamSocket& sock)
+{
+    // its heap items become stale
+    _entries.erase(&sock);
+}
+
+void PacedSender::set_rate(StreamSocket& sock, std::uint64_t rate, std::size_t burst, Clock::time_point now)
+{
+    auto it = _entries.find(&sock);
+    if (it == _entries.end())
+        return;
+
+    Entry& entry = it->second;
+    entry.bucket.set_rate(rate, burst, now);
+
+    // the old wake-up time is based on the old rate
+    if (!entry.blocked && 0 != entry.length)
+        schedule_refill(sock, entry, get_min_send_length(entry), now);
+}
+
+void PacedSender::send(StreamSocket& sock, std::vector<std::byte> data, Clock::time_point now, std::error_code& ec)
+{
+    ec.clear();
+
+    auto it = _entries.find(&sock);
+    if (it == _entries.end() || data.empty())
+        return;
+
+    Entry& entry = it->second;
+    const bool was_idle = (0 == entry.length);
+
+    entry.length += data.size();
+    entry.chunks.push_back(std::move(data));
+
+    // otherwise, it's already waiting for its wake-up or for writability
+    if (was_idle)
+        flush(sock, entry, now, ec);
+}
+
+void PacedSender::run(Clock::time_point now)
+{
+    while (!_wakeups.empty() && _wakeups.front().time <= now)
+    {
+        std::pop_heap(_wakeups.begin(), _wakeups.end());
+        const Wakeup wakeup = _wakeups.back();
+        _wakeups.pop_back();
+
+        if (is_stale(wakeup))
+            continue;
+
+        Entry& entry = _entries.find(wakeup.socket)->second;
+        entry.schedule_id = 0;
+
+        std::error_code ec;
+        flush(*wakeup.socket, entry, now, ec);
+        if (ec && _send_error_handler)
+            _send_error_handler(*wakeup.socket, ec);
+    }
+}
+
+auto PacedSender::get_next_wakeup() -> std::optional<Clock::time_point>
+{
+    while (!_wakeups.empty() && is_stale(_wakeups.front()))
+    {
+        std::pop_heap(_wakeups.begin(), _wakeups.end());
+        _wakeups.pop_back();
+    }
+
+    if (_wakeups.empty())
+        return std::nullopt;
+    return _wakeups.front().time;
+}
+
+void PacedSender::on_writable(StreamSocket& sock, Clock::time_point now)
+{
+    auto it = _entries.find(&sock);
+    if (it == _entries.end() || !it->second.blocked)
+        return;
+
+    it->second.blocked = false;
+
+    std::error_code ec;
+    flush(sock, it->second, now, ec);
+    if (ec && _send_error_handler)
+        _send_error_handler(sock, ec);
+}
+
+bool PacedSender::is_blocked(const StreamSocket& sock) const
+{
+    const auto it = _entries.find(&sock);
+    return it != _entries.end() && it->second.blocked;
+}
+
+auto PacedSender::get_pending_send_length(const StreamSocket& sock) const -> std::size_t
+{
+    const auto it = _entries.find(&sock);
+    return (it == _entries.end()) ? 0 : it->second.length;
+}
+
+void PacedSender::set_send_error_handler(SendErrorHandler handler)
+{
+    _send_error_handler = std::move(handler);
+}
+
+void PacedSender::flush(StreamSocket& sock, Entry& entry, Clock::time_point now, std::error_code& ec)
+{
+    IoBuffer buffers[MAX_BUFFERS_PER_SEND];
+
+    while (0 != entry.length)
+    {
+        // wait for a worthwhile amount of tokens
+        const std::size_t min_length = get_min_send_length(entry);
+        const std::size_t available = entry.bucket.get_available(now);
+        if (0 == min_length || available < min_length)
+        {
+            schedule_refill(sock, entry, min_length, now);
+            return;
+        }
+
+        // up to the available tokens
+        std::size_t requested_length;
+        const std::size_t buffers_count =
+            gather_io_buffers(entry.chunks, entry.first_chunk_offset, available, buffers, requested_length);
+
+        std::size_t sent_length;
+        sock.send(std::span<IoBuffer>(buffers, buffers_count), sent_length, ec);
+        if (ec)
+        {
+            if (ec == SocketErrc::WOULD_BLOCK)
+            {
+                ec.clear();
+                entry.blocked = true;
+            }
+            else
+                _entries.erase(&sock);
+            return;
+        }
+
+        entry.bucket.consume(sent_length, now);
+
+        entry.length -= sent_length;
+        consume_sent_chunks(entry.chunks, entry.first_chunk_offset, sent_length);
+
+        // short write, kernel buffer is full
+        if (sent_length < requested_length)
+        {
+            entry.blocked = true;
+            return;
+        }
+    }
+}
+
+auto PacedSender::get_min_send_length(const Entry& entry) -> std::size_t
+{
+    // the bucket never holds more than `burst`, so that's all a send can wait for
+    return std::min({entry.length, MIN_SEND_LENGTH, entry.bucket.get_burst()});
+}
+
+void PacedSender::schedule_refill(StreamSocket& sock, Entry& entry, std::size_t min_length, Clock::time_point now)
+{
+    // an empty bucket that never refills waits for `set_rate()`, which drops the old wake-up too
+    if (0 == entry.bucket.get_rate() || 0 == entry.bucket.get_burst())
+    {
+        entry.schedule_id = 0;
+        return;
+    }
+
+    schedule(sock, entry, now + entry.bucket.get_wait_time(min_length, now));
+}
+
+void PacedSender::schedule(StreamSocket& sock, Entry& entry, Clock::time_point time)
+{
+    entry.schedule_id = _next_schedule_id++;
+
+    _wakeups.push_back(Wakeup{time, &sock, entry.schedule_id});
+    std::push_heap(_wakeups.begin(), _wakeups.end());
+}
+
+bool PacedSender::is_stale(const Wakeup& wakeup) const
+{
+    const auto it = _entries.find(wakeup.socket);
+    return it == _entries.end() || it->second.schedule_id != wakeup.schedule_id;
+}
+
+} // namespace ds
@@ -0,0 +1,316 @@
+#include "DirtySocks/PollSelector.hpp"
+
+#include "DirtySocks/Socket.hpp"
+#include "DirtySocks/System.hpp"
+
+#include "SpinWait.hpp"
+
+#include <utility>
+
+namespace ds
+{
+
+namespace
+{
+
+#ifdef _WIN32
+// `WSAPoll()` rejects `POLLPRI`, and its `POLLIN` includes `POLLRDBAND`
+constexpr short READ_EVENTS = POLLRDNORM;
+constexpr short EXCEPT_EVENTS = POLLRDBAND;
+#else // POSIX
+constexpr short READ_EVENTS = POLLIN;
+constexpr short EXCEPT_EVENTS = POLLPRI;
+#endif
+constexpr short WRITE_EVENTS = POLLOUT;
+
+// `::select()` reports these as readable & writable, so that the next operation on it gets the error
+constexpr short ERROR_EVENTS = POLLERR | POLLHUP | POLLNVAL;
+
+auto to_events(PollInterest interest) -> short
+{
+    short events = 0;
+    if (!!(interest & PollInterest::READ))
+        events |= READ_EVENTS;
+    if (!!(interest & PollInterest::WRITE))
+        events |= WRITE_EVENTS;
+    if (!!(interest & PollInterest::EXCEPT))
+        events |= EXCEPT_EVENTS;
+    return events;
+}
+
+} // namespace
+
+int PollSelector::select(timeval* timeout, std::error_code& ec)
+{
+    return spin_then_wait(_spin_duration, timeout, _spin_stats, ec,
+                          [this](timeval* wait_timeout, std::error_code& wait_ec) {
+                              return poll_once(wait_timeout, wait_ec);
+                          });
+}
+
+int PollSelector::poll_once(timeval* timeout, std::error_code& ec)
+{
+    ec.clear();
+
+    compact();
+
+#ifdef _WIN32
+    // round up, not to wake up before the timeout
+    const INT timeout_ms = (timeout) ? static_cast<INT>(timeout->tv_sec * 1000 + (timeout->tv_usec + 999) / 1000) : -1;
+    const int poll_result = ::WSAPoll(_pollfds.data(), static_cast<ULONG>(_pollfds.size()), timeout_ms);
+#elif defined(__linux__)
+    timespec timeout_ts;
+    if (timeout)
+    {
+        timeout_ts.tv_sec = timeout->tv_sec;
+        timeout_ts.tv_nsec = timeout->tv_usec * 1000;
+    }
+    const int poll_result =
+        ::ppoll(_pollfds.data(), static_cast<nfds_t>(_pollfds.size()), (timeout) ? &timeout_ts : nullptr, nullptr);
+#else // POSIX
+    // round up, not to wake up before the timeout
+    const int timeout_ms = (timeout) ? static_cast<int>(timeout->tv_sec * 1000 + (timeout->tv_usec + 999) / 1000) : -1;
+    const int poll_result = ::poll(_pollfds.data(), static_cast<nfds_t>(_pollfds.size()), timeout_ms);
+#endif
+    if (SOCKET_ERROR == poll_result)
+    {
+        ec = System::get_last_error_code();
+        return 0;
+    }
+
+    return poll_result;
+}
+
+bool PollSelector::has_read(const Socket& sock) const
+{
+    const pollfd* entry = find(sock);
+    return entry && (entry->events & READ_EVENTS) && (entry->revents & (READ_EVENTS | ERROR_EVENTS));
+}
+
+bool PollSelector::has_write(const Socket& sock) const
+{
+    const pollfd* entry = find(sock);
+    return entry && (entry->events & WRITE_EVENTS) && (entry->revents & (WRITE_EVENTS | ERROR_EVENTS));
+}
+
+bool PollSelector::has_except(const Socket& sock) const
+{
+    const pollfd* entry = find(sock);
+    return entry && (entry->events & EXCEPT_EVENTS) && (entry->revents & EXCEPT_EVENTS);
+}
+
+void PollSelector::add_to_read_set(const Socket& sock, std::error_code& ec)
+{
+    ec.clear();
+    add_interest(sock.get_handle(), READ_EVENTS, nullptr);
+}
+
+void PollSelector::add_to_write_set(const Socket& sock, std::error_code& ec)
+{
+    ec.clear();
+    add_interest(sock.get_handle(), WRITE_EVENTS, nullptr);
+}
+
+void PollSelector::add_to_except_set(const Socket& sock, std::error_code& ec)
+{
+    ec.clear();
+    add_interest(sock.get_handle(), EXCEPT_EVENTS, nullptr);
+}
+
+void PollSelector::remove_from_read_set(const Socket& sock)
+{
+    remove_interest(sock.get_handle(), READ_EVENTS);
+}
+
+void PollSelector::remove_from_write_set(const Socket& sock)
+{
+    remove_interest(sock.get_handle(), WRITE_EVENTS);
+}
+
+void PollSelector::remove_from_except_set(const Socket& sock)
+{
+    remove_interest(sock.get_handle(), EXCEPT_EVENTS);
+}
+
+void PollSelector::clear_read_set()
+{
+    clear_interest(READ_EVENTS);
+}
+
+void PollSelector::clear_write_set()
+{
+    clear_interest(WRITE_EVENTS);
+}
+
+void PollSelector::clear_except_set()
+{
+    clear_interest(EXCEPT_EVENTS);
+}
+
+void PollSelector::add(const Socket& sock, PollInterest interest, std::uint64_t token, std::error_code& ec)
+{
+    ec.clear();
+    add_interest(sock.get_handle(), to_events(interest), &token);
+}
+
+void PollSelector::remove(const Socket& sock)
+{
+    remove_interest(sock.get_handle(), READ_EVENTS | WRITE_EVENTS | EXCEPT_EVENTS);
+}
+
+auto PollSelector::read_set_count() -> std::size_t
+{
+    return _read_count;
+}
+
+auto PollSelector::write_set_count() -> std::size_t
+{
+    return _write_count;
+}
+
+auto PollSelector::except_set_count() -> std::size_t
+{
+    return _except_count;
+}
+
+void PollSelector::set_spin_duration(std::chrono::microseconds spin_duration)
+{
+    _spin_duration = std::max(std::chrono::microseconds(0), spin_duration);
+}
+
+auto PollSelector::get_spin_duration() const -> std::chrono::microseconds
+{
+    return _spin_duration;
+}
+
+auto PollSelector::get_spin_stats() const -> const SpinStats&
+{
+    return _spin_stats;
+}
+
+void PollSelector::reset_spin_stats()
+{
+    _spin_stats = SpinStats{};
+}
+
+void PollSelector::add_interest(SOCKET handle, short events, const std::uint64_t* token)
+{
+    auto it = _indices.find(handle);
+    if (it == _indices.end())
+    {
+        it = _indices.emplace(handle, _pollfds.size()).first;
+
+        pollfd entry{};
+        entry.fd = handle;
+        _pollfds.push_back(entry);
+        _tokens.push_back(static_cast<std::uint64_t>(handle));
+    }
+
+    pollfd& entry = _pollfds[it->second];
+    const short added = events & ~entry.events;
+    entry.events |= events;
+    if (token)
+        _tokens[it->second] = *token;
+
+    _read_count += (added & READ_EVENTS) ? 1 : 0;
+    _write_count += (added & WRITE_EVENTS) ? 1 : 0;
+    _except_count += (added & EXCEPT_EVENTS) ? 1 : 0;
+}
+
+void PollSelector::remove_interest(SOCKET handle, short events)
+{
+    // do nothing if non-existing socket passed
+    const auto it = _indices.find(handle);
+    if (it == _indices.end())
+        return;
+
+    pollfd& entry = _pollfds[it->second];
+    const short removed = events & entry.events;
+    entry.events &= ~events;
+
+    _read_count -= (removed & READ_EVENTS) ? 1 : 0;
+    _write_count -= (removed & WRITE_EVENTS) ? 1 : 0;
+    _except_count -= (removed & EXCEPT_EVENTS) ? 1 : 0;
+
+    if (0 == entry.events)
+        erase_at(it->second);
+}
+
+void PollSelector::clear_interest(short events)
+{
+    // backwards, so that swap-and-pop only moves already visited elements
+    for (std::size_t i = _pollfds.size(); i-- > 0;)
+    {
+        if (INVALID_SOCKET != _pollfds[i].fd)
+            remove_interest(_pollfds[i].fd, events);
+    }
+}
+
+void PollSelector::erase_at(std::size_t index)
+{
+    _indices.erase(_pollfds[index].fd);
+
+    if (_iterating)
+    {
+        _pollfds[index].fd = INVALID_SOCKET;
+        _pollfds[index].events = 0;
+        _pollfds[index].revents = 0;
+        ++_holes_count;
+        return;
+    }
+
+    const std::size_t last = _pollfds.size() - 1;
+    if (index != last)
+    {
+        _pollfds[index] = _pollfds[last];
+        _tokens[index] = _tokens[last];
+        if (INVALID_SOCKET != _pollfds[index].fd)
+            _indices[_pollfds[index].fd] = index;
+    }
+    _pollfds.pop_back();
+    _tokens.pop_back();
+}
+
+void PollSelector::compact()
+{
+    if (0 == _holes_count)
+        return;
+
+    // backwards, so that swap-and-pop only moves already visited elements
+    for (std::size_t i = _pollfds.size(); i-- > 0;)
+    {
+        if (INVALID_SOCKET == _pollfds[i].fd)
+        {
+            const std::size_t last = _pollfds.size() - 1;
+            if (i != last)
+            {
+                _pollfds[i] = _pollfds[last];
+                _tokens[i] = _tokens[last];
+                _indices[_pollfds[i].fd] = i;
+            }
+            _pollfds.pop_back();
+            _tokens.pop_back();
+        }
+    }
+    _holes_count = 0;
+}
+
+auto PollSelector::find(const Socket& sock) const -> const pollfd*
+{
+    const auto it = _indices.find(sock.get_handle());
+    return (it == _indices.end()) ? nullptr : &_pollfds[it->second];
+}
+
+auto PollSelector::get_ready(std::size_t index) const -> Ready
+{
+    const pollfd& entry = _pollfds[index];
+
+    Ready ready;
+    ready.token = _tokens[index];
+    ready.read = (entry.events & READ_EVENTS) && (entry.revents & (READ_EVENTS | ERROR_EVENTS));
+    ready.write = (entry.events & WRITE_EVENTS) && (entry.revents & (WRITE_EVENTS | ERROR_EVENTS));
+    ready.except = (entry.events & EXCEPT_EVENTS) && (entry.revents & EXCEPT_EVENTS);
+    return ready;
+}
+
+} // namespace ds
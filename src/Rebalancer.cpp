@@ -0,0 +1,119 @@
+#include "DirtySocks/Rebalancer.hpp"
+
+#include "DirtySocks/EventLoop.hpp"
+#include "DirtySocks/Runtime.hpp"
+
+#include <algorithm>
+
+namespace ds
+{
+
+Rebalancer::Rebalancer(Runtime& runtime, RebalancerConfig config) : _runtime(runtime), _config(config)
+{
+}
+
+Rebalancer::~Rebalancer()
+{
+    stop();
+}
+
+void Rebalancer::start()
+{
+    if (_thread.joinable())
+        return;
+
+    _stopping = false;
+    _thread = std::thread([this] {
+        std::unique_lock lock(_mutex);
+        while (!_stop_cv.wait_for(lock, _config.period, [this] { return _stopping; }))
+        {
+            lock.unlock();
+
+            // loops are posted to, never waited for, so an error here just skips this period
+            std::error_code ec;
+            rebalance(ec);
+
+            lock.lock();
+        }
+    });
+}
+
+void Rebalancer::stop()
+{
+    if (!_thread.joinable())
+        return;
+
+    {
+        std::lock_guard lock(_mutex);
+        _stopping = true;
+    }
+    _stop_cv.notify_one();
+    _thread.join();
+}
+
+void Rebalancer::rebalance(std::error_code& ec)
+{
+    ec.clear();
+
+    // against `get_utilization()` from other threads
+    std::lock_guard lock(_mutex);
+
+    const std::size_t loops_count = _runtime.get_loops_count();
+    const auto now = Clock::now();
+
+    std::vector<std::chrono::nanoseconds> busy_times(loops_count);
+    for (std::size_t i = 0; i < loops_count; ++i)
+        busy_times[i] = _runtime.get_loop(i).get_busy_time();
+
+    // baseline
+    if (_last_busy_times.size() != loops_count)
+    {
+        _last_busy_times = std::move(busy_times);
+        _last_time = now;
+        _utilizations.assign(loops_count, 0.0);
+        return;
+    }
+
+    const std::chrono::duration<double> elapsed = now - _last_time;
+    for (std::size_t i = 0; i < loops_count; ++i)
+    {
+        const std::chrono::duration<double> busy = busy_times[i] - _last_busy_times[i];
+        _utilizations[i] = (elapsed.count() > 0) ? std::min(busy / elapsed, 1.0) : 0.0;
+    }
+    _last_busy_times = std::move(busy_times);
+    _last_time = now;
+
+    if (loops_count < 2)
+        return;
+
+    const auto [least, most] = std::minmax_element(_utilizations.begin(), _utilizations.end());
+    const auto source = static_cast<std::size_t>(most - _utilizations.begin());
+    const auto target = static_cast<std::size_t>(least - _utilizations.begin());
+
+    const bool overloaded = *most > _config.high_utilization && *most - *least >= _config.min_difference;
+
+    // every loop starts a new window of connection loads
+    for (std::size_t i = 0; i < loops_count; ++i)
+    {
+        EventLoop& loop = _runtime.get_loop(i);
+        if (overloaded && i == source)
+        {
+            // even them out: half the difference, as a fraction of the source's load
+            const double load_fraction = (*most - *least) / (2 * *most);
+            _runtime.post(i, [&loop, target, load_fraction] { loop.shed(target, load_fraction); }, ec);
+        }
+        else
+            _runtime.post(i, [&loop] { loop.reset_token_loads(); }, ec);
+
+        if (ec)
+            return;
+    }
+}
+
+auto Rebalancer::get_utilization(std::size_t loop_index) const -> double
+{
+    std::lock_guard lock(_mutex);
+    return (loop_index < _utilizations.size()) ? _utilizations[loop_index] : 0.0;
+}
+
+} // namespace ds
@@ -0,0 +1,509 @@
+#include "DirtySocks/ReliablePeer.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/ErrorConditions.hpp"
+#include "DirtySocks/UdpSocket.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ds
+{
+
+namespace
+{
+
+constexpr std::size_t SENT_PACKETS_CAPACITY = 256;
+constexpr std::size_t RECEIVED_PACKETS_CAPACITY = 256;
+
+constexpr unsigned ACK_BITS = 32;
+
+// a packet unacked while this many later ones were is taken as lost, like TCP's 3 duplicate acks
+constexpr std::uint16_t LOSS_THRESHOLD = 3;
+
+// largest UDP payload over IPv4
+constexpr std::size_t MAX_DATAGRAM_LENGTH = 65507;
+
+void encode_u16(std::byte* data, std::uint16_t value)
+{
+    data[0] = std::byte(value & 0xFF);
+    data[1] = std::byte(value >> 8);
+}
+
+void encode_u32(std::byte* data, std::uint32_t value)
+{
+    encode_u16(data, static_cast<std::uint16_t>(value & 0xFFFF));
+    encode_u16(data + 2, static_cast<std::uint16_t>(value >> 16));
+}
+
+auto decode_u16(const std::byte* data) -> std::uint16_t
+{
+    return static_cast<std::uint16_t>(std::to_integer<std::uint16_t>(data[0]) |
+                                      std::to_integer<std::uint16_t>(data[1]) << 8);
+}
+
+auto decode_u32(const std::byte* data) -> std::uint32_t
+{
+    return static_cast<std::uint32_t>(decode_u16(data)) | static_cast<std::uint32_t>(decode_u16(data + 2)) << 16;
+}
+
+void encode_message_header(std::byte* data, std::size_t channel, std::uint16_t id, std::size_t length)
+{
+    data[0] = std::byte(channel);
+    encode_u16(data + 1, id);
+    encode_u16(data + 3, static_cast<std::uint16_t>(length));
+}
+
+auto sanitize(ReliablePeerConfig config) -> ReliablePeerConfig
+{
+    constexpr std::size_t min_packet_length = ReliablePeer::PACKET_HEADER_LENGTH + ReliablePeer::MESSAGE_HEADER_LENGTH;
+
+    // channel indexes are 8-bit
+    if (config.channels.size() > 256)
+        config.channels.resize(256);
+
+    config.max_packet_length = std::clamp(config.max_packet_length, min_packet_length, MAX_DATAGRAM_LENGTH);
+    config.max_message_length = std::min(config.max_message_length, config.max_packet_length - min_packet_length);
+
+    // well within half the 16-bit id range, so old ids never look new
+    config.reliable_window = std::clamp<std::size_t>(config.reliable_window, 1, 0x4000);
+
+    config.unreliable_queue_length = std::max(config.unreliable_queue_length,
+                                              ReliablePeer::MESSAGE_HEADER_LENGTH + config.max_message_length);
+    config.min_rto = std::max(config.min_rto, std::chrono::milliseconds(1));
+    config.max_rto = std::max(config.max_rto, config.min_rto);
+    return config;
+}
+
+} // namespace
+
+ReliablePeer::ReliablePeer(ReliablePeerConfig config)
+    : _config(sanitize(std::move(config))), _sent_packets(SENT_PACKETS_CAPACITY),
+      _received_packets(RECEIVED_PACKETS_CAPACITY), _unreliable_queue(_config.unreliable_queue_length),
+      _packet_buffer(_config.max_packet_length), _rto(_config.initial_rto)
+{
+    for (const ChannelDelivery delivery : _config.channels)
+    {
+        const bool reliable = ChannelDelivery::RELIABLE_ORDERED == delivery;
+
+        PendingMessage prototype;
+        if (reliable)
+            prototype.data.resize(_config.max_message_length);
+
+        const std::size_t window = reliable ? _config.reliable_window : 1;
+        _channels.push_back(Channel{.delivery = delivery,
+                                    .send_window = SequenceBuffer<PendingMessage>(window, prototype),
+                                    .receive_window = SequenceBuffer<PendingMessage>(window, prototype)});
+    }
+}
+
+void ReliablePeer::set_message_handler(MessageHandler handler)
+{
+    _message_handler = std::move(handler);
+}
+
+void ReliablePeer::send(std::size_t channel, std::span<const std::byte> message, std::error_code& ec)
+{
+    ec.clear();
+
+    if (channel >= _channels.size())
+    {
+        ec = SystemErrc::invalid_argument;
+        return;
+    }
+    if (message.size() > _config.max_message_length)
+    {
+        ec = SystemErrc::message_size;
+        return;
+    }
+
+    Channel& ch = _channels[channel];
+    if (ChannelDelivery::RELIABLE_ORDERED == ch.delivery)
+    {
+        if (static_cast<std::uint16_t>(ch.next_send_id - ch.oldest_unacked_id) >= ch.send_window.get_capacity())
+        {
+            ec = SystemErrc::no_buffer_space;
+            return;
+        }
+
+        PendingMessage& pending = ch.send_window.insert(ch.next_send_id++);
+        std::copy(message.begin(), message.end(), pending.data.begin());
+        pending.length = message.size();
+        pending.resend_time = Clock::time_point::min(); // due right away
+        pending.send_count = 0;
+        return;
+    }
+
+    if (_unreliable_queue.size() - _unreliable_length < MESSAGE_HEADER_LENGTH + message.size())
+    {
+        ec = SystemErrc::no_buffer_space;
+        return;
+    }
+
+    std::byte* const data = _unreliable_queue.data() + _unreliable_length;
+    encode_message_header(data, channel, ch.next_send_id++, message.size());
+    std::copy(message.begin(), message.end(), data + MESSAGE_HEADER_LENGTH);
+    _unreliable_length += MESSAGE_HEADER_LENGTH + message.size();
+}
+
+bool ReliablePeer::write_packet(std::span<std::byte> packet, std::size_t& packet_length, Clock::time_point now)
+{
+    packet_length = 0;
+
+    const std::size_t limit = std::min(packet.size(), _config.max_packet_length);
+    if (limit < PACKET_HEADER_LENGTH)
+        return false;
+
+    const std::uint16_t sequence = _next_packet_sequence;
+    std::size_t offset = PACKET_HEADER_LENGTH;
+
+    // due reliable messages first, oldest first; ones that don't fit wait for the next packet
+    std::array<MessageRef, MAX_RELIABLE_PER_PACKET> reliable;
+    std::size_t reliable_count = 0;
+    for (std::size_t channel = 0; channel < _channels.size() && reliable_count < MAX_RELIABLE_PER_PACKET; ++channel)
+    {
+        Channel& ch = _channels[channel];
+        if (ChannelDelivery::RELIABLE_ORDERED != ch.delivery)
+            continue;
+
+        for (std::uint16_t id = ch.oldest_unacked_id; id != ch.next_send_id; ++id)
+        {
+            PendingMessage* pending = ch.send_window.find(id);
+            if (!pending || now < pending->resend_time || offset + MESSAGE_HEADER_LENGTH + pending->length > limit)
+                continue;
+
+            encode_message_header(packet.data() + offset, channel, id, pending->length);
+            std::memcpy(packet.data() + offset + MESSAGE_HEADER_LENGTH, pending->data.data(), pending->length);
+            offset += MESSAGE_HEADER_LENGTH + pending->length;
+
+            if (pending->send_count > 0)
+                ++_stats.messages_resent;
+            ++pending->send_count;
+            pending->resend_time = now + get_backoff_rto(pending->send_count);
+            pending->packet_sequence = sequence;
+
+            reliable[reliable_count++] = MessageRef{static_cast<std::uint8_t>(channel), id};
+            if (MAX_RELIABLE_PER_PACKET == reliable_count)
+                break;
+        }
+    }
+
+    // then as many of the queued unreliable ones as fit, in order
+    std::size_t unreliable_length = 0;
+    while (unreliable_length < _unreliable_length)
+    {
+        const std::size_t length =
+            MESSAGE_HEADER_LENGTH + decode_u16(_unreliable_queue.data() + unreliable_length + 3);
+        if (offset + unreliable_length + length > limit)
+            break;
+        unreliable_length += length;
+    }
+    if (unreliable_length > 0)
+    {
+        std::memcpy(packet.data() + offset, _unreliable_queue.data(), unreliable_length);
+        offset += unreliable_length;
+
+        _unreliable_length -= unreliable_length;
+        std::memmove(_unreliable_queue.data(), _unreliable_queue.data() + unreliable_length, _unreliable_length);
+    }
+
+    if (PACKET_HEADER_LENGTH == offset && !_ack_pending)
+        return false;
+
+    std::uint32_t ack_bits = 0;
+    if (_received_any)
+    {
+        for (unsigned i = 0; i < ACK_BITS; ++i)
+        {
+            if (_received_packets.contains(static_cast<std::uint16_t>(_remote_sequence - i)))
+                ack_bits |= 1u << i;
+        }
+    }
+
+    encode_u16(packet.data(), sequence);
+    encode_u16(packet.data() + 2, _remote_sequence);
+    encode_u32(packet.data() + 4, ack_bits);
+
+    SentPacket& sent = _sent_packets.insert(sequence);
+    sent.sent_time = now;
+    sent.acked = false;
+    sent.lost = false;
+    sent.reliable_count = static_cast<std::uint8_t>(reliable_count);
+    std::copy_n(reliable.begin(), reliable_count, sent.reliable.begin());
+
+    ++_next_packet_sequence;
+    _ack_pending = false;
+    ++_stats.packets_sent;
+
+    packet_length = offset;
+    return true;
+}
+
+void ReliablePeer::read_packet(std::span<const std::byte> packet, Clock::time_point now, std::error_code& ec)
+{
+    ec.clear();
+
+    if (packet.size() < PACKET_HEADER_LENGTH)
+    {
+        ec = StreamErrc::MALFORMED_FRAME;
+        return;
+    }
+
+    const std::uint16_t sequence = decode_u16(packet.data());
+    const std::uint16_t ack = decode_u16(packet.data() + 2);
+    const std::uint32_t ack_bits = decode_u32(packet.data() + 4);
+
+    // oldest first, so a packet isn't taken as lost by a later one acked alongside it
+    for (unsigned i = ACK_BITS; i-- > 0;)
+    {
+        if (ack_bits & (1u << i))
+            process_ack(static_cast<std::uint16_t>(ack - i), 0 == i, now);
+    }
+
+    if (_received_any)
+    {
+        // a duplicate, or too old to tell
+        if (_received_packets.contains(sequence))
+            return;
+        if (is_sequence_newer(_remote_sequence, sequence) &&
+            static_cast<std::uint16_t>(_remote_sequence - sequence) >= _received_packets.get_capacity())
+            return;
+    }
+
+    _received_packets.insert(sequence);
+    if (!_received_any || is_sequence_newer(sequence, _remote_sequence))
+        _remote_sequence = sequence;
+    _received_any = true;
+    ++_stats.packets_received;
+
+    // ack-only packets aren't acked back, or the peers would ack each other forever
+    const auto messages = packet.subspan(PACKET_HEADER_LENGTH);
+    if (!messages.empty())
+        _ack_pending = true;
+
+    if (!deliver_messages(messages))
+        ec = StreamErrc::MALFORMED_FRAME;
+}
+
+void ReliablePeer::flush(UdpSocket& socket, const SocketAddress& remote, Clock::time_point now, std::error_code& ec)
+{
+    send_packets(socket, &remote, now, ec);
+}
+
+void ReliablePeer::flush(UdpSocket& socket, Clock::time_point now, std::error_code& ec)
+{
+    send_packets(socket, nullptr, now, ec);
+}
+
+auto ReliablePeer::get_resend_time() const -> std::optional<Clock::time_point>
+{
+    std::optional<Clock::time_point> resend_time;
+    for (const Channel& ch : _channels)
+    {
+        if (ChannelDelivery::RELIABLE_ORDERED != ch.delivery)
+            continue;
+
+        for (std::uint16_t id = ch.oldest_unacked_id; id != ch.next_send_id; ++id)
+        {
+            const PendingMessage* pending = ch.send_window.find(id);
+            if (pending && (!resend_time || pending->resend_time < *resend_time))
+                resend_time = pending->resend_time;
+        }
+    }
+    return resend_time;
+}
+
+auto ReliablePeer::get_rtt() const -> Clock::duration
+{
+    return _srtt;
+}
+
+auto ReliablePeer::get_rto() const -> Clock::duration
+{
+    return _rto;
+}
+
+auto ReliablePeer::get_stats() const -> const ReliablePeerStats&
+{
+    return _stats;
+}
+
+void ReliablePeer::send_packets(UdpSocket& socket, const SocketAddress* remote, Clock::time_point now,
+                                std::error_code& ec)
+{
+    ec.clear();
+
+    std::size_t packet_length;
+    while (write_packet(_packet_buffer, packet_length, now))
+    {
+        std::size_t sent_length;
+        if (remote)
+            socket.send_to(_packet_buffer.data(), packet_length, *remote, sent_length, ec);
+        else
+            socket.send(_packet_buffer.data(), packet_length, sent_length, ec);
+
+        // the send buffer is full, so the rest would be dropped just the same
+        if (SocketErrc::WOULD_BLOCK == ec)
+        {
+            ec.clear();
+            return;
+        }
+        if (ec)
+            return;
+    }
+}
+
+void ReliablePeer::process_ack(std::uint16_t sequence, bool sample_rtt, Clock::time_point now)
+{
+    SentPacket* sent = _sent_packets.find(sequence);
+    if (!sent || sent->acked)
+        return;
+
+    sent->acked = true;
+    ++_stats.packets_acked;
+
+    // each packet is sent only once, so unlike a TCP segment, its ack is never ambiguous (Karn's problem)
+    if (sample_rtt)
+        update_rtt(now - sent->sent_time);
+
+    for (std::size_t i = 0; i < sent->reliable_count; ++i)
+        ack_message(sent->reliable[i]);
+
+    resend_lost(static_cast<std::uint16_t>(sequence - LOSS_THRESHOLD), now);
+}
+
+void ReliablePeer::ack_message(const MessageRef& ref)
+{
+    Channel& ch = _channels[ref.channel];
+    ch.send_window.remove(ref.id);
+
+    while (ch.oldest_unacked_id != ch.next_send_id && !ch.send_window.contains(ch.oldest_unacked_id))
+        ++ch.oldest_unacked_id;
+}
+
+void ReliablePeer::resend_lost(std::uint16_t sequence, Clock::time_point now)
+{
+    SentPacket* sent = _sent_packets.find(sequence);
+    if (!sent || sent->acked || sent->lost)
+        return;
+
+    sent->lost = true;
+    ++_stats.packets_lost;
+
+    for (std::size_t i = 0; i < sent->reliable_count; ++i)
+    {
+        const MessageRef& ref = sent->reliable[i];
+
+        // unless it was already resent since
+        PendingMessage* pending = _channels[ref.channel].send_window.find(ref.id);
+        if (pending && pending->packet_sequence == sequence)
+            pending->resend_time = now;
+    }
+}
+
+bool ReliablePeer::deliver_messages(std::span<const std::byte> messages)
+{
+    std::size_t offset = 0;
+    while (offset < messages.size())
+    {
+        if (messages.size() - offset < MESSAGE_HEADER_LENGTH)
+            return false;
+
+        const std::byte* header = messages.data() + offset;
+        const auto channel = std::to_integer<std::size_t>(header[0]);
+        const std::uint16_t id = decode_u16(header + 1);
+        const std::size_t length = decode_u16(header + 3);
+        offset += MESSAGE_HEADER_LENGTH;
+
+        if (channel >= _channels.size() || length > _config.max_message_length || length > messages.size() - offset)
+            return false;
+
+        const auto message = messages.subspan(offset, length);
+        offset += length;
+
+        Channel& ch = _channels[channel];
+        switch (ch.delivery)
+        {
+        case ChannelDelivery::UNRELIABLE:
+            if (_message_handler)
+                _message_handler(channel, message);
+            break;
+
+        case ChannelDelivery::UNRELIABLE_SEQUENCED:
+            if (ch.received_any && !is_sequence_newer(id, ch.last_receive_id))
+                break;
+            ch.received_any = true;
+            ch.last_receive_id = id;
+            if (_message_handler)
+                _message_handler(channel, message);
+            break;
+
+        case ChannelDelivery::RELIABLE_ORDERED:
+            deliver_reliable(ch, channel, id, message);
+            break;
+        }
+    }
+    return true;
+}
+
+void ReliablePeer::deliver_reliable(Channel& ch, std::size_t channel, std::uint16_t id,
+                                    std::span<const std::byte> message)
+{
+    // already delivered ones wrap around to far ahead; ones beyond the window are resent later anyway
+    const auto ahead = static_cast<std::uint16_t>(id - ch.next_receive_id);
+    if (ahead >= ch.receive_window.get_capacity())
+        return;
+
+    if (ahead > 0)
+    {
+        if (!ch.receive_window.contains(id))
+        {
+            PendingMessage& pending = ch.receive_window.insert(id);
+            std::copy(message.begin(), message.end(), pending.data.begin());
+            pending.length = message.size();
+        }
+        return;
+    }
+
+    if (_message_handler)
+        _message_handler(channel, message);
+    ++ch.next_receive_id;
+
+    // then the ones it held up
+    while (PendingMessage* pending = ch.receive_window.find(ch.next_receive_id))
+    {
+        if (_message_handler)
+            _message_handler(channel, std::span<const std::byte>(pending->data.data(), pending->length));
+        ch.receive_window.remove(ch.next_receive_id++);
+    }
+}
+
+void ReliablePeer::update_rtt(Clock::duration sample)
+{
+    // RFC 6298
+    if (!_has_rtt)
+    {
+        _srtt = sample;
+        _rttvar = sample / 2;
+        _has_rtt = true;
+    }
+    else
+    {
+        const Clock::duration difference = (_srtt > sample) ? _srtt - sample : sample - _srtt;
+        _rttvar = (3 * _rttvar + difference) / 4;
+        _srtt = (7 * _srtt + sample) / 8;
+    }
+
+    _rto = std::clamp<Clock::duration>(_srtt + 4 * _rttvar, _config.min_rto, _config.max_rto);
+}
+
+auto ReliablePeer::get_backoff_rto(std::uint32_t send_count) const -> Clock::duration
+{
+    // doubles with each resend, like TCP
+    Clock::duration rto = _rto;
+    for (std::uint32_t i = 1; i < send_count && rto < _config.max_rto; ++i)
+        rto *= 2;
+    return std::min<Clock::duration>(rto, _config.max_rto);
+}
+
+} // namespace ds
@@ -0,0 +1,409 @@
+#include "DirtySocks/RpcConnection.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/ErrorConditions.hpp"
+#include "DirtySocks/StreamSocket.hpp"
+
+#include <algorithm>
+#include <memory>
+
+namespace ds
+{
+
+namespace
+{
+
+// stale deadlines of completed calls tolerated in the heap, before it's rebuilt without them
+constexpr std::size_t STALE_DEADLINES_SLACK = 64;
+
+void encode_u16(std::byte* data, std::uint16_t value)
+{
+    data[0] = std::byte(value & 0xFF);
+    data[1] = std::byte(value >> 8);
+}
+
+void encode_u32(std::byte* data, std::uint32_t value)
+{
+    encode_u16(data, static_cast<std::uint16_t>(value & 0xFFFF));
+    encode_u16(data + 2, static_cast<std::uint16_t>(value >> 16));
+}
+
+auto decode_u16(const std::byte* data) -> std::uint16_t
+{
+    return static_cast<std::uint16_t>(std::to_integer<std::uint16_t>(data[0]) |
+                                      std::to_integer<std::uint16_t>(data[1]) << 8);
+}
+
+auto decode_u32(const std::byte* data) -> std::uint32_t
+{
+    return static_cast<std::uint32_t>(decode_u16(data)) | static_cast<std::uint32_t>(decode_u16(data + 2)) << 16;
+}
+
+auto get_timeout_ms(RpcConnection::Clock::time_point deadline, RpcConnection::Clock::time_point now) -> std::uint32_t
+{
+    if (RpcConnection::NO_DEADLINE == deadline)
+        return 0;
+
+    // rounded up, and at least 1 as 0 means none
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+    return static_cast<std::uint32_t>(std::clamp<std::chrono::milliseconds::rep>(remaining.count(), 1, UINT32_MAX));
+}
+
+auto to_result(const RpcResponse& response) -> RpcResult
+{
+    return RpcResult{response.ec, response.status,
+                     std::vector<std::byte>(response.payload.begin(), response.payload.end())};
+}
+
+} // namespace
+
+RpcConnection::RpcConnection(RpcConfig config)
+    : _config(config), _framer(config.checksum, config.max_frame_length)
+{
+}
+
+RpcConnection::~RpcConnection()
+{
+    fail_all(SystemErrc::operation_canceled);
+}
+
+void RpcConnection::set_request_handler(RequestHandler handler)
+{
+    _request_handler = std::move(handler);
+}
+
+auto RpcConnection::call(std::uint16_t method, std::span<const std::byte> payload, Clock::time_point deadline,
+                         Clock::time_point now, ResponseHandler handler, std::error_code& ec) -> std::uint32_t
+{
+    ec.clear();
+
+    if (_calls.size() >= _config.max_outstanding_calls)
+    {
+        ec = SystemErrc::no_buffer_space;
+        return 0;
+    }
+
+    // skip ids still outstanding since the last wrap around, and `0`
+    while (0 == _next_stream_id || _calls.contains(_next_stream_id))
+        ++_next_stream_id;
+    const std::uint32_t stream_id = _next_stream_id++;
+
+    append_message(stream_id, Kind::REQUEST, method, get_timeout_ms(deadline, now), payload, ec);
+    if (ec)
+        return 0;
+
+    _calls.emplace(stream_id, Call{std::move(handler), deadline});
+    ++_stats.calls;
+
+    if (NO_DEADLINE != deadline)
+    {
+        if (_deadlines.size() > 2 * _calls.size() + STALE_DEADLINES_SLACK)
+        {
+            std::erase_if(_deadlines, [this](const Deadline& entry) {
+                const auto it = _calls.find(entry.stream_id);
+                return it == _calls.end() || it->second.deadline != entry.time;
+            });
+            std::make_heap(_deadlines.begin(), _deadlines.end());
+        }
+
+        _deadlines.push_back(Deadline{deadline, stream_id});
+        std::push_heap(_deadlines.begin(), _deadlines.end());
+    }
+
+    return stream_id;
+}
+
+auto RpcConnection::call(std::uint16_t method, std::span<const std::byte> payload, Clock::time_point deadline,
+                         Clock::time_point now, std::error_code& ec) -> std::future<RpcResult>
+{
+    // `std::function` must be copyable
+    auto promise = std::make_shared<std::promise<RpcResult>>();
+    std::future<RpcResult> future = promise->get_future();
+
+    call(method, payload, deadline, now,
+         [promise](const RpcResponse& response) { promise->set_value(to_result(response)); }, ec);
+    if (ec)
+        promise->set_value(RpcResult{ec, 0, {}});
+
+    return future;
+}
+
+auto RpcConnection::async_call(std::uint16_t method, std::span<const std::byte> payload, Clock::time_point deadline,
+                               Clock::time_point now) -> CallAwaiter
+{
+    return CallAwaiter(*this, method, payload, deadline, now);
+}
+
+void RpcConnection::respond(std::uint32_t stream_id, std::span<const std::byte> payload, std::error_code& ec)
+{
+    append_message(stream_id, Kind::RESPONSE, 0, 0, payload, ec);
+    if (!ec)
+        ++_stats.responses_sent;
+}
+
+void RpcConnection::respond_error(std::uint32_t stream_id, std::uint16_t status, std::error_code& ec)
+{
+    if (0 == status)
+    {
+        ec = SystemErrc::invalid_argument;
+        return;
+    }
+
+    append_message(stream_id, Kind::RESPONSE, status, 0, {}, ec);
+    if (!ec)
+        ++_stats.responses_sent;
+}
+
+void RpcConnection::receive_from(StreamSocket& socket, std::size_t& received_length, Clock::time_point now,
+                                 std::error_code& ec)
+{
+    _framer.receive_from(socket, received_length, ec);
+    if (ec || 0 == received_length)
+        return;
+
+    handle_frames(now, ec);
+}
+
+void RpcConnection::feed(const void* data, std::size_t length, Clock::time_point now, std::error_code& ec)
+{
+    _framer.feed(data, length);
+    handle_frames(now, ec);
+}
+
+void RpcConnection::flush(StreamSocket& socket, std::size_t& sent_length, std::error_code& ec)
+{
+    ec.clear();
+    sent_length = 0;
+
+    while (_send_offset < _send_buffer.size())
+    {
+        std::size_t sent;
+        socket.send(_send_buffer.data() + _send_offset, _send_buffer.size() - _send_offset, sent, ec);
+        if (ec)
+        {
+            if (ec == SocketErrc::WOULD_BLOCK)
+                ec.clear();
+            break;
+        }
+
+        _send_offset += sent;
+        sent_length += sent;
+    }
+
+    // keeps the capacity, so steady traffic doesn't allocate
+    if (_send_offset == _send_buffer.size())
+    {
+        _send_buffer.clear();
+        _send_offset = 0;
+    }
+    else if (_send_offset >= _send_buffer.size() / 2)
+    {
+        _send_buffer.erase(_send_buffer.begin(), _send_buffer.begin() + static_cast<std::ptrdiff_t>(_send_offset));
+        _send_offset = 0;
+    }
+}
+
+void RpcConnection::expire(Clock::time_point now)
+{
+    while (!_deadlines.empty() && _deadlines.front().time <= now)
+    {
+        const Deadline entry = _deadlines.front();
+        std::pop_heap(_deadlines.begin(), _deadlines.end());
+        _deadlines.pop_back();
+
+        const auto it = _calls.find(entry.stream_id);
+        if (it == _calls.end() || it->second.deadline != entry.time)
+            continue;
+
+        ++_stats.calls_timed_out;
+
+        RpcResponse response;
+        response.ec = StreamErrc::DEADLINE_EXCEEDED;
+        complete(entry.stream_id, response);
+    }
+}
+
+void RpcConnection::fail_all(const std::error_code& ec)
+{
+    // handlers may call again, which goes to the emptied table
+    auto calls = std::move(_calls);
+    _calls.clear();
+    _deadlines.clear();
+
+    RpcResponse response;
+    response.ec = ec;
+    for (auto& [stream_id, call] : calls)
+        call.handler(response);
+}
+
+auto RpcConnection::get_next_deadline() -> std::optional<Clock::time_point>
+{
+    pop_stale_deadlines();
+    if (_deadlines.empty())
+        return std::nullopt;
+
+    return _deadlines.front().time;
+}
+
+auto RpcConnection::get_outstanding_count() const -> std::size_t
+{
+    return _calls.size();
+}
+
+auto RpcConnection::get_send_buffered_length() const -> std::size_t
+{
+    return _send_buffer.size() - _send_offset;
+}
+
+auto RpcConnection::get_stats() const -> const RpcStats&
+{
+    return _stats;
+}
+
+void RpcConnection::append_message(std::uint32_t stream_id, Kind kind, std::uint16_t method_or_status,
+                                   std::uint32_t timeout_ms, std::span<const std::byte> payload, std::error_code& ec)
+{
+    ec.clear();
+
+    const std::size_t frame_length = HEADER_LENGTH + payload.size();
+    if (frame_length > _config.max_frame_length)
+    {
+        ec = StreamErrc::FRAME_TOO_LONG;
+        return;
+    }
+
+    const auto frame_header = LengthPrefixedFramer::encode_header(frame_length);
+    _send_buffer.insert(_send_buffer.end(), frame_header.begin(), frame_header.end());
+
+    const std::size_t frame_offset = _send_buffer.size();
+    _send_buffer.resize(frame_offset + HEADER_LENGTH);
+
+    std::byte* header = _send_buffer.data() + frame_offset;
+    encode_u32(header, stream_id);
+    header[4] = std::byte(kind);
+    header[5] = std::byte{0};
+    encode_u16(header + 6, method_or_status);
+    encode_u32(header + 8, timeout_ms);
+
+    _send_buffer.insert(_send_buffer.end(), payload.begin(), payload.end());
+
+    if (FrameChecksum::CRC32C == _config.checksum)
+    {
+        const auto trailer =
+            LengthPrefixedFramer::encode_trailer(std::span(_send_buffer.data() + frame_offset, frame_length));
+        _send_buffer.insert(_send_buffer.end(), trailer.begin(), trailer.end());
+    }
+}
+
+void RpcConnection::handle_frames(Clock::time_point now, std::error_code& ec)
+{
+    ec.clear();
+
+    while (true)
+    {
+        const auto frame = _framer.next_frame(ec);
+        if (!frame)
+            return;
+
+        if (!handle_frame(*frame, now))
+        {
+            ec = StreamErrc::MALFORMED_FRAME;
+            return;
+        }
+    }
+}
+
+bool RpcConnection::handle_frame(std::span<const std::byte> frame, Clock::time_point now)
+{
+    if (frame.size() < HEADER_LENGTH)
+        return false;
+
+    const std::uint32_t stream_id = decode_u32(frame.data());
+    const auto kind = static_cast<Kind>(frame[4]);
+    const std::uint16_t method_or_status = decode_u16(frame.data() + 6);
+    const std::uint32_t timeout_ms = decode_u32(frame.data() + 8);
+    const std::span<const std::byte> payload = frame.subspan(HEADER_LENGTH);
+
+    switch (kind)
+    {
+    case Kind::REQUEST: {
+        ++_stats.requests_received;
+
+        RpcRequest request{stream_id, method_or_status, payload, std::nullopt};
+        if (0 != timeout_ms)
+            request.deadline = now + std::chrono::milliseconds(timeout_ms);
+
+        if (_request_handler)
+            _request_handler(*this, request);
+        else
+        {
+            std::error_code ec; // only if the peer's frames can't hold a header, which they do
+            respond_error(stream_id, UNHANDLED_STATUS, ec);
+        }
+        return true;
+    }
+
+    case Kind::RESPONSE: {
+        if (!_calls.contains(stream_id))
+        {
+            ++_stats.late_responses;
+            return true;
+        }
+        ++_stats.responses_received;
+
+        RpcResponse response;
+        response.status = method_or_status;
+        response.payload = payload;
+        complete(stream_id, response);
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
+void RpcConnection::complete(std::uint32_t stream_id, const RpcResponse& response)
+{
+    // take the handler out first, as it may call again and rehash the table
+    const auto it = _calls.find(stream_id);
+    const ResponseHandler handler = std::move(it->second.handler);
+    _calls.erase(it);
+
+    handler(response);
+}
+
+void RpcConnection::pop_stale_deadlines()
+{
+    while (!_deadlines.empty())
+    {
+        const Deadline& entry = _deadlines.front();
+        const auto it = _calls.find(entry.stream_id);
+        if (it != _calls.end() && it->second.deadline == entry.time)
+            return;
+
+        std::pop_heap(_deadlines.begin(), _deadlines.end());
+        _deadlines.pop_back();
+    }
+}
+
+bool RpcConnection::CallAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    std::error_code ec;
+    _connection.call(
+        _method, _payload, _deadline, _now,
+        [this, handle](const RpcResponse& response) {
+            _result = to_result(response);
+            handle.resume();
+        },
+        ec);
+
+    if (ec)
+    {
+        _result.ec = ec;
+        return false;
+    }
+    return true;
+}
+
+} // namespace ds
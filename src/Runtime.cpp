@@ -0,0 +1,154 @@
+#include "DirtySocks/Runtime.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+
+#include <future>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace ds
+{
+
+Runtime::~Runtime()
+{
+    std::error_code ec;
+    stop(ec);
+}
+
+void Runtime::start(const RuntimeConfig& config, InitHandler init, std::error_code& ec)
+{
+    ec.clear();
+
+    if (!_loops.empty())
+    {
+        ec = SystemErrc::operation_in_progress;
+        return;
+    }
+
+    const std::vector<unsigned> cpus = config.cpus.empty() ? get_available_cpus() : config.cpus;
+    if (cpus.empty())
+    {
+        ec = SystemErrc::invalid_argument;
+        return;
+    }
+
+    for (std::size_t i = 0; i < cpus.size(); ++i)
+        _loops.push_back(std::unique_ptr<EventLoop>(new EventLoop(*this, i, cpus[i])));
+    _exit_errors.resize(cpus.size());
+
+    // each loop reports its setup, then waits for all the others before `init`, so it can post to any of them
+    std::vector<std::promise<std::error_code>> setups(cpus.size());
+    std::promise<bool> go;
+    const std::shared_future<bool> go_future = go.get_future().share();
+
+    for (std::size_t i = 0; i < cpus.size(); ++i)
+    {
+        _threads.emplace_back([this, i, config, init, &setup = setups[i], go_future] {
+            EventLoop& loop = *_loops[i];
+
+            std::error_code loop_ec;
+            loop.init(config, loop_ec);
+            setup.set_value(loop_ec); // `setup` is gone after this
+            if (loop_ec || !go_future.get())
+                return;
+
+            if (init)
+                init(loop);
+            loop.run(_exit_errors[i]);
+        });
+    }
+
+    for (auto& setup : setups)
+    {
+        const std::error_code setup_ec = setup.get_future().get();
+        if (setup_ec && !ec)
+            ec = setup_ec;
+    }
+
+    go.set_value(!ec);
+    if (ec)
+    {
+        for (auto& thread : _threads)
+            thread.join();
+        _threads.clear();
+        _loops.clear();
+        _exit_errors.clear();
+    }
+}
+
+void Runtime::stop(std::error_code& ec)
+{
+    ec.clear();
+
+    for (std::size_t i = 0; i < _loops.size(); ++i)
+    {
+        // a broken mailbox already ended its loop
+        std::error_code post_ec;
+        post(i, [&loop = *_loops[i]] { loop.stop(); }, post_ec);
+    }
+
+    for (auto& thread : _threads)
+        thread.join();
+
+    for (const auto& exit_error : _exit_errors)
+    {
+        if (exit_error)
+        {
+            ec = exit_error;
+            break;
+        }
+    }
+
+    _threads.clear();
+    _loops.clear();
+    _exit_errors.clear();
+}
+
+void Runtime::post(std::size_t loop_index, EventLoop::Task task, std::error_code& ec)
+{
+    if (loop_index >= _loops.size())
+    {
+        ec = SystemErrc::invalid_argument;
+        return;
+    }
+
+    _loops[loop_index]->get_mailbox().post(std::move(task), ec);
+}
+
+auto Runtime::get_loops_count() const -> std::size_t
+{
+    return _loops.size();
+}
+
+auto Runtime::get_loop(std::size_t loop_index) -> EventLoop&
+{
+    return *_loops[loop_index];
+}
+
+auto Runtime::get_available_cpus() -> std::vector<unsigned>
+{
+    std::vector<unsigned> cpus;
+
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (0 == sched_getaffinity(0, sizeof(cpu_set), &cpu_set))
+    {
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &cpu_set))
+                cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+#endif
+
+    const unsigned count = std::thread::hardware_concurrency();
+    for (unsigned cpu = 0; cpu < count; ++cpu)
+        cpus.push_back(cpu);
+    return cpus;
+}
+
+} // namespace ds
@@ -0,0 +1,104 @@
+#include "DirtySocks/SharedBuffer.hpp"
+
+#include <cstring>
+#include <new>
+
+namespace ds
+{
+
+SharedBuffer::~SharedBuffer()
+{
+    release();
+}
+
+SharedBuffer::SharedBuffer(const SharedBuffer& other) noexcept : _header(other._header)
+{
+    if (_header)
+        _header->use_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+SharedBuffer& SharedBuffer::operator=(const SharedBuffer& other) noexcept
+{
+    if (this != &other)
+    {
+        if (other._header)
+            other._header->use_count.fetch_add(1, std::memory_order_relaxed);
+        release();
+        _header = other._header;
+    }
+    return *this;
+}
+
+SharedBuffer::SharedBuffer(SharedBuffer&& other) noexcept : _header(other._header)
+{
+    other._header = nullptr;
+}
+
+SharedBuffer& SharedBuffer::operator=(SharedBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        _header = other._header;
+        other._header = nullptr;
+    }
+    return *this;
+}
+
+auto SharedBuffer::copy_from(const void* data, std::size_t length) -> SharedBuffer
+{
+    return create(length, [&](std::span<std::byte> bytes) { std::memcpy(bytes.data(), data, length); });
+}
+
+auto SharedBuffer::data() const -> const std::byte*
+{
+    return (_header) ? get_bytes(_header) : nullptr;
+}
+
+auto SharedBuffer::size() const -> std::size_t
+{
+    return (_header) ? _header->length : 0;
+}
+
+bool SharedBuffer::empty() const
+{
+    return 0 == size();
+}
+
+auto SharedBuffer::as_span() const -> std::span<const std::byte>
+{
+    return std::span<const std::byte>(data(), size());
+}
+
+auto SharedBuffer::get_use_count() const -> std::uint32_t
+{
+    return (_header) ? _header->use_count.load(std::memory_order_relaxed) : 0;
+}
+
+auto SharedBuffer::allocate(std::size_t length) -> Header*
+{
+    // bytes follow the header in the same allocation
+    void* memory = ::operator new(sizeof(Header) + length);
+    return new (memory) Header{{1}, length};
+}
+
+auto SharedBuffer::get_bytes(Header* header) -> std::byte*
+{
+    return reinterpret_cast<std::byte*>(header + 1);
+}
+
+void SharedBuffer::release()
+{
+    if (!_header)
+        return;
+
+    // the last owner must see all the other owners' accesses before freeing
+    if (1 == _header->use_count.fetch_sub(1, std::memory_order_acq_rel))
+    {
+        _header->~Header();
+        ::operator delete(_header);
+    }
+    _header = nullptr;
+}
+
+} // namespace ds
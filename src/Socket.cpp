@@ -2,8 +2,11 @@
 
 #include "DirtySocks/SocketAddress.hpp"
 
+#include "DirtySocks/ErrorCodes.hpp"
 #include "DirtySocks/System.hpp"
 
+#include <algorithm>
+
 namespace ds
 {
 
@@ -44,10 +47,25 @@ void Socket::close()
     }
 }
 
+auto Socket::release() -> SOCKET
+{
+    const SOCKET handle = _handle;
+    _handle = INVALID_SOCKET;
+    _non_blocking = false;
+    return handle;
+}
+
 void Socket::set_non_blocking(bool non_blocking, std::error_code& ec)
 {
     ec.clear();
 
+    // not created yet, apply it on creation
+    if (INVALID_SOCKET == _handle)
+    {
+        _non_blocking = non_blocking;
+        return;
+    }
+
     int nonblock_flag_set_result;
 #ifdef _WIN32
     u_long enabled = non_blocking;
@@ -68,9 +86,51 @@ void Socket::set_non_blocking(bool non_blocking, std::error_code& ec)
         _non_blocking = non_blocking;
 }
 
-bool Socket::is_non_blocking() const
+void Socket::set_busy_poll(std::chrono::microseconds budget, bool prefer, std::error_code& ec)
+{
+    ec.clear();
+
+#ifdef __linux__
+    const int budget_us = static_cast<int>(budget.count());
+    if (SOCKET_ERROR == setsockopt(_handle, SOL_SOCKET, SO_BUSY_POLL, &budget_us, sizeof(budget_us)))
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+
+#ifdef SO_PREFER_BUSY_POLL
+    const int prefer_flag = prefer;
+    if (SOCKET_ERROR == setsockopt(_handle, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer_flag, sizeof(prefer_flag)))
+        ec = System::get_last_error_code();
+#else
+    if (prefer)
+        ec = SystemErrc::no_protocol_option;
+#endif
+#else
+    (void)budget;
+    (void)prefer;
+    ec = SystemErrc::operation_not_supported;
+#endif
+}
+
+void Socket::set_max_pacing_rate(std::uint64_t bytes_per_second, std::error_code& ec)
 {
-    return _non_blocking;
+    ec.clear();
+
+#ifdef __linux__
+    // 64-bit since Linux 4.13, 32-bit (saturated at ~4 GB/s) before that
+    int result = setsockopt(_handle, SOL_SOCKET, SO_MAX_PACING_RATE, &bytes_per_second, sizeof(bytes_per_second));
+    if (SOCKET_ERROR == result && EINVAL == errno)
+    {
+        const auto rate32 = static_cast<std::uint32_t>(std::min<std::uint64_t>(bytes_per_second, UINT32_MAX));
+        result = setsockopt(_handle, SOL_SOCKET, SO_MAX_PACING_RATE, &rate32, sizeof(rate32));
+    }
+    if (SOCKET_ERROR == result)
+        ec = System::get_last_error_code();
+#else
+    (void)bytes_per_second;
+    ec = SystemErrc::operation_not_supported;
+#endif
 }
 
 auto Socket::get_local_address(std::error_code& ec) const -> std::optional<SocketAddress>
@@ -87,26 +147,39 @@ auto Socket::get_local_address(std::error_code& ec) const -> std::optional<Socke
     return SocketAddress(reinterpret_cast<sockaddr&>(addr));
 }
 
-auto Socket::get_handle() const -> SOCKET
+Socket::Socket(SOCKET handle, bool non_blocking) : _handle(handle), _non_blocking(non_blocking)
 {
-    return _handle;
 }
 
-Socket::Socket(SOCKET handle, bool non_blocking) : _handle(handle), _non_blocking(non_blocking)
+void Socket::init_handle(IpVersion ip_ver, Protocol protocol, std::error_code& ec)
 {
+    return init_handle(IpVersion::V6 == ip_ver ? AF_INET6 : AF_INET, protocol, ec);
 }
 
-void Socket::init_handle(IpVersion ip_ver, Protocol protocol, std::error_code& ec)
+void Socket::init_handle(int family, Protocol protocol, std::error_code& ec)
 {
+    ec.clear();
     close();
 
-    const auto family = (IpVersion::V6 == ip_ver ? AF_INET6 : AF_INET);
+    // `Protocol::TCP` means a stream socket for non-IP families (e.g. `AF_UNIX`)
     const auto type = (Protocol::UDP == protocol ? SOCK_DGRAM : SOCK_STREAM);
 
+#ifdef __linux__
+    // set the blocking mode with the socket type flags, no extra `fcntl()` round trips
+    _handle = ::socket(family, type | SOCK_CLOEXEC | (is_non_blocking() ? SOCK_NONBLOCK : 0), 0);
+    if (INVALID_SOCKET == _handle)
+        ec = System::get_last_error_code();
+#else
     _handle = ::socket(family, type, 0);
+    if (INVALID_SOCKET == _handle)
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
 
-    if (!is_non_blocking())
-        set_non_blocking(false, ec);
+    if (is_non_blocking())
+        set_non_blocking(true, ec);
+#endif
 }
 
 } // namespace ds
@@ -0,0 +1,246 @@
+#include "DirtySocks/SocketOptions.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/Socket.hpp"
+#include "DirtySocks/System.hpp"
+
+#ifndef _WIN32 // POSIX
+#include <netinet/tcp.h>
+#endif
+
+namespace ds
+{
+
+namespace
+{
+
+void set_option(SOCKET handle, int level, int name, int value, std::error_code& ec)
+{
+    if (SOCKET_ERROR == setsockopt(handle, level, name, reinterpret_cast<const char*>(&value), sizeof(value)))
+        ec = System::get_last_error_code();
+}
+
+void set_keep_alive(SOCKET handle, const TcpKeepAlive& keep_alive, std::error_code& ec)
+{
+    set_option(handle, SOL_SOCKET, SO_KEEPALIVE, 1, ec);
+    if (ec)
+        return;
+
+#if defined(TCP_KEEPIDLE)
+    set_option(handle, IPPROTO_TCP, TCP_KEEPIDLE, static_cast<int>(keep_alive.idle.count()), ec);
+#elif defined(TCP_KEEPALIVE)
+    // macOS
+    set_option(handle, IPPROTO_TCP, TCP_KEEPALIVE, static_cast<int>(keep_alive.idle.count()), ec);
+#else
+    ec = SystemErrc::no_protocol_option;
+#endif
+    if (ec)
+        return;
+
+#if defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+    set_option(handle, IPPROTO_TCP, TCP_KEEPINTVL, static_cast<int>(keep_alive.interval.count()), ec);
+    if (!ec)
+        set_option(handle, IPPROTO_TCP, TCP_KEEPCNT, keep_alive.count, ec);
+#else
+    ec = SystemErrc::no_protocol_option;
+#endif
+}
+
+void set_fast_open(SOCKET handle, const TcpFastOpen& fast_open, std::error_code& ec)
+{
+#if defined(_WIN32) || (defined(__APPLE__) && defined(TCP_FASTOPEN))
+    (void)fast_open;
+    set_option(handle, IPPROTO_TCP, TCP_FASTOPEN, 1, ec);
+#elif defined(TCP_FASTOPEN)
+    set_option(handle, IPPROTO_TCP, TCP_FASTOPEN, fast_open.queue_length, ec);
+#else
+    (void)handle;
+    (void)fast_open;
+    ec = SystemErrc::no_protocol_option;
+#endif
+}
+
+} // namespace
+
+auto SocketOptions::no_delay(bool enabled) -> SocketOptions&
+{
+    _no_delay = enabled;
+    return *this;
+}
+
+auto SocketOptions::send_buffer_size(int bytes) -> SocketOptions&
+{
+    _send_buffer_size = bytes;
+    return *this;
+}
+
+auto SocketOptions::receive_buffer_size(int bytes) -> SocketOptions&
+{
+    _receive_buffer_size = bytes;
+    return *this;
+}
+
+auto SocketOptions::keep_alive(TcpKeepAlive keep_alive) -> SocketOptions&
+{
+    _keep_alive = keep_alive;
+    return *this;
+}
+
+auto SocketOptions::quick_ack(bool enabled) -> SocketOptions&
+{
+    _quick_ack = enabled;
+    return *this;
+}
+
+auto SocketOptions::user_timeout(std::chrono::milliseconds timeout) -> SocketOptions&
+{
+    _user_timeout = timeout;
+    return *this;
+}
+
+auto SocketOptions::type_of_service(std::uint8_t tos) -> SocketOptions&
+{
+    _type_of_service = tos;
+    return *this;
+}
+
+auto SocketOptions::priority(int priority) -> SocketOptions&
+{
+    _priority = priority;
+    return *this;
+}
+
+auto SocketOptions::reuse_address(bool enabled) -> SocketOptions&
+{
+    _reuse_address = enabled;
+    return *this;
+}
+
+auto SocketOptions::reuse_port(bool enabled) -> SocketOptions&
+{
+    _reuse_port = enabled;
+    return *this;
+}
+
+auto SocketOptions::defer_accept(std::chrono::seconds timeout) -> SocketOptions&
+{
+    _defer_accept = timeout;
+    return *this;
+}
+
+auto SocketOptions::fast_open(TcpFastOpen fast_open) -> SocketOptions&
+{
+    _fast_open = fast_open;
+    return *this;
+}
+
+void SocketOptions::apply(Socket& socket, std::error_code& ec) const
+{
+    ec.clear();
+
+    sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    if (SOCKET_ERROR == ::getsockname(socket.get_handle(), reinterpret_cast<sockaddr*>(&addr), &addr_len))
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    apply(socket.get_handle(), addr.ss_family, Target::ANY, ec);
+}
+
+void SocketOptions::apply(SOCKET handle, [[maybe_unused]] int family, Target target, std::error_code& ec) const
+{
+    ec.clear();
+
+    // the kernel copies the listener's options to accepted sockets, but these
+    // (Linux sets the priority from the SYN, and quick acks are a passing mode)
+    if (Target::ACCEPTED == target)
+    {
+#ifdef SO_PRIORITY
+        if (_priority)
+            set_option(handle, SOL_SOCKET, SO_PRIORITY, *_priority, ec);
+#endif
+#ifdef TCP_QUICKACK
+        if (!ec && _quick_ack)
+            set_option(handle, IPPROTO_TCP, TCP_QUICKACK, *_quick_ack, ec);
+#endif
+        return;
+    }
+
+    if (_reuse_address)
+        set_option(handle, SOL_SOCKET, SO_REUSEADDR, *_reuse_address, ec);
+    if (!ec && _reuse_port)
+    {
+#ifdef SO_REUSEPORT
+        set_option(handle, SOL_SOCKET, SO_REUSEPORT, *_reuse_port, ec);
+#else
+        if (*_reuse_port)
+            ec = SystemErrc::no_protocol_option;
+#endif
+    }
+
+    if (!ec && _send_buffer_size)
+        set_option(handle, SOL_SOCKET, SO_SNDBUF, *_send_buffer_size, ec);
+    if (!ec && _receive_buffer_size)
+        set_option(handle, SOL_SOCKET, SO_RCVBUF, *_receive_buffer_size, ec);
+
+    if (!ec && _no_delay)
+        set_option(handle, IPPROTO_TCP, TCP_NODELAY, *_no_delay, ec);
+    if (!ec && _keep_alive)
+        set_keep_alive(handle, *_keep_alive, ec);
+
+    if (!ec && _quick_ack)
+    {
+#ifdef TCP_QUICKACK
+        set_option(handle, IPPROTO_TCP, TCP_QUICKACK, *_quick_ack, ec);
+#else
+        ec = SystemErrc::no_protocol_option;
+#endif
+    }
+
+    if (!ec && _user_timeout)
+    {
+#ifdef TCP_USER_TIMEOUT
+        set_option(handle, IPPROTO_TCP, TCP_USER_TIMEOUT, static_cast<int>(_user_timeout->count()), ec);
+#else
+        ec = SystemErrc::no_protocol_option;
+#endif
+    }
+
+    if (!ec && _type_of_service)
+    {
+#ifdef IPV6_TCLASS
+        if (AF_INET6 == family)
+            set_option(handle, IPPROTO_IPV6, IPV6_TCLASS, *_type_of_service, ec);
+        else
+#endif
+            set_option(handle, IPPROTO_IP, IP_TOS, *_type_of_service, ec);
+    }
+
+    if (!ec && _priority)
+    {
+#ifdef SO_PRIORITY
+        set_option(handle, SOL_SOCKET, SO_PRIORITY, *_priority, ec);
+#else
+        ec = SystemErrc::no_protocol_option;
+#endif
+    }
+
+    if (Target::CONNECTING == target)
+        return;
+
+    if (!ec && _defer_accept)
+    {
+#ifdef TCP_DEFER_ACCEPT
+        set_option(handle, IPPROTO_TCP, TCP_DEFER_ACCEPT, static_cast<int>(_defer_accept->count()), ec);
+#else
+        ec = SystemErrc::no_protocol_option;
+#endif
+    }
+
+    if (!ec && _fast_open)
+        set_fast_open(handle, *_fast_open, ec);
+}
+
+} // namespace ds
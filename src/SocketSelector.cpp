@@ -4,14 +4,22 @@
 #include "DirtySocks/Socket.hpp"
 #include "DirtySocks/System.hpp"
 
-#ifndef _WIN32 // POSIX
+#include "SpinWait.hpp"
+
 #include <algorithm>
-#endif
 
 namespace ds
 {
 
 int SocketSelector::select(timeval* timeout, std::error_code& ec)
+{
+    return spin_then_wait(_spin_duration, timeout, _spin_stats, ec,
+                          [this](timeval* wait_timeout, std::error_code& wait_ec) {
+                              return select_once(wait_timeout, wait_ec);
+                          });
+}
+
+int SocketSelector::select_once(timeval* timeout, std::error_code& ec)
 {
     ec.clear();
 
@@ -112,6 +120,26 @@ auto SocketSelector::except_set_count() -> std::size_t
     return _except_set.sockets_count;
 }
 
+void SocketSelector::set_spin_duration(std::chrono::microseconds spin_duration)
+{
+    _spin_duration = std::max(std::chrono::microseconds(0), spin_duration);
+}
+
+auto SocketSelector::get_spin_duration() const -> std::chrono::microseconds
+{
+    return _spin_duration;
+}
+
+auto SocketSelector::get_spin_stats() const -> const SpinStats&
+{
+    return _spin_stats;
+}
+
+void SocketSelector::reset_spin_stats()
+{
+    _spin_stats = SpinStats{};
+}
+
 SocketSelector::Set::Set()
 {
     FD_ZERO(&all);
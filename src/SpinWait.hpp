@@ -0,0 +1,62 @@
+#pragma once
+
+#include "DirtySocks/PlatformSocket.hpp"
+#include "DirtySocks/SpinStats.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+
+namespace ds
+{
+
+/// @brief Spin-then-block policy shared by the selectors.
+///
+/// `wait_once(timeval*, std::error_code&) -> int` is called with a zero timeout for `spin_duration`,
+/// and then once more with the rest of `timeout`.
+template <typename WaitOnce>
+int spin_then_wait(std::chrono::microseconds spin_duration, timeval* timeout, SpinStats& stats, std::error_code& ec,
+                   WaitOnce&& wait_once)
+{
+    if (0 == spin_duration.count())
+        return wait_once(timeout, ec);
+
+    using Clock = std::chrono::steady_clock;
+
+    const auto start = Clock::now();
+    auto spin_end = start + spin_duration;
+    if (timeout)
+        spin_end = std::min(spin_end, start + std::chrono::seconds(timeout->tv_sec) +
+                                          std::chrono::microseconds(timeout->tv_usec));
+
+    auto now = start;
+    do
+    {
+        timeval zero_timeout{0, 0};
+        const int result = wait_once(&zero_timeout, ec);
+        ++stats.spin_polls;
+        if (ec || 0 != result)
+        {
+            if (!ec)
+                ++stats.spin_wakeups;
+            return result;
+        }
+        now = Clock::now();
+    } while (now < spin_end);
+
+    ++stats.blocking_waits;
+    if (!timeout)
+        return wait_once(nullptr, ec);
+
+    // wait for the rest of the timeout
+    const auto waited = std::chrono::duration_cast<std::chrono::microseconds>(now - start);
+    const auto total = std::chrono::seconds(timeout->tv_sec) + std::chrono::microseconds(timeout->tv_usec);
+    const auto remaining = std::max(std::chrono::microseconds(0), total - waited);
+
+    timeval remaining_timeout;
+    remaining_timeout.tv_sec = static_cast<decltype(remaining_timeout.tv_sec)>(remaining.count() / 1'000'000);
+    remaining_timeout.tv_usec = static_cast<decltype(remaining_timeout.tv_usec)>(remaining.count() % 1'000'000);
+    return wait_once(&remaining_timeout, ec);
+}
+
+} // namespace ds
@@ -0,0 +1,298 @@
+#include "DirtySocks/StreamSocket.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/System.hpp"
+
+#ifdef __linux__
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
+#elif !defined(_WIN32)
+#include <sys/ioctl.h>
+#endif
+
+#include <algorithm>
+
+namespace ds
+{
+
+void StreamSocket::send(const void* data, std::size_t data_length, std::size_t& sent_length, std::error_code& ec)
+{
+    ec.clear();
+
+#ifdef _WIN32
+    const auto ret = ::send(get_handle(), static_cast<const char*>(data), static_cast<int>(data_length), 0);
+#else // POSIX
+    const auto ret = ::send(get_handle(), static_cast<const char*>(data), data_length, 0);
+#endif
+
+    if (SOCKET_ERROR == ret)
+    {
+        sent_length = 0;
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    sent_length = ret;
+}
+
+void StreamSocket::send(const void* data, std::size_t data_length, std::error_code& ec)
+{
+    [[maybe_unused]] std::size_t sent_length;
+    return send(data, data_length, sent_length, ec);
+}
+
+void StreamSocket::send(std::span<IoBuffer> buffers, std::size_t& sent_length, std::error_code& ec)
+{
+    ec.clear();
+
+#ifdef _WIN32
+    DWORD sent;
+    const auto ret =
+        WSASend(get_handle(), buffers.data(), static_cast<DWORD>(buffers.size()), &sent, 0, nullptr, nullptr);
+#else // POSIX
+    msghdr msg{};
+    msg.msg_iov = buffers.data();
+    msg.msg_iovlen = buffers.size();
+    const auto ret = sendmsg(get_handle(), &msg, 0);
+    const auto sent = ret;
+#endif
+
+    if (SOCKET_ERROR == ret)
+    {
+        sent_length = 0;
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    sent_length = static_cast<std::size_t>(sent);
+}
+
+void StreamSocket::send(std::span<IoBuffer> buffers, std::error_code& ec)
+{
+    [[maybe_unused]] std::size_t sent_length;
+    return send(buffers, sent_length, ec);
+}
+
+#ifdef _WIN32
+void StreamSocket::send(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped,
+                     LPWSAOVERLAPPED_COMPLETION_ROUTINE completion_routine, std::error_code& ec)
+{
+    ec.clear();
+
+    const auto ret = WSASend(get_handle(), buffers.data(), static_cast<DWORD>(buffers.size()), nullptr, 0, &overlapped,
+                             completion_routine);
+
+    if (SOCKET_ERROR == ret)
+        ec = System::get_last_error_code();
+}
+
+void StreamSocket::send(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped, std::error_code& ec)
+{
+    return send(buffers, overlapped, nullptr, ec);
+}
+#endif
+
+void StreamSocket::receive(void* data, std::size_t data_length, std::size_t& received_length, std::error_code& ec)
+{
+    ec.clear();
+
+#ifdef _WIN32
+    const auto ret = ::recv(get_handle(), static_cast<char*>(data), static_cast<int>(data_length), 0);
+#else // POSIX
+    const auto ret = ::recv(get_handle(), static_cast<char*>(data), data_length, 0);
+#endif
+
+    if (SOCKET_ERROR == ret)
+    {
+        received_length = 0;
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    received_length = ret;
+}
+
+void StreamSocket::receive(std::span<IoBuffer> buffers, std::size_t& received_length, std::error_code& ec)
+{
+    return receive_with_flags(buffers, 0, received_length, ec);
+}
+
+#ifdef _WIN32
+void StreamSocket::receive(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped,
+                        LPWSAOVERLAPPED_COMPLETION_ROUTINE completion_routine, std::error_code& ec)
+{
+    ec.clear();
+
+    DWORD flags = 0;
+    const auto ret = WSARecv(get_handle(), buffers.data(), static_cast<DWORD>(buffers.size()), nullptr, &flags,
+                             &overlapped, completion_routine);
+
+    if (SOCKET_ERROR == ret)
+        ec = System::get_last_error_code();
+}
+
+void StreamSocket::receive(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped, std::error_code& ec)
+{
+    return receive(buffers, overlapped, nullptr, ec);
+}
+#endif
+
+void StreamSocket::send_all(const void* data, std::size_t data_length, std::size_t& sent_length,
+                            std::error_code& ec)
+{
+    IoBuffer buffer;
+    buffer.iov_base = static_cast<char*>(const_cast<void*>(data));
+    buffer.iov_len = static_cast<decltype(buffer.iov_len)>(data_length);
+
+    std::span<IoBuffer> buffers(&buffer, 1);
+    return send_all(buffers, sent_length, ec);
+}
+
+void StreamSocket::send_all(std::span<IoBuffer>& buffers, std::size_t& sent_length, std::error_code& ec)
+{
+    ec.clear();
+    sent_length = 0;
+
+    // drop leading empty buffers
+    advance_io_buffers(buffers, 0);
+
+    while (!buffers.empty())
+    {
+        std::size_t chunk_sent_length;
+        send(buffers.first(std::min(buffers.size(), MAX_IO_BUFFERS)), chunk_sent_length, ec);
+        if (ec)
+        {
+            if (SystemErrc::interrupted == ec)
+                continue;
+            return;
+        }
+
+        sent_length += chunk_sent_length;
+        advance_io_buffers(buffers, chunk_sent_length);
+    }
+}
+
+void StreamSocket::receive_exact(void* data, std::size_t data_length, std::size_t& received_length,
+                                 std::error_code& ec)
+{
+    IoBuffer buffer;
+    buffer.iov_base = static_cast<char*>(data);
+    buffer.iov_len = static_cast<decltype(buffer.iov_len)>(data_length);
+
+    std::span<IoBuffer> buffers(&buffer, 1);
+    return receive_exact(buffers, received_length, ec);
+}
+
+void StreamSocket::receive_exact(std::span<IoBuffer>& buffers, std::size_t& received_length, std::error_code& ec)
+{
+    ec.clear();
+    received_length = 0;
+
+    // let the kernel wait for the whole chunk, instead of waking us up for every segment
+    const int flags = is_non_blocking() ? 0 : MSG_WAITALL;
+
+    // drop leading empty buffers
+    advance_io_buffers(buffers, 0);
+
+    while (!buffers.empty())
+    {
+        std::size_t chunk_received_length;
+        receive_with_flags(buffers.first(std::min(buffers.size(), MAX_IO_BUFFERS)), flags, chunk_received_length,
+                           ec);
+        if (ec)
+        {
+            if (SystemErrc::interrupted == ec)
+                continue;
+            return;
+        }
+
+        if (0 == chunk_received_length)
+        {
+            ec = StreamErrc::END_OF_STREAM;
+            return;
+        }
+
+        received_length += chunk_received_length;
+        advance_io_buffers(buffers, chunk_received_length);
+    }
+}
+
+void StreamSocket::receive_with_flags(std::span<IoBuffer> buffers, int flags, std::size_t& received_length,
+                                      std::error_code& ec)
+{
+    ec.clear();
+
+#ifdef _WIN32
+    DWORD received;
+    DWORD win_flags = static_cast<DWORD>(flags);
+    const auto ret = WSARecv(get_handle(), buffers.data(), static_cast<DWORD>(buffers.size()), &received, &win_flags,
+                             nullptr, nullptr);
+#else
+    msghdr msg{};
+    msg.msg_iov = buffers.data();
+    msg.msg_iovlen = buffers.size();
+    const auto ret = recvmsg(get_handle(), &msg, flags);
+    const auto received = ret;
+#endif
+
+    if (SOCKET_ERROR == ret)
+    {
+        received_length = 0;
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    received_length = static_cast<std::size_t>(received);
+}
+
+StreamSocket::StreamSocket(SOCKET handle, bool non_blocking) : Socket(handle, non_blocking)
+{
+}
+
+auto StreamSocket::get_receive_queue_length(std::error_code& ec) const -> std::size_t
+{
+    ec.clear();
+
+#ifdef _WIN32
+    u_long length = 0;
+    if (SOCKET_ERROR == ::ioctlsocket(get_handle(), FIONREAD, &length))
+#else // POSIX
+    int length = 0;
+    if (SOCKET_ERROR == ::ioctl(get_handle(), FIONREAD, &length))
+#endif
+    {
+        ec = System::get_last_error_code();
+        return 0;
+    }
+
+    return static_cast<std::size_t>(length);
+}
+
+auto StreamSocket::get_send_queue_length(std::error_code& ec) const -> std::size_t
+{
+    ec.clear();
+
+#if defined(__linux__)
+    int length = 0;
+    if (SOCKET_ERROR == ::ioctl(get_handle(), SIOCOUTQ, &length))
+    {
+        ec = System::get_last_error_code();
+        return 0;
+    }
+    return static_cast<std::size_t>(length);
+#elif defined(SO_NWRITE)
+    int length = 0;
+    socklen_t len = sizeof(length);
+    if (SOCKET_ERROR == ::getsockopt(get_handle(), SOL_SOCKET, SO_NWRITE, &length, &len))
+    {
+        ec = System::get_last_error_code();
+        return 0;
+    }
+    return static_cast<std::size_t>(length);
+#else
+    ec = SystemErrc::operation_not_supported;
+    return 0;
+#endif
+}
+
+} // namespace ds
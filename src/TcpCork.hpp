@@ -0,0 +1,13 @@
+#pragma once
+
+#include "DirtySocks/PlatformSocket.hpp"
+
+#include <system_error>
+
+namespace ds
+{
+
+// shared by `TcpSocket` & `CorkBatch`, which uncorks by handle
+void set_tcp_cork(SOCKET, bool cork, std::error_code&);
+
+} // namespace ds
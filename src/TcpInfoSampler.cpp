@@ -0,0 +1,104 @@
+#include "DirtySocks/TcpInfoSampler.hpp"
+
+#include "DirtySocks/TcpSocket.hpp"
+
+#include <algorithm>
+
+namespace ds
+{
+
+TcpInfoSampler::TcpInfoSampler(Clock::duration interval) : _interval(interval)
+{
+}
+
+bool TcpInfoSampler::sample_if_due(Clock::time_point now)
+{
+    if (now < _next_sample_time)
+        return false;
+
+    sample(now);
+    return true;
+}
+
+void TcpInfoSampler::sample(Clock::time_point now)
+{
+    for (Entry& entry : _entries)
+    {
+        std::error_code ec;
+        auto info = entry.socket->get_tcp_info(ec);
+
+        entry.sample.error = ec;
+        entry.sample.sampled_at = now;
+        if (info)
+            entry.sample.info = *info;
+        entry.sampled = true;
+    }
+
+    _next_sample_time = now + _interval;
+}
+
+auto TcpInfoSampler::get(const TcpSocket& sock) const -> const Sample*
+{
+    auto it = find(sock);
+    if (it == _entries.cend() || !it->sampled)
+        return nullptr;
+
+    return &it->sample;
+}
+
+auto TcpInfoSampler::get_next_sample_time() const -> Clock::time_point
+{
+    return _next_sample_time;
+}
+
+auto TcpInfoSampler::get_interval() const -> Clock::duration
+{
+    return _interval;
+}
+
+void TcpInfoSampler::set_interval(Clock::duration interval)
+{
+    _next_sample_time += interval - _interval;
+    _interval = interval;
+}
+
+void TcpInfoSampler::add(const TcpSocket& sock)
+{
+    // do nothing if duplicate passed
+    if (find(sock) != _entries.cend())
+        return;
+
+    _entries.push_back(Entry{&sock, Sample{}, false});
+}
+
+void TcpInfoSampler::remove(const TcpSocket& sock)
+{
+    auto it = find(sock);
+
+    // do nothing if non-existing socket passed
+    if (it == _entries.cend())
+        return;
+
+    // swap-and-pop, order of entries doesn't matter
+    auto& entry = _entries[static_cast<std::size_t>(it - _entries.cbegin())];
+    if (&entry != &_entries.back())
+        entry = _entries.back();
+    _entries.pop_back();
+}
+
+void TcpInfoSampler::clear()
+{
+    _entries.clear();
+}
+
+auto TcpInfoSampler::count() const -> std::size_t
+{
+    return _entries.size();
+}
+
+auto TcpInfoSampler::find(const TcpSocket& sock) const -> std::vector<Entry>::const_iterator
+{
+    return std::find_if(_entries.cbegin(), _entries.cend(), [&sock](const Entry& entry) { return entry.socket == &sock; });
+}
+
+} // namespace ds
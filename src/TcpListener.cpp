@@ -1,20 +1,48 @@
 #include "DirtySocks/TcpListener.hpp"
 
+#include "DirtySocks/ErrorCodes.hpp"
 #include "DirtySocks/ErrorConditions.hpp"
 #include "DirtySocks/SocketAddress.hpp"
 #include "DirtySocks/System.hpp"
 #include "DirtySocks/TcpSocket.hpp"
 
+#ifndef _WIN32 // POSIX
+#include <netinet/tcp.h>
+#endif
+
 namespace ds
 {
 
 void TcpListener::listen(const SocketAddress& addr, int backlog, std::error_code& ec)
+{
+    return listen(addr, backlog, SocketOptions(), ec);
+}
+
+void TcpListener::listen(const SocketAddress& addr, int backlog, TcpFastOpen fast_open, std::error_code& ec)
+{
+    return listen(addr, backlog, SocketOptions().fast_open(fast_open), ec);
+}
+
+void TcpListener::listen(const SocketAddress& addr, std::error_code& ec)
+{
+    return listen(addr, SOMAXCONN, SocketOptions(), ec);
+}
+
+void TcpListener::listen(const SocketAddress& addr, int backlog, const SocketOptions& options, std::error_code& ec)
 {
     ec.clear();
     init_handle(addr.get_ip_version(), Socket::Protocol::TCP, ec);
     if (ec)
         return;
 
+    _options = options;
+    if (_reuse_port)
+        _options.reuse_port();
+
+    _options.apply(get_handle(), addr.get_sockaddr().sa_family, SocketOptions::Target::LISTENING, ec);
+    if (ec)
+        return;
+
     if (SOCKET_ERROR == ::bind(get_handle(), &addr.get_sockaddr(), addr.get_sockaddr_len()))
     {
         ec = System::get_last_error_code();
@@ -28,9 +56,16 @@ void TcpListener::listen(const SocketAddress& addr, int backlog, std::error_code
     }
 }
 
-void TcpListener::listen(const SocketAddress& addr, std::error_code& ec)
+void TcpListener::set_reuse_port(bool reuse_port, std::error_code& ec)
 {
-    return listen(addr, SOMAXCONN, ec);
+    ec.clear();
+
+#ifdef SO_REUSEPORT
+    _reuse_port = reuse_port;
+#else
+    if (reuse_port)
+        ec = SystemErrc::no_protocol_option;
+#endif
 }
 
 void TcpListener::accept(TcpSocket& out_socket, SocketAddress& addr, std::error_code& ec)
@@ -48,7 +83,12 @@ void TcpListener::accept(TcpSocket& out_socket, sockaddr* addr, socklen_t* addr_
 {
     ec.clear();
 
+#ifdef __linux__
+    const int flags = SOCK_CLOEXEC | (is_non_blocking() ? SOCK_NONBLOCK : 0);
+    SOCKET handle = ::accept4(get_handle(), addr, addr_len, flags);
+#else
     SOCKET handle = ::accept(get_handle(), addr, addr_len);
+#endif
 
     if (INVALID_SOCKET == handle)
     {
@@ -58,9 +98,15 @@ void TcpListener::accept(TcpSocket& out_socket, sockaddr* addr, socklen_t* addr_
 
     out_socket = TcpSocket(handle, is_non_blocking());
 
+#ifndef __linux__
     // inherit non-blocking option manually
     // (on some platforms, client socket doesn't inherit non-blocking option from listener socket)
     out_socket.set_non_blocking(is_non_blocking(), ec);
+    if (ec)
+        return;
+#endif
+
+    _options.apply(handle, AF_UNSPEC, SocketOptions::Target::ACCEPTED, ec);
 }
 
 } // namespace ds
@@ -1,18 +1,126 @@
 #include "DirtySocks/TcpSocket.hpp"
 
+#include "DirtySocks/CorkBatch.hpp"
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/ErrorConditions.hpp"
 #include "DirtySocks/SocketAddress.hpp"
 #include "DirtySocks/System.hpp"
 
+#include "TcpCork.hpp"
+
+#ifdef _WIN32
+#include <mstcpip.h>
+#elif defined(__linux__)
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#else // POSIX
+#include <netinet/tcp.h>
+#endif
+
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
 namespace ds
 {
 
+#ifdef __linux__
+namespace
+{
+
+// Mirror of Linux uapi `struct tcp_info`. (glibc's one in `<netinet/tcp.h>` lacks the newer fields)
+//
+// The kernel only appends fields to it, and tells how many bytes it filled in,
+// so fields after the returned length are just unsupported by the running kernel.
+struct KernelTcpInfo
+{
+    std::uint8_t state;
+    std::uint8_t ca_state;
+    std::uint8_t retransmits;
+    std::uint8_t probes;
+    std::uint8_t backoff;
+    std::uint8_t options;
+    std::uint8_t wscale;
+    std::uint8_t delivery_rate_app_limited;
+
+    std::uint32_t rto;
+    std::uint32_t ato;
+    std::uint32_t snd_mss;
+    std::uint32_t rcv_mss;
+
+    std::uint32_t unacked;
+    std::uint32_t sacked;
+    std::uint32_t lost;
+    std::uint32_t retrans;
+    std::uint32_t fackets;
+
+    std::uint32_t last_data_sent;
+    std::uint32_t last_ack_sent;
+    std::uint32_t last_data_recv;
+    std::uint32_t last_ack_recv;
+
+    std::uint32_t pmtu;
+    std::uint32_t rcv_ssthresh;
+    std::uint32_t rtt;
+    std::uint32_t rttvar;
+    std::uint32_t snd_ssthresh;
+    std::uint32_t snd_cwnd;
+    std::uint32_t advmss;
+    std::uint32_t reordering;
+
+    std::uint32_t rcv_rtt;
+    std::uint32_t rcv_space;
+
+    std::uint32_t total_retrans;
+
+    std::uint64_t pacing_rate;
+    std::uint64_t max_pacing_rate;
+    std::uint64_t bytes_acked;
+    std::uint64_t bytes_received;
+    std::uint32_t segs_out;
+    std::uint32_t segs_in;
+
+    std::uint32_t notsent_bytes;
+    std::uint32_t min_rtt;
+    std::uint32_t data_segs_in;
+    std::uint32_t data_segs_out;
+
+    std::uint64_t delivery_rate;
+};
+
+// `snd_ssthresh` until the first loss ends the initial slow start (kernel's `include/net/tcp.h`)
+constexpr std::uint32_t TCP_INFINITE_SSTHRESH = 0x7fffffff;
+
+auto to_kernel_timestamp(const timespec& ts) -> KernelTimestamp
+{
+    return KernelTimestamp(std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec));
+}
+
+#define DS_HAS_TCP_INFO_FIELD(len, field) \
+    ((len) >= offsetof(KernelTcpInfo, field) + sizeof(KernelTcpInfo::field))
+
+} // namespace
+#endif
+
 void TcpSocket::connect(const SocketAddress& addr, std::error_code& ec)
+{
+    return connect(addr, SocketOptions(), ec);
+}
+
+void TcpSocket::connect(const SocketAddress& addr, const SocketOptions& options, std::error_code& ec)
 {
     ec.clear();
     init_handle(addr.get_ip_version(), Socket::Protocol::TCP, ec);
     if (ec)
         return;
 
+    options.apply(get_handle(), addr.get_sockaddr().sa_family, SocketOptions::Target::CONNECTING, ec);
+    if (ec)
+        return;
+
     if (SOCKET_ERROR == ::connect(get_handle(), &addr.get_sockaddr(), addr.get_sockaddr_len()))
     {
         ec = System::get_last_error_code();
@@ -20,166 +128,433 @@ void TcpSocket::connect(const SocketAddress& addr, std::error_code& ec)
     }
 }
 
-void TcpSocket::send(const void* data, std::size_t data_length, std::size_t& sent_length, std::error_code& ec)
+void TcpSocket::connect(const SocketAddress& addr, const void* data, std::size_t data_length,
+                        std::size_t& sent_length, std::error_code& ec)
 {
     ec.clear();
+    sent_length = 0;
 
-#ifdef _WIN32
-    const auto ret = ::send(get_handle(), static_cast<const char*>(data), static_cast<int>(data_length), 0);
-#else // POSIX
-    const auto ret = ::send(get_handle(), static_cast<const char*>(data), data_length, 0);
+    init_handle(addr.get_ip_version(), Socket::Protocol::TCP, ec);
+    if (ec)
+        return;
+
+#ifdef __linux__
+#ifdef TCP_FASTOPEN_CONNECT
+    // Linux 4.11+: `connect()` is deferred to the first `send()` if a cookie is cached,
+    // otherwise it's a regular `connect()`
+    const int enabled = 1;
+    if (SOCKET_ERROR != setsockopt(get_handle(), IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &enabled, sizeof(enabled)))
+    {
+        if (SOCKET_ERROR == ::connect(get_handle(), &addr.get_sockaddr(), addr.get_sockaddr_len()))
+        {
+            ec = System::get_last_error_code();
+            return;
+        }
+
+        return send(data, data_length, sent_length, ec);
+    }
 #endif
 
-    if (SOCKET_ERROR == ret)
+    // older kernels: `sendto()` with `MSG_FASTOPEN` connects & sends at once
+    const auto ret = ::sendto(get_handle(), data, data_length, MSG_FASTOPEN, &addr.get_sockaddr(),
+                              addr.get_sockaddr_len());
+    if (SOCKET_ERROR != ret)
+    {
+        sent_length = static_cast<std::size_t>(ret);
+        return;
+    }
+
+    ec = System::get_last_error_code();
+    if (SystemErrc::operation_not_supported != ec)
+        return;
+
+    // TFO is disabled by the kernel, open a fresh socket for a regular connect
+    init_handle(addr.get_ip_version(), Socket::Protocol::TCP, ec);
+    if (ec)
+        return;
+#endif
+
+    if (SOCKET_ERROR == ::connect(get_handle(), &addr.get_sockaddr(), addr.get_sockaddr_len()))
     {
-        sent_length = 0;
         ec = System::get_last_error_code();
         return;
     }
 
-    sent_length = ret;
+    return send(data, data_length, sent_length, ec);
 }
 
-void TcpSocket::send(const void* data, std::size_t data_length, std::error_code& ec)
+void TcpSocket::set_timestamping(TimestampingFlags flags, std::error_code& ec)
 {
-    [[maybe_unused]] std::size_t sent_length;
-    return send(data, data_length, sent_length, ec);
+    ec.clear();
+
+#ifdef __linux__
+    int value = 0;
+    if (!!(flags & TimestampingFlags::RX_SOFTWARE))
+        value |= SOF_TIMESTAMPING_RX_SOFTWARE;
+    if (!!(flags & TimestampingFlags::TX_SCHED))
+        value |= SOF_TIMESTAMPING_TX_SCHED;
+    if (!!(flags & TimestampingFlags::TX_SOFTWARE))
+        value |= SOF_TIMESTAMPING_TX_SOFTWARE;
+    if (!!(flags & TimestampingFlags::TX_ACK))
+        value |= SOF_TIMESTAMPING_TX_ACK;
+
+    if (0 != value)
+        value |= SOF_TIMESTAMPING_SOFTWARE;
+    // byte offsets as IDs, and don't loop the sent payload back to the error queue
+    if (!!(flags & TimestampingFlags::TX_ALL))
+        value |= SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+
+    if (SOCKET_ERROR == setsockopt(get_handle(), SOL_SOCKET, SO_TIMESTAMPING, &value, sizeof(value)))
+        ec = System::get_last_error_code();
+#else
+    (void)flags;
+    ec = SystemErrc::operation_not_supported;
+#endif
 }
 
-void TcpSocket::send(std::span<IoBuffer> buffers, std::size_t& sent_length, std::error_code& ec)
+void TcpSocket::receive(void* data, std::size_t data_length, std::size_t& received_length,
+                        std::optional<KernelTimestamp>& rx_timestamp, std::error_code& ec)
+{
+    IoBuffer buffer;
+    buffer.iov_base = static_cast<char*>(data);
+    buffer.iov_len = static_cast<decltype(buffer.iov_len)>(data_length);
+
+    return receive(std::span(&buffer, 1), received_length, rx_timestamp, ec);
+}
+
+void TcpSocket::receive(std::span<IoBuffer> buffers, std::size_t& received_length,
+                        std::optional<KernelTimestamp>& rx_timestamp, std::error_code& ec)
 {
     ec.clear();
+    rx_timestamp.reset();
+
+#ifdef __linux__
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(scm_timestamping))];
 
-#ifdef _WIN32
-    DWORD sent;
-    const auto ret =
-        WSASend(get_handle(), buffers.data(), static_cast<DWORD>(buffers.size()), &sent, 0, nullptr, nullptr);
-#else // POSIX
     msghdr msg{};
     msg.msg_iov = buffers.data();
     msg.msg_iovlen = buffers.size();
-    const auto ret = sendmsg(get_handle(), &msg, 0);
-    const auto sent = ret;
-#endif
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
 
+    const auto ret = recvmsg(get_handle(), &msg, 0);
     if (SOCKET_ERROR == ret)
     {
-        sent_length = 0;
+        received_length = 0;
         ec = System::get_last_error_code();
         return;
     }
+    received_length = static_cast<std::size_t>(ret);
 
-    sent_length = static_cast<std::size_t>(sent);
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (SOL_SOCKET == cmsg->cmsg_level && SCM_TIMESTAMPING == cmsg->cmsg_type)
+        {
+            scm_timestamping tss;
+            std::memcpy(&tss, CMSG_DATA(cmsg), sizeof(tss));
+            // `ts[0]` is the software timestamp
+            rx_timestamp = to_kernel_timestamp(tss.ts[0]);
+        }
+    }
+#else
+    receive(buffers, received_length, ec);
+#endif
 }
 
-void TcpSocket::send(std::span<IoBuffer> buffers, std::error_code& ec)
+void TcpSocket::read_tx_timestamps(std::span<TxTimestamp> out_timestamps, std::size_t& read_count,
+                                   std::error_code& ec)
 {
-    [[maybe_unused]] std::size_t sent_length;
-    return send(buffers, sent_length, ec);
+    ec.clear();
+    read_count = 0;
+
+#ifdef __linux__
+    while (read_count < out_timestamps.size())
+    {
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(scm_timestamping)) + CMSG_SPACE(sizeof(sock_extended_err) +
+                                                                                        sizeof(sockaddr_in6))];
+
+        msghdr msg{};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (SOCKET_ERROR == recvmsg(get_handle(), &msg, MSG_ERRQUEUE | MSG_DONTWAIT))
+        {
+            ec = System::get_last_error_code();
+            // error queue is drained
+            if (ec == SocketErrc::WOULD_BLOCK)
+                ec.clear();
+            return;
+        }
+
+        std::optional<KernelTimestamp> timestamp;
+        const sock_extended_err* err = nullptr;
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (SOL_SOCKET == cmsg->cmsg_level && SCM_TIMESTAMPING == cmsg->cmsg_type)
+            {
+                scm_timestamping tss;
+                std::memcpy(&tss, CMSG_DATA(cmsg), sizeof(tss));
+                timestamp = to_kernel_timestamp(tss.ts[0]);
+            }
+            else if ((IPPROTO_IP == cmsg->cmsg_level && IP_RECVERR == cmsg->cmsg_type) ||
+                     (IPPROTO_IPV6 == cmsg->cmsg_level && IPV6_RECVERR == cmsg->cmsg_type))
+            {
+                err = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cmsg));
+            }
+        }
+
+        // skip anything other than timestamps, e.g. ICMP errors
+        if (!timestamp || !err || ENOMSG != err->ee_errno || SO_EE_ORIGIN_TIMESTAMPING != err->ee_origin)
+            continue;
+
+        TxTimestamp& out = out_timestamps[read_count];
+        switch (err->ee_info)
+        {
+        case SCM_TSTAMP_SCHED:
+            out.kind = TxTimestamp::Kind::SCHED;
+            break;
+        case SCM_TSTAMP_SND:
+            out.kind = TxTimestamp::Kind::SOFTWARE;
+            break;
+        case SCM_TSTAMP_ACK:
+            out.kind = TxTimestamp::Kind::ACK;
+            break;
+        default:
+            continue;
+        }
+        out.byte_offset = err->ee_data;
+        out.timestamp = *timestamp;
+        ++read_count;
+    }
+#else
+    (void)out_timestamps;
+    ec = SystemErrc::operation_not_supported;
+#endif
 }
 
-#ifdef _WIN32
-void TcpSocket::send(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped,
-                     LPWSAOVERLAPPED_COMPLETION_ROUTINE completion_routine, std::error_code& ec)
+auto TcpSocket::get_remote_address(std::error_code& ec) const -> std::optional<SocketAddress>
 {
-    ec.clear();
-
-    const auto ret = WSASend(get_handle(), buffers.data(), static_cast<DWORD>(buffers.size()), nullptr, 0, &overlapped,
-                             completion_routine);
+    sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
 
-    if (SOCKET_ERROR == ret)
+    if (SOCKET_ERROR == ::getpeername(get_handle(), reinterpret_cast<sockaddr*>(&addr), &addr_len))
+    {
         ec = System::get_last_error_code();
-}
+        return std::nullopt;
+    }
 
-void TcpSocket::send(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped, std::error_code& ec)
-{
-    return send(buffers, overlapped, nullptr, ec);
+    return SocketAddress(reinterpret_cast<sockaddr&>(addr));
 }
-#endif
 
-void TcpSocket::receive(void* data, std::size_t data_length, std::size_t& received_length, std::error_code& ec)
+auto TcpSocket::get_tcp_info(std::error_code& ec) const -> std::optional<TcpInfo>
 {
     ec.clear();
 
+    TcpInfo result;
+
 #ifdef _WIN32
-    const auto ret = ::recv(get_handle(), static_cast<char*>(data), static_cast<int>(data_length), 0);
-#else // POSIX
-    const auto ret = ::recv(get_handle(), static_cast<char*>(data), data_length, 0);
-#endif
+    DWORD version = 0;
+    TCP_INFO_v0 info{};
+    DWORD bytes_returned;
 
-    if (SOCKET_ERROR == ret)
+    if (SOCKET_ERROR == WSAIoctl(get_handle(), SIO_TCP_INFO, &version, sizeof(version), &info, sizeof(info),
+                                 &bytes_returned, nullptr, nullptr))
     {
-        received_length = 0;
         ec = System::get_last_error_code();
-        return;
+        return std::nullopt;
     }
 
-    received_length = ret;
+    result.smoothed_rtt = std::chrono::microseconds(info.RttUs);
+    result.min_rtt = std::chrono::microseconds(info.MinRttUs);
+    result.congestion_window = info.Cwnd;
+    result.send_mss = info.Mss;
+    result.total_retransmits = info.FastRetrans + info.TimeoutEpisodes;
+    result.unacked = (0 == info.Mss) ? 0 : static_cast<std::uint32_t>(info.BytesInFlight / info.Mss);
+    result.bytes_acked = info.BytesOut - info.BytesInFlight;
+    result.bytes_received = info.BytesIn;
+#elif defined(__linux__)
+    KernelTcpInfo info{};
+    socklen_t len = sizeof(info);
+
+    if (SOCKET_ERROR == ::getsockopt(get_handle(), IPPROTO_TCP, TCP_INFO, &info, &len))
+    {
+        ec = System::get_last_error_code();
+        return std::nullopt;
+    }
+
+    const auto ulen = static_cast<std::size_t>(len);
+
+    result.smoothed_rtt = std::chrono::microseconds(info.rtt);
+    result.rtt_variance = std::chrono::microseconds(info.rttvar);
+    result.congestion_window = std::uint64_t{info.snd_cwnd} * info.snd_mss;
+    if (info.snd_ssthresh < TCP_INFINITE_SSTHRESH)
+        result.slow_start_threshold = std::uint64_t{info.snd_ssthresh} * info.snd_mss;
+    result.send_mss = info.snd_mss;
+    result.retransmits = info.retransmits;
+    result.total_retransmits = info.total_retrans;
+    result.unacked = info.unacked;
+    result.sacked = info.sacked;
+    result.lost = info.lost;
+
+    if (DS_HAS_TCP_INFO_FIELD(ulen, pacing_rate))
+        result.pacing_rate = info.pacing_rate;
+    if (DS_HAS_TCP_INFO_FIELD(ulen, bytes_acked))
+        result.bytes_acked = info.bytes_acked;
+    if (DS_HAS_TCP_INFO_FIELD(ulen, bytes_received))
+        result.bytes_received = info.bytes_received;
+    if (DS_HAS_TCP_INFO_FIELD(ulen, notsent_bytes))
+        result.not_sent_bytes = info.notsent_bytes;
+    if (DS_HAS_TCP_INFO_FIELD(ulen, min_rtt))
+        result.min_rtt = std::chrono::microseconds(info.min_rtt);
+    if (DS_HAS_TCP_INFO_FIELD(ulen, delivery_rate))
+        result.delivery_rate = info.delivery_rate;
+#else
+    ec = SystemErrc::operation_not_supported;
+    return std::nullopt;
+#endif
+
+    return result;
 }
 
-void TcpSocket::receive(std::span<IoBuffer> buffers, std::size_t& received_length, std::error_code& ec)
+TcpSocket::TcpSocket(SOCKET handle, bool non_blocking) : StreamSocket(handle, non_blocking)
 {
-    ec.clear();
+}
 
-#ifdef _WIN32
-    DWORD received;
-    DWORD flags = 0;
-    const auto ret =
-        WSARecv(get_handle(), buffers.data(), static_cast<DWORD>(buffers.size()), &received, &flags, nullptr, nullptr);
-#else
-    msghdr msg{};
-    msg.msg_iov = buffers.data();
-    msg.msg_iovlen = buffers.size();
-    const auto ret = recvmsg(get_handle(), &msg, 0);
-    const auto received = ret;
-#endif
+TcpSocket::~TcpSocket()
+{
+    if (_cork_batch)
+        _cork_batch->drop(*this);
+}
 
-    if (SOCKET_ERROR == ret)
+TcpSocket::TcpSocket(TcpSocket&& other) noexcept : StreamSocket(std::move(other)), _cork_batch(other._cork_batch)
+{
+    other._cork_batch = nullptr;
+    if (_cork_batch)
+        _cork_batch->relocate(other, *this);
+}
+
+TcpSocket& TcpSocket::operator=(TcpSocket&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    // its own handle is closed here
+    if (_cork_batch)
+        _cork_batch->drop(*this);
+
+    StreamSocket::operator=(std::move(other));
+
+    _cork_batch = other._cork_batch;
+    other._cork_batch = nullptr;
+    if (_cork_batch)
+        _cork_batch->relocate(other, *this);
+
+    return *this;
+}
+
+void TcpSocket::close()
+{
+    if (_cork_batch)
+        _cork_batch->drop(*this);
+
+    Socket::close();
+}
+
+auto TcpSocket::release() -> SOCKET
+{
+    if (_cork_batch)
     {
-        received_length = 0;
-        ec = System::get_last_error_code();
-        return;
+        std::error_code ec; // the new owner can't tell it was corked, so this is best-effort
+        _cork_batch->uncork(*this, ec);
     }
 
-    received_length = static_cast<std::size_t>(received);
+    return Socket::release();
 }
 
-#ifdef _WIN32
-void TcpSocket::receive(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped,
-                        LPWSAOVERLAPPED_COMPLETION_ROUTINE completion_routine, std::error_code& ec)
+auto TcpSocket::get_unsent_length(std::error_code& ec) const -> std::size_t
 {
     ec.clear();
 
-    DWORD flags = 0;
-    const auto ret = WSARecv(get_handle(), buffers.data(), static_cast<DWORD>(buffers.size()), nullptr, &flags,
-                             &overlapped, completion_routine);
-
-    if (SOCKET_ERROR == ret)
+#ifdef __linux__
+    int length = 0;
+    if (SOCKET_ERROR == ::ioctl(get_handle(), SIOCOUTQNSD, &length))
+    {
         ec = System::get_last_error_code();
+        return 0;
+    }
+    return static_cast<std::size_t>(length);
+#else
+    ec = SystemErrc::operation_not_supported;
+    return 0;
+#endif
 }
 
-void TcpSocket::receive(std::span<IoBuffer> buffers, WSAOVERLAPPED& overlapped, std::error_code& ec)
+void TcpSocket::set_not_sent_low_watermark(std::uint32_t bytes, std::error_code& ec)
 {
-    return receive(buffers, overlapped, nullptr, ec);
-}
+    ec.clear();
+
+#ifdef TCP_NOTSENT_LOWAT
+    const unsigned int value = bytes;
+    if (SOCKET_ERROR == setsockopt(get_handle(), IPPROTO_TCP, TCP_NOTSENT_LOWAT, &value, sizeof(value)))
+        ec = System::get_last_error_code();
+#else
+    (void)bytes;
+    ec = SystemErrc::operation_not_supported;
 #endif
+}
 
-auto TcpSocket::get_remote_address(std::error_code& ec) const -> std::optional<SocketAddress>
+auto TcpSocket::get_not_sent_low_watermark(std::error_code& ec) const -> std::uint32_t
 {
-    sockaddr_storage addr;
-    socklen_t addr_len = sizeof(addr);
+    ec.clear();
 
-    if (SOCKET_ERROR == ::getpeername(get_handle(), reinterpret_cast<sockaddr*>(&addr), &addr_len))
+#ifdef TCP_NOTSENT_LOWAT
+    unsigned int value = 0;
+    socklen_t len = sizeof(value);
+    if (SOCKET_ERROR == ::getsockopt(get_handle(), IPPROTO_TCP, TCP_NOTSENT_LOWAT, &value, &len))
     {
         ec = System::get_last_error_code();
-        return std::nullopt;
+        return 0;
     }
+    return value;
+#else
+    ec = SystemErrc::operation_not_supported;
+    return 0;
+#endif
+}
 
-    return SocketAddress(reinterpret_cast<sockaddr&>(addr));
+void TcpSocket::set_no_delay(bool no_delay, std::error_code& ec)
+{
+    ec.clear();
+
+    const int value = no_delay ? 1 : 0;
+    if (SOCKET_ERROR ==
+        setsockopt(get_handle(), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&value), sizeof(value)))
+        ec = System::get_last_error_code();
 }
 
-TcpSocket::TcpSocket(SOCKET handle, bool non_blocking) : Socket(handle, non_blocking)
+void TcpSocket::set_cork(bool cork, std::error_code& ec)
 {
+    set_tcp_cork(get_handle(), cork, ec);
+}
+
+void set_tcp_cork(SOCKET handle, bool cork, std::error_code& ec)
+{
+    ec.clear();
+
+#if defined(TCP_CORK)
+    const int value = cork ? 1 : 0;
+    if (SOCKET_ERROR == setsockopt(handle, IPPROTO_TCP, TCP_CORK, &value, sizeof(value)))
+        ec = System::get_last_error_code();
+#elif defined(TCP_NOPUSH)
+    const int value = cork ? 1 : 0;
+    if (SOCKET_ERROR == setsockopt(handle, IPPROTO_TCP, TCP_NOPUSH, &value, sizeof(value)))
+        ec = System::get_last_error_code();
+#else
+    (void)handle;
+    (void)cork;
+    ec = SystemErrc::operation_not_supported;
+#endif
 }
 
 } // namespace ds
@@ -0,0 +1,205 @@
+#include "DirtySocks/ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace ds
+{
+
+namespace
+{
+
+struct CurrentWorker
+{
+    const ThreadPool* pool = nullptr;
+    std::size_t index = 0;
+};
+
+thread_local CurrentWorker t_current_worker;
+
+// number of failed steal rounds before going to sleep
+static constexpr int IDLE_SPIN_ROUNDS = 64;
+
+} // namespace
+
+ThreadPool::ThreadPool(std::size_t workers_count)
+{
+    if (0 == workers_count)
+        workers_count = std::max(1u, std::thread::hardware_concurrency());
+
+    _workers.reserve(workers_count);
+    for (std::size_t i = 0; i < workers_count; ++i)
+    {
+        _workers.push_back(std::make_unique<Worker>());
+        _workers.back()->steal_seed = static_cast<std::uint32_t>(i * 2654435761u + 1);
+    }
+
+    // start threads after all workers are constructed, as they steal from each other
+    for (std::size_t i = 0; i < workers_count; ++i)
+        _workers[i]->thread = std::thread([this, i] { run_worker(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    _stopping.store(true, std::memory_order_seq_cst);
+
+    for (auto& worker : _workers)
+        wake(*worker);
+    for (auto& worker : _workers)
+        worker->thread.join();
+}
+
+void ThreadPool::submit(Task task)
+{
+    Task* item = new Task(std::move(task));
+
+    // submitted from one of our workers: push to its own deque, and let idle peers steal it
+    if (t_current_worker.pool == this)
+    {
+        _workers[t_current_worker.index]->deque.push(item);
+        wake_idle_peer();
+        return;
+    }
+
+    _injector.push(item);
+
+    // pairs with the sleeping count increment before the last check, so either that check sees the task,
+    // or this sees the sleeper
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    wake_idle_peer();
+}
+
+auto ThreadPool::get_workers_count() const -> std::size_t
+{
+    return _workers.size();
+}
+
+void ThreadPool::run_worker(std::size_t index)
+{
+    t_current_worker = CurrentWorker{this, index};
+    Worker& self = *_workers[index];
+
+    int idle_rounds = 0;
+    while (true)
+    {
+        if (Task* task = find_task(self))
+        {
+            idle_rounds = 0;
+            (*task)();
+            delete task;
+            continue;
+        }
+
+        if (++idle_rounds < IDLE_SPIN_ROUNDS)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        idle_rounds = 0;
+
+        // prepare to sleep, then re-check everything to avoid a lost wake-up
+        const std::uint32_t epoch = self.wake_epoch.load(std::memory_order_acquire);
+        self.sleeping.store(true, std::memory_order_relaxed);
+        _sleeping_count.fetch_add(1, std::memory_order_seq_cst);
+
+        if (Task* task = find_task(self))
+        {
+            self.sleeping.store(false, std::memory_order_relaxed);
+            _sleeping_count.fetch_sub(1, std::memory_order_relaxed);
+            (*task)();
+            delete task;
+            continue;
+        }
+
+        // own deque & the shared queue are empty here, and nothing left to steal
+        if (_stopping.load(std::memory_order_seq_cst))
+        {
+            self.sleeping.store(false, std::memory_order_relaxed);
+            _sleeping_count.fetch_sub(1, std::memory_order_relaxed);
+            break;
+        }
+
+        self.wake_epoch.wait(epoch, std::memory_order_acquire);
+        self.sleeping.store(false, std::memory_order_relaxed);
+        _sleeping_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    t_current_worker = CurrentWorker{};
+}
+
+auto ThreadPool::find_task(Worker& self) -> Task*
+{
+    if (auto task = self.deque.pop())
+        return *task;
+
+    if (Task* task = take_injected_task())
+        return task;
+
+    return steal_task(self);
+}
+
+auto ThreadPool::take_injected_task() -> Task*
+{
+    // the queue has a single consumer; whoever misses out here steals meanwhile, and retries on the next round
+    if (_injector_taken.exchange(true, std::memory_order_seq_cst))
+        return nullptr;
+
+    // one at a time, so a single worker doesn't hoard the queue while the others idle
+    const auto task = _injector.try_pop();
+    const bool more = !_injector.empty();
+    _injector_taken.store(false, std::memory_order_seq_cst);
+
+    // a peer may have gone to sleep after missing out on the lock
+    if (more)
+        wake_idle_peer();
+
+    return task ? *task : nullptr;
+}
+
+auto ThreadPool::steal_task(Worker& self) -> Task*
+{
+    const std::size_t count = _workers.size();
+    if (count <= 1)
+        return nullptr;
+
+    // xorshift32 for a random victim to start from
+    self.steal_seed ^= self.steal_seed << 13;
+    self.steal_seed ^= self.steal_seed >> 17;
+    self.steal_seed ^= self.steal_seed << 5;
+    const std::size_t start = self.steal_seed % count;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Worker& victim = *_workers[(start + i) % count];
+        if (&victim == &self)
+            continue;
+
+        if (auto task = victim.deque.steal())
+            return *task;
+    }
+
+    return nullptr;
+}
+
+void ThreadPool::wake(Worker& worker)
+{
+    worker.wake_epoch.fetch_add(1, std::memory_order_release);
+    worker.wake_epoch.notify_one();
+}
+
+void ThreadPool::wake_idle_peer()
+{
+    if (0 == _sleeping_count.load(std::memory_order_seq_cst))
+        return;
+
+    // any sleeping worker will do, it steals the work after waking up
+    for (auto& worker : _workers)
+    {
+        if (worker->sleeping.load(std::memory_order_relaxed))
+        {
+            wake(*worker);
+            return;
+        }
+    }
+}
+
+} // namespace ds
@@ -0,0 +1,79 @@
+#include "DirtySocks/TokenBucket.hpp"
+
+#include <algorithm>
+
+namespace ds
+{
+
+TokenBucket::TokenBucket(std::uint64_t rate, std::size_t burst, Clock::time_point now)
+    : _rate(rate), _burst(burst), _tokens(static_cast<double>(burst)), _last_refill(now)
+{
+}
+
+auto TokenBucket::get_available(Clock::time_point now) -> std::size_t
+{
+    refill(now);
+    return static_cast<std::size_t>(_tokens);
+}
+
+bool TokenBucket::try_consume(std::size_t bytes, Clock::time_point now)
+{
+    refill(now);
+    if (_tokens < static_cast<double>(bytes))
+        return false;
+
+    _tokens -= static_cast<double>(bytes);
+    return true;
+}
+
+void TokenBucket::consume(std::size_t bytes, Clock::time_point now)
+{
+    refill(now);
+    _tokens = std::max(0.0, _tokens - static_cast<double>(bytes));
+}
+
+auto TokenBucket::get_wait_time(std::size_t bytes, Clock::time_point now) -> Clock::duration
+{
+    refill(now);
+
+    const double missing = static_cast<double>(std::min(bytes, _burst)) - _tokens;
+    if (missing <= 0)
+        return Clock::duration::zero();
+    if (0 == _rate)
+        return Clock::duration::max();
+
+    const std::chrono::duration<double> wait(missing / static_cast<double>(_rate));
+    return std::chrono::ceil<Clock::duration>(wait);
+}
+
+auto TokenBucket::get_rate() const -> std::uint64_t
+{
+    return _rate;
+}
+
+auto TokenBucket::get_burst() const -> std::size_t
+{
+    return _burst;
+}
+
+void TokenBucket::set_rate(std::uint64_t rate, std::size_t burst, Clock::time_point now)
+{
+    // settle the tokens earned at the old rate first
+    refill(now);
+
+    _rate = rate;
+    _burst = burst;
+    _tokens = std::min(_tokens, static_cast<double>(burst));
+}
+
+void TokenBucket::refill(Clock::time_point now)
+{
+    if (now <= _last_refill)
+        return;
+
+    const double elapsed = std::chrono::duration<double>(now - _last_refill).count();
+    _tokens = std::min(static_cast<double>(_burst), _tokens + elapsed * static_cast<double>(_rate));
+    _last_refill = now;
+}
+
+} // namespace ds
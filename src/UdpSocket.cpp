@@ -0,0 +1,461 @@
+#include "DirtySocks/UdpSocket.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/System.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ds
+{
+
+namespace
+{
+
+#ifdef __linux__
+// number of datagrams received by a single `recvmmsg()`
+constexpr std::size_t MAX_DATAGRAMS_PER_RECEIVE = 64;
+#endif
+
+// `IP_MULTICAST_TTL` & `IP_MULTICAST_LOOP` take a `DWORD` on Windows, and a `u_char` on BSDs
+#if defined(_WIN32)
+using Ipv4MulticastOption = DWORD;
+#elif defined(__linux__)
+using Ipv4MulticastOption = int;
+#else
+using Ipv4MulticastOption = u_char;
+#endif
+
+#ifdef _WIN32
+using Ipv6MulticastOption = DWORD;
+#else
+using Ipv6MulticastOption = int;
+#endif
+
+template <typename Value>
+void set_option(SOCKET handle, int level, int name, const Value& value, std::error_code& ec)
+{
+    if (SOCKET_ERROR == setsockopt(handle, level, name, reinterpret_cast<const char*>(&value), sizeof(value)))
+        ec = System::get_last_error_code();
+}
+
+void copy_address(const SocketAddress& addr, sockaddr_storage& out_addr)
+{
+    std::memset(&out_addr, 0, sizeof(out_addr));
+    std::memcpy(&out_addr, &addr.get_sockaddr(), addr.get_sockaddr_len());
+}
+
+} // namespace
+
+void UdpSocket::open(IpVersion ip_version, std::error_code& ec)
+{
+    init_handle(ip_version, Socket::Protocol::UDP, ec);
+    if (!ec)
+        _ip_version = ip_version;
+}
+
+void UdpSocket::bind(const SocketAddress& addr, std::error_code& ec)
+{
+    ec.clear();
+    if (INVALID_SOCKET == get_handle())
+    {
+        open(addr.get_ip_version(), ec);
+        if (ec)
+            return;
+    }
+
+    if (SOCKET_ERROR == ::bind(get_handle(), &addr.get_sockaddr(), addr.get_sockaddr_len()))
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+}
+
+void UdpSocket::connect(const SocketAddress& addr, std::error_code& ec)
+{
+    ec.clear();
+    if (INVALID_SOCKET == get_handle())
+    {
+        open(addr.get_ip_version(), ec);
+        if (ec)
+            return;
+    }
+
+    if (SOCKET_ERROR == ::connect(get_handle(), &addr.get_sockaddr(), addr.get_sockaddr_len()))
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+}
+
+void UdpSocket::set_reuse_address(bool reuse, std::error_code& ec)
+{
+    ec.clear();
+
+#ifdef _WIN32
+    const DWORD enabled = reuse;
+#else // POSIX
+    const int enabled = reuse;
+#endif
+    set_option(get_handle(), SOL_SOCKET, SO_REUSEADDR, enabled, ec);
+
+    // BSDs need `SO_REUSEPORT` for several sockets to bind the same multicast address and port
+#if !defined(_WIN32) && !defined(__linux__) && defined(SO_REUSEPORT)
+    if (!ec)
+        set_option(get_handle(), SOL_SOCKET, SO_REUSEPORT, enabled, ec);
+#endif
+}
+
+void UdpSocket::send(const void* data, std::size_t data_length, std::size_t& sent_length, std::error_code& ec)
+{
+    IoBuffer buffer;
+    buffer.iov_base = static_cast<char*>(const_cast<void*>(data));
+    buffer.iov_len = static_cast<decltype(buffer.iov_len)>(data_length);
+    return send_message(std::span<IoBuffer>(&buffer, 1), nullptr, sent_length, ec);
+}
+
+void UdpSocket::send(std::span<IoBuffer> buffers, std::size_t& sent_length, std::error_code& ec)
+{
+    return send_message(buffers, nullptr, sent_length, ec);
+}
+
+void UdpSocket::send_to(const void* data, std::size_t data_length, const SocketAddress& addr,
+                        std::size_t& sent_length, std::error_code& ec)
+{
+    IoBuffer buffer;
+    buffer.iov_base = static_cast<char*>(const_cast<void*>(data));
+    buffer.iov_len = static_cast<decltype(buffer.iov_len)>(data_length);
+    return send_message(std::span<IoBuffer>(&buffer, 1), &addr, sent_length, ec);
+}
+
+void UdpSocket::send_to(std::span<IoBuffer> buffers, const SocketAddress& addr, std::size_t& sent_length,
+                        std::error_code& ec)
+{
+    return send_message(buffers, &addr, sent_length, ec);
+}
+
+void UdpSocket::receive(void* data, std::size_t data_length, std::size_t& received_length, std::error_code& ec)
+{
+    IoBuffer buffer;
+    buffer.iov_base = static_cast<char*>(data);
+    buffer.iov_len = static_cast<decltype(buffer.iov_len)>(data_length);
+    return receive_message(std::span<IoBuffer>(&buffer, 1), received_length, nullptr, ec);
+}
+
+void UdpSocket::receive(std::span<IoBuffer> buffers, std::size_t& received_length, std::error_code& ec)
+{
+    return receive_message(buffers, received_length, nullptr, ec);
+}
+
+void UdpSocket::receive_from(void* data, std::size_t data_length, std::size_t& received_length,
+                             SocketAddress& sender, std::error_code& ec)
+{
+    IoBuffer buffer;
+    buffer.iov_base = static_cast<char*>(data);
+    buffer.iov_len = static_cast<decltype(buffer.iov_len)>(data_length);
+    return receive_message(std::span<IoBuffer>(&buffer, 1), received_length, &sender, ec);
+}
+
+void UdpSocket::receive_from(std::span<IoBuffer> buffers, std::size_t& received_length, SocketAddress& sender,
+                             std::error_code& ec)
+{
+    return receive_message(buffers, received_length, &sender, ec);
+}
+
+void UdpSocket::receive_batch(std::span<ReceivedDatagram> datagrams, std::size_t& received_count,
+                              std::error_code& ec)
+{
+    ec.clear();
+    received_count = 0;
+
+#ifdef __linux__
+    mmsghdr messages[MAX_DATAGRAMS_PER_RECEIVE];
+    IoBuffer buffers[MAX_DATAGRAMS_PER_RECEIVE];
+    sockaddr_storage senders[MAX_DATAGRAMS_PER_RECEIVE];
+
+    while (received_count < datagrams.size())
+    {
+        const auto batch = datagrams.subspan(received_count).first(
+            std::min(datagrams.size() - received_count, MAX_DATAGRAMS_PER_RECEIVE));
+
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            buffers[i].iov_base = batch[i].buffer.data();
+            buffers[i].iov_len = batch[i].buffer.size();
+
+            messages[i] = {};
+            messages[i].msg_hdr.msg_name = &senders[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+            messages[i].msg_hdr.msg_iov = &buffers[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        // only the first call may wait, and only for its first datagram
+        const int flags = (0 == received_count) ? MSG_WAITFORONE : MSG_DONTWAIT;
+        const int ret = recvmmsg(get_handle(), messages, static_cast<unsigned>(batch.size()), flags, nullptr);
+        if (SOCKET_ERROR == ret)
+        {
+            if (0 == received_count)
+                ec = System::get_last_error_code();
+            return;
+        }
+
+        const auto count = static_cast<std::size_t>(ret);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            batch[i].length = messages[i].msg_len;
+            batch[i].truncated = (messages[i].msg_hdr.msg_flags & MSG_TRUNC);
+            batch[i].sender.emplace(reinterpret_cast<const sockaddr&>(senders[i]));
+        }
+        received_count += count;
+
+        // the receive queue is drained
+        if (count < batch.size())
+            return;
+    }
+#else
+    for (ReceivedDatagram& datagram : datagrams)
+    {
+        sockaddr_storage sender;
+        IoBuffer buffer;
+        buffer.iov_base = reinterpret_cast<char*>(datagram.buffer.data());
+        buffer.iov_len = static_cast<decltype(buffer.iov_len)>(datagram.buffer.size());
+
+#ifdef _WIN32
+        DWORD received;
+        DWORD flags = 0;
+        int sender_len = sizeof(sender);
+        auto ret = WSARecvFrom(get_handle(), &buffer, 1, &received, &flags, reinterpret_cast<sockaddr*>(&sender),
+                               &sender_len, nullptr, nullptr);
+        datagram.truncated = (SOCKET_ERROR == ret && WSAEMSGSIZE == WSAGetLastError());
+        if (datagram.truncated)
+        {
+            received = buffer.len;
+            ret = 0;
+        }
+#else // POSIX
+        msghdr msg{};
+        msg.msg_name = &sender;
+        msg.msg_namelen = sizeof(sender);
+        msg.msg_iov = &buffer;
+        msg.msg_iovlen = 1;
+        const auto ret = recvmsg(get_handle(), &msg, 0);
+        const auto received = ret;
+        datagram.truncated = (msg.msg_flags & MSG_TRUNC);
+#endif
+
+        if (SOCKET_ERROR == ret)
+        {
+            if (0 == received_count)
+                ec = System::get_last_error_code();
+            return;
+        }
+
+        datagram.length = static_cast<std::size_t>(received);
+        datagram.sender.emplace(reinterpret_cast<const sockaddr&>(sender));
+        ++received_count;
+
+        // a blocking socket would wait for the next one
+        if (!is_non_blocking())
+            return;
+    }
+#endif
+}
+
+void UdpSocket::join_group(const SocketAddress& group, std::uint32_t interface_index, std::error_code& ec)
+{
+    return change_membership(true, group, nullptr, interface_index, ec);
+}
+
+void UdpSocket::join_group(const SocketAddress& group, const SocketAddress& source, std::uint32_t interface_index,
+                           std::error_code& ec)
+{
+    return change_membership(true, group, &source, interface_index, ec);
+}
+
+void UdpSocket::leave_group(const SocketAddress& group, std::uint32_t interface_index, std::error_code& ec)
+{
+    return change_membership(false, group, nullptr, interface_index, ec);
+}
+
+void UdpSocket::leave_group(const SocketAddress& group, const SocketAddress& source, std::uint32_t interface_index,
+                            std::error_code& ec)
+{
+    return change_membership(false, group, &source, interface_index, ec);
+}
+
+void UdpSocket::set_multicast_ttl(int ttl, std::error_code& ec)
+{
+    ec.clear();
+
+    const IpVersion ip_version = get_ip_version(ec);
+    if (ec)
+        return;
+
+    if (IpVersion::V6 == ip_version)
+        set_option(get_handle(), IPPROTO_IPV6, IPV6_MULTICAST_HOPS, static_cast<Ipv6MulticastOption>(ttl), ec);
+    else
+        set_option(get_handle(), IPPROTO_IP, IP_MULTICAST_TTL, static_cast<Ipv4MulticastOption>(ttl), ec);
+}
+
+void UdpSocket::set_multicast_loopback(bool loopback, std::error_code& ec)
+{
+    ec.clear();
+
+    const IpVersion ip_version = get_ip_version(ec);
+    if (ec)
+        return;
+
+    if (IpVersion::V6 == ip_version)
+        set_option(get_handle(), IPPROTO_IPV6, IPV6_MULTICAST_LOOP, static_cast<Ipv6MulticastOption>(loopback), ec);
+    else
+        set_option(get_handle(), IPPROTO_IP, IP_MULTICAST_LOOP, static_cast<Ipv4MulticastOption>(loopback), ec);
+}
+
+void UdpSocket::set_multicast_interface(std::uint32_t interface_index, std::error_code& ec)
+{
+    ec.clear();
+
+    const IpVersion ip_version = get_ip_version(ec);
+    if (ec)
+        return;
+
+    if (IpVersion::V6 == ip_version)
+    {
+        set_option(get_handle(), IPPROTO_IPV6, IPV6_MULTICAST_IF, static_cast<Ipv6MulticastOption>(interface_index),
+                   ec);
+        return;
+    }
+
+    // IPv4 takes an interface address, except for these platform-specific ways to pass an index
+#if defined(_WIN32)
+    // an index in network byte order, as an address in `0.0.0.0/8`
+    set_option(get_handle(), IPPROTO_IP, IP_MULTICAST_IF, static_cast<DWORD>(htonl(interface_index)), ec);
+#elif defined(__linux__)
+    ip_mreqn mreq{};
+    mreq.imr_ifindex = static_cast<int>(interface_index);
+    set_option(get_handle(), IPPROTO_IP, IP_MULTICAST_IF, mreq, ec);
+#elif defined(IP_MULTICAST_IFINDEX)
+    set_option(get_handle(), IPPROTO_IP, IP_MULTICAST_IFINDEX, static_cast<unsigned>(interface_index), ec);
+#else
+    (void)interface_index;
+    ec = SystemErrc::operation_not_supported;
+#endif
+}
+
+auto UdpSocket::get_remote_address(std::error_code& ec) const -> std::optional<SocketAddress>
+{
+    ec.clear();
+
+    sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+
+    if (SOCKET_ERROR == ::getpeername(get_handle(), reinterpret_cast<sockaddr*>(&addr), &addr_len))
+    {
+        ec = System::get_last_error_code();
+        return std::nullopt;
+    }
+
+    return SocketAddress(reinterpret_cast<sockaddr&>(addr));
+}
+
+void UdpSocket::send_message(std::span<IoBuffer> buffers, const SocketAddress* addr, std::size_t& sent_length,
+                             std::error_code& ec)
+{
+    ec.clear();
+
+#ifdef _WIN32
+    DWORD sent;
+    const auto ret = WSASendTo(get_handle(), buffers.data(), static_cast<DWORD>(buffers.size()), &sent, 0,
+                               addr ? &addr->get_sockaddr() : nullptr, addr ? addr->get_sockaddr_len() : 0, nullptr,
+                               nullptr);
+#else // POSIX
+    msghdr msg{};
+    msg.msg_name = addr ? const_cast<sockaddr*>(&addr->get_sockaddr()) : nullptr;
+    msg.msg_namelen = addr ? addr->get_sockaddr_len() : 0;
+    msg.msg_iov = buffers.data();
+    msg.msg_iovlen = buffers.size();
+    const auto ret = sendmsg(get_handle(), &msg, 0);
+    const auto sent = ret;
+#endif
+
+    if (SOCKET_ERROR == ret)
+    {
+        sent_length = 0;
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    sent_length = static_cast<std::size_t>(sent);
+}
+
+void UdpSocket::receive_message(std::span<IoBuffer> buffers, std::size_t& received_length, SocketAddress* sender,
+                                std::error_code& ec)
+{
+    ec.clear();
+
+    sockaddr_storage sender_addr;
+    socklen_t sender_addr_len = sizeof(sender_addr);
+
+#ifdef _WIN32
+    DWORD received;
+    DWORD flags = 0;
+    int win_sender_addr_len = sender_addr_len;
+    const auto ret = WSARecvFrom(get_handle(), buffers.data(), static_cast<DWORD>(buffers.size()), &received, &flags,
+                                 sender ? reinterpret_cast<sockaddr*>(&sender_addr) : nullptr,
+                                 sender ? &win_sender_addr_len : nullptr, nullptr, nullptr);
+#else // POSIX
+    msghdr msg{};
+    msg.msg_name = sender ? &sender_addr : nullptr;
+    msg.msg_namelen = sender ? sender_addr_len : 0;
+    msg.msg_iov = buffers.data();
+    msg.msg_iovlen = buffers.size();
+    const auto ret = recvmsg(get_handle(), &msg, 0);
+    const auto received = ret;
+#endif
+
+    if (SOCKET_ERROR == ret)
+    {
+        received_length = 0;
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    if (sender)
+        *sender = SocketAddress(reinterpret_cast<const sockaddr&>(sender_addr));
+    received_length = static_cast<std::size_t>(received);
+}
+
+void UdpSocket::change_membership(bool join, const SocketAddress& group, const SocketAddress* source,
+                                  std::uint32_t interface_index, std::error_code& ec)
+{
+    ec.clear();
+
+    // the protocol-independent API (RFC 3678) covers both IP versions, with an interface index
+    const int level = (IpVersion::V6 == group.get_ip_version()) ? IPPROTO_IPV6 : IPPROTO_IP;
+
+    if (source)
+    {
+        group_source_req req{};
+        req.gsr_interface = interface_index;
+        copy_address(group, req.gsr_group);
+        copy_address(*source, req.gsr_source);
+        set_option(get_handle(), level, join ? MCAST_JOIN_SOURCE_GROUP : MCAST_LEAVE_SOURCE_GROUP, req, ec);
+    }
+    else
+    {
+        group_req req{};
+        req.gr_interface = interface_index;
+        copy_address(group, req.gr_group);
+        set_option(get_handle(), level, join ? MCAST_JOIN_GROUP : MCAST_LEAVE_GROUP, req, ec);
+    }
+}
+
+auto UdpSocket::get_ip_version(std::error_code& ec) const -> IpVersion
+{
+    if (IpVersion::NONE == _ip_version)
+        ec = SystemErrc::bad_file_descriptor;
+    return _ip_version;
+}
+
+} // namespace ds
@@ -0,0 +1,183 @@
+#include "DirtySocks/UnixDatagramSocket.hpp"
+
+#include "DirtySocks/System.hpp"
+
+#include "UnixSocketName.hpp"
+
+namespace ds
+{
+
+void UnixDatagramSocket::open(std::error_code& ec)
+{
+    init_handle(AF_UNIX, Socket::Protocol::UDP, ec);
+}
+
+void UnixDatagramSocket::bind(const UnixSocketAddress& addr, std::error_code& ec)
+{
+    ec.clear();
+    init_handle(AF_UNIX, Socket::Protocol::UDP, ec);
+    if (ec)
+        return;
+
+    if (SOCKET_ERROR == ::bind(get_handle(), &addr.get_sockaddr(), addr.get_sockaddr_len()))
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+}
+
+void UnixDatagramSocket::connect(const UnixSocketAddress& addr, std::error_code& ec)
+{
+    ec.clear();
+    if (INVALID_SOCKET == get_handle())
+    {
+        open(ec);
+        if (ec)
+            return;
+    }
+
+    if (SOCKET_ERROR == ::connect(get_handle(), &addr.get_sockaddr(), addr.get_sockaddr_len()))
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+}
+
+void UnixDatagramSocket::send(const void* data, std::size_t data_length, std::size_t& sent_length,
+                              std::error_code& ec)
+{
+    IoBuffer buffer;
+    buffer.iov_base = static_cast<char*>(const_cast<void*>(data));
+    buffer.iov_len = static_cast<decltype(buffer.iov_len)>(data_length);
+    return send_message(std::span<IoBuffer>(&buffer, 1), nullptr, sent_length, ec);
+}
+
+void UnixDatagramSocket::send(std::span<IoBuffer> buffers, std::size_t& sent_length, std::error_code& ec)
+{
+    return send_message(buffers, nullptr, sent_length, ec);
+}
+
+void UnixDatagramSocket::send_to(const void* data, std::size_t data_length, const UnixSocketAddress& addr,
+                                 std::size_t& sent_length, std::error_code& ec)
+{
+    IoBuffer buffer;
+    buffer.iov_base = static_cast<char*>(const_cast<void*>(data));
+    buffer.iov_len = static_cast<decltype(buffer.iov_len)>(data_length);
+    return send_message(std::span<IoBuffer>(&buffer, 1), &addr, sent_length, ec);
+}
+
+void UnixDatagramSocket::send_to(std::span<IoBuffer> buffers, const UnixSocketAddress& addr,
+                                 std::size_t& sent_length, std::error_code& ec)
+{
+    return send_message(buffers, &addr, sent_length, ec);
+}
+
+void UnixDatagramSocket::receive(void* data, std::size_t data_length, std::size_t& received_length,
+                                 std::error_code& ec)
+{
+    IoBuffer buffer;
+    buffer.iov_base = static_cast<char*>(data);
+    buffer.iov_len = static_cast<decltype(buffer.iov_len)>(data_length);
+    return receive_message(std::span<IoBuffer>(&buffer, 1), received_length, nullptr, ec);
+}
+
+void UnixDatagramSocket::receive(std::span<IoBuffer> buffers, std::size_t& received_length, std::error_code& ec)
+{
+    return receive_message(buffers, received_length, nullptr, ec);
+}
+
+void UnixDatagramSocket::receive_from(void* data, std::size_t data_length, std::size_t& received_length,
+                                      UnixSocketAddress& sender, std::error_code& ec)
+{
+    IoBuffer buffer;
+    buffer.iov_base = static_cast<char*>(data);
+    buffer.iov_len = static_cast<decltype(buffer.iov_len)>(data_length);
+    return receive_message(std::span<IoBuffer>(&buffer, 1), received_length, &sender, ec);
+}
+
+void UnixDatagramSocket::receive_from(std::span<IoBuffer> buffers, std::size_t& received_length,
+                                      UnixSocketAddress& sender, std::error_code& ec)
+{
+    return receive_message(buffers, received_length, &sender, ec);
+}
+
+auto UnixDatagramSocket::get_local_address(std::error_code& ec) const -> std::optional<UnixSocketAddress>
+{
+    return get_unix_socket_name(get_handle(), UnixSocketNameKind::LOCAL, ec);
+}
+
+auto UnixDatagramSocket::get_remote_address(std::error_code& ec) const -> std::optional<UnixSocketAddress>
+{
+    return get_unix_socket_name(get_handle(), UnixSocketNameKind::PEER, ec);
+}
+
+void UnixDatagramSocket::send_message(std::span<IoBuffer> buffers, const UnixSocketAddress* addr,
+                                      std::size_t& sent_length, std::error_code& ec)
+{
+    ec.clear();
+
+#ifdef _WIN32
+    DWORD sent;
+    const auto ret = WSASendTo(get_handle(), buffers.data(), static_cast<DWORD>(buffers.size()), &sent, 0,
+                               addr ? &addr->get_sockaddr() : nullptr, addr ? addr->get_sockaddr_len() : 0, nullptr,
+                               nullptr);
+#else // POSIX
+    msghdr msg{};
+    msg.msg_name = addr ? const_cast<sockaddr*>(&addr->get_sockaddr()) : nullptr;
+    msg.msg_namelen = addr ? addr->get_sockaddr_len() : 0;
+    msg.msg_iov = buffers.data();
+    msg.msg_iovlen = buffers.size();
+    const auto ret = sendmsg(get_handle(), &msg, 0);
+    const auto sent = ret;
+#endif
+
+    if (SOCKET_ERROR == ret)
+    {
+        sent_length = 0;
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    sent_length = static_cast<std::size_t>(sent);
+}
+
+void UnixDatagramSocket::receive_message(std::span<IoBuffer> buffers, std::size_t& received_length,
+                                         UnixSocketAddress* sender, std::error_code& ec)
+{
+    ec.clear();
+
+    sockaddr_un sender_addr;
+    socklen_t sender_addr_len = sizeof(sender_addr);
+
+#ifdef _WIN32
+    DWORD received;
+    DWORD flags = 0;
+    int win_sender_addr_len = sender_addr_len;
+    const auto ret = WSARecvFrom(get_handle(), buffers.data(), static_cast<DWORD>(buffers.size()), &received, &flags,
+                                 sender ? reinterpret_cast<sockaddr*>(&sender_addr) : nullptr,
+                                 sender ? &win_sender_addr_len : nullptr, nullptr, nullptr);
+    sender_addr_len = win_sender_addr_len;
+#else // POSIX
+    msghdr msg{};
+    msg.msg_name = sender ? &sender_addr : nullptr;
+    msg.msg_namelen = sender ? sender_addr_len : 0;
+    msg.msg_iov = buffers.data();
+    msg.msg_iovlen = buffers.size();
+    const auto ret = recvmsg(get_handle(), &msg, 0);
+    const auto received = ret;
+    sender_addr_len = msg.msg_namelen;
+#endif
+
+    if (SOCKET_ERROR == ret)
+    {
+        received_length = 0;
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    if (sender)
+        *sender = UnixSocketAddress(reinterpret_cast<const sockaddr&>(sender_addr), sender_addr_len);
+    received_length = static_cast<std::size_t>(received);
+}
+
+} // namespace ds
@@ -0,0 +1,76 @@
+#include "DirtySocks/UnixListener.hpp"
+
+#include "DirtySocks/System.hpp"
+#include "DirtySocks/UnixSocket.hpp"
+
+#include "UnixSocketName.hpp"
+
+namespace ds
+{
+
+void UnixListener::listen(const UnixSocketAddress& addr, int backlog, std::error_code& ec)
+{
+    ec.clear();
+    init_handle(AF_UNIX, Socket::Protocol::TCP, ec);
+    if (ec)
+        return;
+
+    if (SOCKET_ERROR == ::bind(get_handle(), &addr.get_sockaddr(), addr.get_sockaddr_len()))
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    if (SOCKET_ERROR == ::listen(get_handle(), backlog))
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+}
+
+void UnixListener::listen(const UnixSocketAddress& addr, std::error_code& ec)
+{
+    return listen(addr, SOMAXCONN, ec);
+}
+
+void UnixListener::accept(UnixSocket& out_socket, UnixSocketAddress& addr, std::error_code& ec)
+{
+    ec.clear();
+
+    sockaddr_un peer_addr;
+    socklen_t peer_addr_len = sizeof(peer_addr);
+
+#ifdef __linux__
+    const int flags = SOCK_CLOEXEC | (is_non_blocking() ? SOCK_NONBLOCK : 0);
+    SOCKET handle = ::accept4(get_handle(), reinterpret_cast<sockaddr*>(&peer_addr), &peer_addr_len, flags);
+#else
+    SOCKET handle = ::accept(get_handle(), reinterpret_cast<sockaddr*>(&peer_addr), &peer_addr_len);
+#endif
+    if (INVALID_SOCKET == handle)
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    addr = UnixSocketAddress(reinterpret_cast<const sockaddr&>(peer_addr), peer_addr_len);
+    out_socket = UnixSocket(handle, is_non_blocking());
+
+#ifndef __linux__
+    // inherit non-blocking option manually
+    // (on some platforms, client socket doesn't inherit non-blocking option from listener socket)
+    out_socket.set_non_blocking(is_non_blocking(), ec);
+#endif
+}
+
+void UnixListener::accept(UnixSocket& out_socket, std::error_code& ec)
+{
+    [[maybe_unused]] UnixSocketAddress addr;
+    return accept(out_socket, addr, ec);
+}
+
+auto UnixListener::get_local_address(std::error_code& ec) const -> std::optional<UnixSocketAddress>
+{
+    return get_unix_socket_name(get_handle(), UnixSocketNameKind::LOCAL, ec);
+}
+
+} // namespace ds
@@ -0,0 +1,196 @@
+#include "DirtySocks/UnixSocket.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/System.hpp"
+#include "DirtySocks/TcpSocket.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "UnixSocketName.hpp"
+
+namespace ds
+{
+
+void UnixSocket::connect(const UnixSocketAddress& addr, std::error_code& ec)
+{
+    ec.clear();
+    init_handle(AF_UNIX, Socket::Protocol::TCP, ec);
+    if (ec)
+        return;
+
+    if (SOCKET_ERROR == ::connect(get_handle(), &addr.get_sockaddr(), addr.get_sockaddr_len()))
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+}
+
+void UnixSocket::create_pair(UnixSocket& out_socket1, UnixSocket& out_socket2, std::error_code& ec)
+{
+    ec.clear();
+
+#ifdef _WIN32
+    (void)out_socket1;
+    (void)out_socket2;
+    ec = SystemErrc::operation_not_supported;
+#else // POSIX
+    SOCKET handles[2];
+    if (SOCKET_ERROR == ::socketpair(AF_UNIX, SOCK_STREAM, 0, handles))
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    out_socket1 = UnixSocket(handles[0], false);
+    out_socket2 = UnixSocket(handles[1], false);
+#endif
+}
+
+void UnixSocket::send_handles(std::span<const SOCKET> handles, const void* data, std::size_t data_length,
+                              std::size_t& sent_length, std::error_code& ec)
+{
+    ec.clear();
+    sent_length = 0;
+
+#ifdef _WIN32
+    (void)handles;
+    (void)data;
+    (void)data_length;
+    ec = SystemErrc::operation_not_supported;
+#else // POSIX
+    if (handles.size() > MAX_HANDLES_PER_MESSAGE || 0 == data_length)
+    {
+        ec = SystemErrc::invalid_argument;
+        return;
+    }
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(SOCKET) * MAX_HANDLES_PER_MESSAGE)];
+
+    iovec buffer{const_cast<void*>(data), data_length};
+    msghdr msg{};
+    msg.msg_iov = &buffer;
+    msg.msg_iovlen = 1;
+
+    if (!handles.empty())
+    {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(SOCKET) * handles.size());
+
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(SOCKET) * handles.size());
+        std::memcpy(CMSG_DATA(cmsg), handles.data(), sizeof(SOCKET) * handles.size());
+    }
+
+    const auto ret = sendmsg(get_handle(), &msg, 0);
+    if (SOCKET_ERROR == ret)
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+
+    sent_length = static_cast<std::size_t>(ret);
+#endif
+}
+
+void UnixSocket::receive_handles(std::span<SOCKET> out_handles, std::size_t& received_handles_count, void* data,
+                                 std::size_t data_length, std::size_t& received_length, std::error_code& ec)
+{
+    ec.clear();
+    received_handles_count = 0;
+    received_length = 0;
+
+#ifdef _WIN32
+    (void)out_handles;
+    (void)data;
+    (void)data_length;
+    ec = SystemErrc::operation_not_supported;
+#else // POSIX
+    const std::size_t max_handles = std::min(out_handles.size(), MAX_HANDLES_PER_MESSAGE);
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(SOCKET) * MAX_HANDLES_PER_MESSAGE)];
+
+    iovec buffer{data, data_length};
+    msghdr msg{};
+    msg.msg_iov = &buffer;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(SOCKET) * max_handles);
+
+#ifdef MSG_CMSG_CLOEXEC
+    const int flags = MSG_CMSG_CLOEXEC;
+#else
+    const int flags = 0;
+#endif
+
+    const auto ret = recvmsg(get_handle(), &msg, flags);
+    if (SOCKET_ERROR == ret)
+    {
+        ec = System::get_last_error_code();
+        return;
+    }
+    received_length = static_cast<std::size_t>(ret);
+
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+    {
+        if (SOL_SOCKET != cmsg->cmsg_level || SCM_RIGHTS != cmsg->cmsg_type)
+            continue;
+
+        const std::size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(SOCKET);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            SOCKET handle;
+            std::memcpy(&handle, CMSG_DATA(cmsg) + sizeof(SOCKET) * i, sizeof(SOCKET));
+
+            if (received_handles_count < max_handles)
+                out_handles[received_handles_count++] = handle;
+            else
+                ::close(handle);
+        }
+    }
+
+    if (msg.msg_flags & MSG_CTRUNC)
+        ec = SystemErrc::message_size;
+#endif
+}
+
+void UnixSocket::receive_sockets(std::span<TcpSocket> out_sockets, std::size_t& received_sockets_count, void* data,
+                                 std::size_t data_length, std::size_t& received_length, std::error_code& ec)
+{
+    received_sockets_count = 0;
+
+    SOCKET handles[MAX_HANDLES_PER_MESSAGE];
+    std::size_t handles_count;
+    receive_handles(std::span<SOCKET>(handles, std::min(out_sockets.size(), MAX_HANDLES_PER_MESSAGE)), handles_count,
+                    data, data_length, received_length, ec);
+
+    for (std::size_t i = 0; i < handles_count; ++i)
+    {
+        bool non_blocking = false;
+#ifndef _WIN32 // POSIX
+        // `O_NONBLOCK` lives in the open file description, which is shared with the sender
+        const auto flags = fcntl(handles[i], F_GETFL, 0);
+        non_blocking = (SOCKET_ERROR != flags) && (flags & O_NONBLOCK);
+#endif
+        out_sockets[i] = TcpSocket(handles[i], non_blocking);
+    }
+    received_sockets_count = handles_count;
+}
+
+auto UnixSocket::get_local_address(std::error_code& ec) const -> std::optional<UnixSocketAddress>
+{
+    return get_unix_socket_name(get_handle(), UnixSocketNameKind::LOCAL, ec);
+}
+
+auto UnixSocket::get_remote_address(std::error_code& ec) const -> std::optional<UnixSocketAddress>
+{
+    return get_unix_socket_name(get_handle(), UnixSocketNameKind::PEER, ec);
+}
+
+UnixSocket::UnixSocket(SOCKET handle, bool non_blocking) : StreamSocket(handle, non_blocking)
+{
+}
+
+} // namespace ds
@@ -0,0 +1,138 @@
+#include "DirtySocks/UnixSocketAddress.hpp"
+
+#include "DirtySocks/ErrorCodes.hpp"
+#include "DirtySocks/System.hpp"
+
+#include "UnixSocketName.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace ds
+{
+
+namespace
+{
+
+static constexpr auto PATH_OFFSET = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path));
+
+} // namespace
+
+UnixSocketAddress::UnixSocketAddress(const sockaddr& addr, socklen_t addr_len) : UnixSocketAddress()
+{
+    _addr_len = std::clamp(addr_len, PATH_OFFSET, static_cast<socklen_t>(sizeof(_addr)));
+    std::memcpy(&_addr, &addr, static_cast<std::size_t>(_addr_len));
+    _addr.sun_family = AF_UNIX;
+}
+
+UnixSocketAddress::UnixSocketAddress() noexcept : _addr{}, _addr_len(PATH_OFFSET)
+{
+    _addr.sun_family = AF_UNIX;
+}
+
+auto UnixSocketAddress::from_path(std::string_view path, std::error_code& ec) -> std::optional<UnixSocketAddress>
+{
+    ec.clear();
+
+    if (path.empty() || path.find('\0') != std::string_view::npos)
+    {
+        ec = SystemErrc::invalid_argument;
+        return std::nullopt;
+    }
+
+    UnixSocketAddress result;
+
+    // leave room for the null terminator
+    if (path.size() >= sizeof(result._addr.sun_path))
+    {
+        ec = SystemErrc::filename_too_long;
+        return std::nullopt;
+    }
+
+    std::memcpy(result._addr.sun_path, path.data(), path.size());
+    result._addr_len = static_cast<socklen_t>(PATH_OFFSET + path.size() + 1);
+    return result;
+}
+
+auto UnixSocketAddress::from_abstract_name(std::string_view name, std::error_code& ec)
+    -> std::optional<UnixSocketAddress>
+{
+    ec.clear();
+
+#ifdef __linux__
+    UnixSocketAddress result;
+
+    // leave room for the leading null character
+    if (name.size() >= sizeof(result._addr.sun_path))
+    {
+        ec = SystemErrc::filename_too_long;
+        return std::nullopt;
+    }
+
+    // abstract names are not null-terminated, and its length is determined by `addr_len`
+    result._addr.sun_path[0] = '\0';
+    std::memcpy(result._addr.sun_path + 1, name.data(), name.size());
+    result._addr_len = static_cast<socklen_t>(PATH_OFFSET + 1 + name.size());
+    return result;
+#else
+    (void)name;
+    ec = SystemErrc::address_family_not_supported;
+    return std::nullopt;
+#endif
+}
+
+bool UnixSocketAddress::is_unnamed() const
+{
+    return _addr_len <= PATH_OFFSET;
+}
+
+bool UnixSocketAddress::is_abstract() const
+{
+    return !is_unnamed() && '\0' == _addr.sun_path[0];
+}
+
+auto UnixSocketAddress::get_path() const -> std::string
+{
+    if (is_unnamed())
+        return std::string();
+
+    const std::size_t length = static_cast<std::size_t>(_addr_len - PATH_OFFSET);
+    if (is_abstract())
+        return std::string(_addr.sun_path + 1, length - 1);
+
+    // filesystem path might or might not include the null terminator in `addr_len`
+    return std::string(_addr.sun_path, strnlen(_addr.sun_path, length));
+}
+
+auto UnixSocketAddress::get_sockaddr() const -> const sockaddr&
+{
+    return reinterpret_cast<const sockaddr&>(_addr);
+}
+
+auto UnixSocketAddress::get_sockaddr_len() const -> socklen_t
+{
+    return _addr_len;
+}
+
+auto get_unix_socket_name(SOCKET handle, UnixSocketNameKind kind, std::error_code& ec)
+    -> std::optional<UnixSocketAddress>
+{
+    ec.clear();
+
+    sockaddr_un addr;
+    socklen_t addr_len = sizeof(addr);
+
+    const auto ret = (UnixSocketNameKind::PEER == kind)
+                         ? ::getpeername(handle, reinterpret_cast<sockaddr*>(&addr), &addr_len)
+                         : ::getsockname(handle, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+    if (SOCKET_ERROR == ret)
+    {
+        ec = System::get_last_error_code();
+        return std::nullopt;
+    }
+
+    return UnixSocketAddress(reinterpret_cast<const sockaddr&>(addr), addr_len);
+}
+
+} // namespace ds
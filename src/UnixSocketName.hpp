@@ -0,0 +1,22 @@
+#pragma once
+
+#include "DirtySocks/PlatformSocket.hpp"
+
+#include "DirtySocks/UnixSocketAddress.hpp"
+
+#include <optional>
+#include <system_error>
+
+namespace ds
+{
+
+enum class UnixSocketNameKind
+{
+    LOCAL, // `getsockname()`
+    PEER,  // `getpeername()`
+};
+
+// shared by `UnixSocket`, `UnixListener` & `UnixDatagramSocket`
+auto get_unix_socket_name(SOCKET, UnixSocketNameKind, std::error_code&) -> std::optional<UnixSocketAddress>;
+
+} // namespace ds
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ds::tools
+{
+
+/// @brief HDR-style log-linear histogram of nanoseconds.
+///
+/// Each power of two range is split into 128 linear sub-buckets, so any recorded value is off by less than 1%,
+/// and recording is a few bit operations, no matter how large the value is.
+class LatencyHistogram final
+{
+public:
+    LatencyHistogram() : _counts(bucket_index(UINT64_MAX) + 1, 0)
+    {
+    }
+
+public:
+    void record(std::uint64_t value)
+    {
+        ++_counts[bucket_index(value)];
+        ++_total_count;
+        _max = std::max(_max, value);
+        _min = std::min(_min, value);
+    }
+
+    void merge(const LatencyHistogram& other)
+    {
+        for (std::size_t i = 0; i < _counts.size(); ++i)
+            _counts[i] += other._counts[i];
+        _total_count += other._total_count;
+        _max = std::max(_max, other._max);
+        _min = std::min(_min, other._min);
+    }
+
+    /// @param percentile `0.0` ~ `100.0`
+    /// @return upper bound of the bucket the percentile falls into
+    auto get_percentile(double percentile) const -> std::uint64_t
+    {
+        if (0 == _total_count)
+            return 0;
+
+        const auto target = static_cast<std::uint64_t>(percentile / 100.0 * static_cast<double>(_total_count) + 0.5);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < _counts.size(); ++i)
+        {
+            seen += _counts[i];
+            if (seen >= std::max<std::uint64_t>(target, 1))
+                return std::min(bucket_upper_bound(i), _max);
+        }
+        return _max;
+    }
+
+    auto get_total_count() const -> std::uint64_t
+    {
+        return _total_count;
+    }
+
+    auto get_max() const -> std::uint64_t
+    {
+        return _max;
+    }
+
+    auto get_min() const -> std::uint64_t
+    {
+        return 0 == _total_count ? 0 : _min;
+    }
+
+private:
+    static constexpr unsigned SUB_BUCKET_BITS = 7;
+    static constexpr std::uint64_t SUB_BUCKET_COUNT = 1u << SUB_BUCKET_BITS;
+
+    static auto bucket_index(std::uint64_t value) -> std::size_t
+    {
+        const unsigned width = static_cast<unsigned>(std::bit_width(value));
+        if (width <= SUB_BUCKET_BITS + 1)
+            return static_cast<std::size_t>(value);
+
+        const unsigned shift = width - (SUB_BUCKET_BITS + 1);
+        return static_cast<std::size_t>((shift + 1) * SUB_BUCKET_COUNT + ((value >> shift) - SUB_BUCKET_COUNT));
+    }
+
+    static auto bucket_upper_bound(std::size_t index) -> std::uint64_t
+    {
+        if (index < 2 * SUB_BUCKET_COUNT)
+            return index;
+
+        const unsigned shift = static_cast<unsigned>(index / SUB_BUCKET_COUNT - 1);
+        const std::uint64_t mantissa = index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+private:
+    std::vector<std::uint64_t> _counts;
+    std::uint64_t _total_count = 0;
+    std::uint64_t _max = 0;
+    std::uint64_t _min = UINT64_MAX;
+};
+
+} // namespace ds::tools
@@ -0,0 +1,264 @@
+// Round-trip latency over loopback with the spin-then-block selector & busy polling, against the plain blocking wait
+//
+// A ping thread and an echo thread bounce a small message back and forth, pausing `--interval` between pings
+// so the echo thread goes idle in between, like a feed with gaps. Each run measures every round trip; the first one
+// blocks right away, and the second one spins for `--spin` before blocking (and sets `--busy-poll`, if non-zero).
+//
+// Spinning only helps while the spinner has a CPU of its own, so run it on at least 2 idle CPUs.
+//
+// usage: ds_busy_poll_bench [--count 100000] [--interval 50] [--spin 200] [--busy-poll 0] [--size 64]
+
+#include "LatencyHistogram.hpp"
+
+#include <DirtySocks/ErrorCodes.hpp>
+#include <DirtySocks/ErrorConditions.hpp>
+#include <DirtySocks/SocketAddress.hpp>
+#include <DirtySocks/SocketSelector.hpp>
+#include <DirtySocks/SpinStats.hpp>
+#include <DirtySocks/System.hpp>
+#include <DirtySocks/TcpListener.hpp>
+#include <DirtySocks/TcpSocket.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    std::uint64_t count = 100'000;
+    std::chrono::microseconds interval{50}; // between a response and the next ping
+    std::chrono::microseconds spin{200};
+    std::chrono::microseconds busy_poll{0};
+    std::size_t size = 64;
+};
+
+void print_usage()
+{
+    std::cerr << "usage: ds_busy_poll_bench [--count 100000] [--interval 50] [--spin 200] [--busy-poll 0] [--size 64]"
+              << std::endl;
+}
+
+bool parse_options(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc)
+            return false;
+
+        const std::string_view value = argv[++i];
+        if (arg == "--count")
+            options.count = static_cast<std::uint64_t>(std::atoll(value.data()));
+        else if (arg == "--interval")
+            options.interval = std::chrono::microseconds(std::atoll(value.data()));
+        else if (arg == "--spin")
+            options.spin = std::chrono::microseconds(std::atoll(value.data()));
+        else if (arg == "--busy-poll")
+            options.busy_poll = std::chrono::microseconds(std::atoll(value.data()));
+        else if (arg == "--size")
+            options.size = static_cast<std::size_t>(std::atoll(value.data()));
+        else
+            return false;
+    }
+
+    return options.count > 0 && options.size > 0;
+}
+
+/// @brief Wait until `socket` is readable, then receive exactly `message.size()` bytes.
+bool receive_message(ds::SocketSelector& selector, ds::TcpSocket& socket, std::vector<std::byte>& message,
+                     std::error_code& ec)
+{
+    std::size_t filled = 0;
+    while (filled < message.size())
+    {
+        selector.select(nullptr, ec);
+        if (ec)
+            return false;
+
+        std::size_t received_length;
+        socket.receive(message.data() + filled, message.size() - filled, received_length, ec);
+        if (ec == ds::SocketErrc::WOULD_BLOCK)
+        {
+            ec.clear();
+            continue;
+        }
+        if (!ec && 0 == received_length)
+            ec = ds::StreamErrc::END_OF_STREAM;
+        if (ec)
+            return false;
+
+        filled += received_length;
+    }
+    return true;
+}
+
+struct RunResult
+{
+    ds::tools::LatencyHistogram histogram;
+    ds::SpinStats ping_stats;
+    ds::SpinStats echo_stats;
+};
+
+bool run(const Options& options, std::chrono::microseconds spin, std::chrono::microseconds busy_poll,
+         RunResult& result, std::error_code& ec)
+{
+    ds::TcpListener listener;
+    listener.listen(ds::SocketAddress(127, 0, 0, 1, 0), SOMAXCONN, ds::SocketOptions().no_delay(), ec);
+    const auto address = listener.get_local_address(ec);
+    if (ec || !address)
+    {
+        std::cerr << "listen: " << ec.message() << std::endl;
+        return false;
+    }
+
+    ds::TcpSocket ping;
+    ds::TcpSocket echo;
+    ping.connect(*address, ds::SocketOptions().no_delay(), ec);
+    if (!ec)
+        listener.accept(echo, ec);
+    if (ec)
+    {
+        std::cerr << "connect: " << ec.message() << std::endl;
+        return false;
+    }
+
+    ds::SocketSelector ping_selector;
+    ds::SocketSelector echo_selector;
+    for (auto [socket, selector] : {std::pair{&ping, &ping_selector}, std::pair{&echo, &echo_selector}})
+    {
+        socket->set_non_blocking(true, ec);
+        if (!ec)
+            selector->add_to_read_set(*socket, ec);
+        if (ec)
+        {
+            std::cerr << "select: " << ec.message() << std::endl;
+            return false;
+        }
+
+        selector->set_spin_duration(spin);
+
+        if (0 != busy_poll.count())
+        {
+            std::error_code busy_poll_ec;
+            socket->set_busy_poll(busy_poll, true, busy_poll_ec);
+            if (busy_poll_ec)
+                std::cerr << "busy poll (ignored): " << busy_poll_ec.message() << std::endl;
+        }
+    }
+
+    std::error_code echo_ec;
+    std::thread echo_thread([&] {
+        std::vector<std::byte> message(options.size);
+        for (std::uint64_t i = 0; i < options.count; ++i)
+        {
+            if (!receive_message(echo_selector, echo, message, echo_ec))
+                break;
+
+            // a message this small always fits the empty send buffer
+            echo.send(message.data(), message.size(), echo_ec);
+            if (echo_ec)
+                break;
+        }
+
+        // unblock the ping side, if this side failed
+        if (echo_ec)
+            echo.close();
+    });
+
+    std::vector<std::byte> message(options.size);
+    for (std::uint64_t i = 0; i < options.count && !ec; ++i)
+    {
+        // busy-wait the gap, as sleeping is much coarser than it
+        const Clock::time_point next = Clock::now() + options.interval;
+        while (Clock::now() < next)
+        {
+        }
+
+        const Clock::time_point start = Clock::now();
+        ping.send(message.data(), message.size(), ec);
+        if (!ec && receive_message(ping_selector, ping, message, ec))
+            result.histogram.record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+    }
+
+    // unblock the echo thread, if the ping side failed
+    if (ec)
+        ping.close();
+    echo_thread.join();
+
+    result.ping_stats = ping_selector.get_spin_stats();
+    result.echo_stats = echo_selector.get_spin_stats();
+
+    if (ec || echo_ec)
+    {
+        std::cerr << "ping: " << (echo_ec ? echo_ec : ec).message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void print_result(std::string_view title, const RunResult& result)
+{
+    auto us = [](std::uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+    std::cout << title << "\n";
+    std::cout << "  round trip (us):\n";
+    std::cout << std::format("    min     {:.1f}\n", us(result.histogram.get_min()));
+    for (double percentile : {50.0, 90.0, 99.0, 99.9})
+        std::cout << std::format("    p{:<6} {:.1f}\n", percentile, us(result.histogram.get_percentile(percentile)));
+    std::cout << std::format("    max     {:.1f}\n", us(result.histogram.get_max()));
+
+    for (auto [side, stats] : {std::pair{"ping", &result.ping_stats}, std::pair{"echo", &result.echo_stats}})
+        std::cout << std::format("  {} selector: {} spin polls, {} spin wake-ups, {} blocking waits\n", side,
+                                 stats->spin_polls, stats->spin_wakeups, stats->blocking_waits);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage();
+        return 1;
+    }
+
+    std::error_code ec;
+    ds::System::init(ec);
+    if (ec)
+    {
+        std::cerr << "init: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    RunResult blocking;
+    RunResult spinning;
+    const bool ok = run(options, std::chrono::microseconds(0), std::chrono::microseconds(0), blocking, ec) &&
+                    run(options, options.spin, options.busy_poll, spinning, ec);
+
+    if (ok)
+    {
+        print_result("blocking:", blocking);
+        print_result(std::format("spinning {} us, busy poll {} us:", options.spin.count(), options.busy_poll.count()),
+                     spinning);
+        std::cout << std::format("p99 improvement: {:.1f} us\n",
+                                 (static_cast<double>(blocking.histogram.get_percentile(99.0)) -
+                                  static_cast<double>(spinning.histogram.get_percentile(99.0))) /
+                                     1000.0);
+    }
+
+    ds::System::destroy();
+    return ok ? 0 : 2;
+}
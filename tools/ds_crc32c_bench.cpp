@@ -0,0 +1,74 @@
+// Throughput of `ds::Crc32c` against its portable (table-driven) fallback
+//
+// usage: ds_crc32c_bench [--megabytes 1024]
+//
+// The same 1 MiB is checksummed over and over, to measure the CRC itself rather than the memory bandwidth.
+
+#include <DirtySocks/Crc32c.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t DATA_LENGTH = 1024 * 1024;
+
+template <typename Compute>
+void run(const char* name, const std::vector<unsigned char>& data, std::size_t passes, std::size_t frame_length,
+         Compute&& compute)
+{
+    std::uint32_t sink = 0;
+
+    const auto start = Clock::now();
+    for (std::size_t pass = 0; pass < passes; ++pass)
+        for (std::size_t offset = 0; offset + frame_length <= data.size(); offset += frame_length)
+            sink += compute(data.data() + offset, frame_length);
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const double total_length = static_cast<double>(passes * data.size());
+    std::cout << "  " << name << ": " << total_length / seconds / (1024.0 * 1024.0 * 1024.0) << " GiB/s (" << sink
+              << ")" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::size_t megabytes = 1024;
+    for (int i = 1; i + 1 < argc; i += 2)
+        if (std::string_view(argv[i]) == "--megabytes")
+            megabytes = static_cast<std::size_t>(std::atoll(argv[i + 1]));
+
+    std::vector<unsigned char> data(DATA_LENGTH);
+    std::mt19937 rng(42);
+    for (auto& byte : data)
+        byte = static_cast<unsigned char>(rng());
+
+    std::cout << "implementation: " << ds::Crc32c::get_implementation() << std::endl;
+
+    // check the hardware one against the portable one, before timing them
+    for (std::size_t length : {0, 1, 7, 8, 9, 63, 3071, 3072, 3073, 100'000})
+    {
+        if (ds::Crc32c::compute(data.data() + 1, length) != ds::Crc32c::compute_portable(data.data() + 1, length))
+        {
+            std::cerr << "MISMATCH at length " << length << std::endl;
+            return 1;
+        }
+    }
+
+    for (std::size_t frame_length : {64, 1024, 16 * 1024, 1024 * 1024})
+    {
+        std::cout << "frame length " << frame_length << ":" << std::endl;
+        run("Crc32c::compute", data, megabytes, frame_length, ds::Crc32c::compute);
+        run("Crc32c::compute_portable", data, megabytes, frame_length, ds::Crc32c::compute_portable);
+    }
+}
@@ -0,0 +1,198 @@
+// Echo server for `ds_loadgen`
+//
+// Runs a thread-per-core `ds::Runtime`: each loop has its own reuse-port listener and its own connections.
+//
+// usage: ds_echo_server [--port 23457] [--ipv6] [--loops 1]  (`--loops 0` for every available CPU)
+
+#include <DirtySocks/ConnectionTable.hpp>
+#include <DirtySocks/ErrorConditions.hpp>
+#include <DirtySocks/EventLoop.hpp>
+#include <DirtySocks/Runtime.hpp>
+#include <DirtySocks/SocketAddress.hpp>
+#include <DirtySocks/System.hpp>
+#include <DirtySocks/TcpSocket.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct Client
+{
+    std::vector<char> pending; // echo bytes that would block
+    std::size_t pending_offset = 0;
+};
+
+void log_error_and_exit(std::string_view what, const std::error_code& ec)
+{
+    std::cerr << what << ": [" << ec.value() << "] " << ec.message() << std::endl;
+    std::exit(1);
+}
+
+// the connections of one `ds::EventLoop`
+class EchoLoop
+{
+public:
+    explicit EchoLoop(ds::EventLoop& loop)
+        : _loop(loop), _selector(loop.get_selector()), _buffer(64 * 1024, loop.get_memory_resource())
+    {
+    }
+
+    void handle(const ds::PollSelector::Ready& ready)
+    {
+        std::error_code ec;
+
+        // accept all pending connections
+        if (ds::EventLoop::LISTENER_TOKEN == ready.token)
+        {
+            while (true)
+            {
+                ds::TcpSocket socket;
+                _loop.get_listener().accept(socket, ec);
+                if (ec)
+                    break;
+
+                const ds::ConnectionHandle handle = _clients.insert(std::move(socket), Client{});
+                _selector.add(*_clients.get_socket(handle), ds::PollInterest::READ, handle.to_token(), ec);
+                if (ec)
+                {
+                    std::cerr << "add client: " << ec.message() << std::endl;
+                    _clients.erase(handle);
+                }
+            }
+            return;
+        }
+
+        const auto handle = ds::ConnectionHandle::from_token(ready.token);
+        ds::TcpSocket* socket = _clients.get_socket(handle);
+        if (!socket)
+            return; // stale event of a closed client
+        Client& client = *_clients.get_state(handle);
+
+        if (ready.write)
+        {
+            std::size_t sent_length;
+            socket->send_all(client.pending.data() + client.pending_offset,
+                             client.pending.size() - client.pending_offset, sent_length, ec);
+            client.pending_offset += sent_length;
+            if (!ec)
+            {
+                // flushed, resume reading
+                client.pending.clear();
+                client.pending_offset = 0;
+                _selector.add(*socket, ds::PollInterest::READ, handle.to_token(), ec);
+                _selector.remove_from_write_set(*socket);
+            }
+            else if (ec != ds::SocketErrc::WOULD_BLOCK)
+                close_client(handle, *socket);
+        }
+        else if (ready.read)
+        {
+            std::size_t received_length;
+            socket->receive(_buffer.data(), _buffer.size(), received_length, ec);
+            if (ec == ds::SocketErrc::WOULD_BLOCK)
+                return;
+            if (ec || 0 == received_length)
+            {
+                close_client(handle, *socket);
+                return;
+            }
+
+            std::size_t sent_length;
+            socket->send_all(_buffer.data(), received_length, sent_length, ec);
+            if (ec == ds::SocketErrc::WOULD_BLOCK)
+            {
+                // stop reading until the echo is flushed
+                client.pending.assign(_buffer.data() + sent_length, _buffer.data() + received_length);
+                _selector.add(*socket, ds::PollInterest::WRITE, handle.to_token(), ec);
+                _selector.remove_from_read_set(*socket);
+            }
+            else if (ec)
+                close_client(handle, *socket);
+        }
+    }
+
+private:
+    void close_client(ds::ConnectionHandle handle, ds::TcpSocket& socket)
+    {
+        _selector.remove(socket);
+        _clients.erase(handle);
+    }
+
+private:
+    ds::EventLoop& _loop;
+    ds::PollSelector& _selector;
+
+    ds::ConnectionTable<Client> _clients;
+    std::pmr::vector<char> _buffer;
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::uint16_t port = 23457;
+    ds::IpVersion ip_version = ds::IpVersion::V4;
+    std::size_t loops_count = 1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--port" && i + 1 < argc)
+            port = static_cast<std::uint16_t>(std::atoi(argv[++i]));
+        else if (arg == "--ipv6")
+            ip_version = ds::IpVersion::V6;
+        else if (arg == "--loops" && i + 1 < argc)
+            loops_count = static_cast<std::size_t>(std::atoi(argv[++i]));
+        else
+        {
+            std::cerr << "usage: ds_echo_server [--port 23457] [--ipv6] [--loops 1]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::error_code ec;
+    ds::System::init(ec);
+    if (ec)
+        log_error_and_exit("init", ec);
+
+    ds::RuntimeConfig config;
+    config.listen_address = ds::SocketAddress::any(port, ip_version);
+    config.cpus = ds::Runtime::get_available_cpus();
+    if (0 != loops_count && loops_count < config.cpus.size())
+        config.cpus.resize(loops_count);
+
+    // created by each loop's own thread, so its memory is local to that loop's CPU
+    std::vector<std::unique_ptr<EchoLoop>> echo_loops(config.cpus.size());
+
+    ds::Runtime runtime;
+    runtime.start(
+        config,
+        [&](ds::EventLoop& loop) {
+            auto& echo_loop = echo_loops[loop.get_index()];
+            echo_loop = std::make_unique<EchoLoop>(loop);
+            loop.set_event_handler(
+                [&echo_loop = *echo_loop](ds::EventLoop&, const ds::PollSelector::Ready& ready) {
+                    echo_loop.handle(ready);
+                });
+        },
+        ec);
+    if (ec)
+        log_error_and_exit("start", ec);
+
+    std::cout << "Echo server listening on port " << port << " with " << runtime.get_loops_count() << " loop(s)"
+              << std::endl;
+
+    // the loops run until the process is killed
+    while (true)
+        std::this_thread::sleep_for(std::chrono::hours(1));
+}
@@ -0,0 +1,138 @@
+// Microbenchmark of `ds::DelimiterFramer` against `memchr()` and a naive loop
+//
+// usage: ds_framer_bench [--delimiter lf|crlf|crlfcrlf] [--frame-size 200] [--megabytes 256]
+
+#include <DirtySocks/DelimiterFramer.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// reads arrive in pieces of this, so frames straddle the reads
+constexpr std::size_t READ_LENGTH = 1460;
+
+auto make_stream(std::string_view delimiter, std::size_t frame_size, std::size_t total_length) -> std::string
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> printable(' ', '~');
+
+    std::string stream;
+    stream.reserve(total_length + frame_size);
+    while (stream.size() < total_length)
+    {
+        for (std::size_t i = 0; i < frame_size; ++i)
+            stream.push_back(static_cast<char>(printable(rng)));
+        stream += delimiter;
+    }
+    return stream;
+}
+
+template <typename Split>
+void run(const char* name, const std::string& stream, Split&& split)
+{
+    const auto start = Clock::now();
+    const std::size_t frames = split(stream);
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << name << ": " << frames << " frames, "
+              << static_cast<double>(stream.size()) / seconds / (1024.0 * 1024.0 * 1024.0) << " GiB/s" << std::endl;
+}
+
+// splitting `stream` as if it's received in `READ_LENGTH` pieces, rescanning nothing
+template <typename FindDelimiterEnd>
+auto split_stream(const std::string& stream, std::vector<char>& received, std::string_view delimiter,
+                  FindDelimiterEnd&& find_delimiter_end) -> std::size_t
+{
+    // copy into a receive buffer like `DelimiterFramer::feed()` does, to compare the same work
+
+    std::size_t frames = 0;
+    std::size_t begin = 0;
+    std::size_t scan = 0;
+    for (std::size_t end = std::min(READ_LENGTH, stream.size());; end = std::min(end + READ_LENGTH, stream.size()))
+    {
+        std::memcpy(received.data() + scan, stream.data() + scan, end - scan);
+        while (true)
+        {
+            const std::size_t found = find_delimiter_end(received.data(), scan, end, delimiter.back());
+            if (found == end)
+            {
+                scan = end;
+                break;
+            }
+            scan = found + 1;
+            if (scan - begin >= delimiter.size() &&
+                0 == std::memcmp(received.data() + scan - delimiter.size(), delimiter.data(), delimiter.size()))
+            {
+                ++frames;
+                begin = scan;
+            }
+        }
+        if (end == stream.size())
+            break;
+    }
+    return frames;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string delimiter = "\n";
+    std::size_t frame_size = 200;
+    std::size_t megabytes = 256;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string_view arg = argv[i];
+        const std::string_view value = argv[i + 1];
+        if (arg == "--delimiter")
+            delimiter = (value == "crlfcrlf") ? "\r\n\r\n" : (value == "crlf") ? "\r\n" : "\n";
+        else if (arg == "--frame-size")
+            frame_size = static_cast<std::size_t>(std::atoll(argv[i + 1]));
+        else if (arg == "--megabytes")
+            megabytes = static_cast<std::size_t>(std::atoll(argv[i + 1]));
+    }
+
+    const std::string stream = make_stream(delimiter, frame_size, megabytes * 1024 * 1024);
+    std::vector<char> received(stream.size(), 0); // touched beforehand, not to time the page faults
+    std::cout << "scan implementation: " << ds::DelimiterFramer::get_scan_implementation() << std::endl;
+
+    auto naive_find = [](const char* data, std::size_t first, std::size_t last, char byte) {
+        for (; first != last; ++first)
+            if (data[first] == byte)
+                return first;
+        return last;
+    };
+    auto memchr_find = [](const char* data, std::size_t first, std::size_t last, char byte) {
+        const void* found = std::memchr(data + first, byte, last - first);
+        return (found) ? static_cast<std::size_t>(static_cast<const char*>(found) - data) : last;
+    };
+
+    run("naive loop", stream, [&](const std::string& s) { return split_stream(s, received, delimiter, naive_find); });
+    run("memchr", stream, [&](const std::string& s) { return split_stream(s, received, delimiter, memchr_find); });
+
+    run("DelimiterFramer", stream, [&](const std::string& s) {
+        ds::DelimiterFramer framer(delimiter);
+        std::error_code ec;
+        std::size_t frames = 0;
+        for (std::size_t offset = 0; offset < s.size(); offset += READ_LENGTH)
+        {
+            framer.feed(s.data() + offset, std::min(READ_LENGTH, s.size() - offset));
+            while (framer.next_frame(ec))
+                ++frames;
+        }
+        return frames;
+    });
+}
@@ -0,0 +1,339 @@
+// Open-loop load generator for DirtySocks
+//
+// Sends fixed-size requests at a fixed total rate over many connections, and measures the latency of each echo.
+// Latency counts from the time a request was *scheduled*, not when it was actually sent,
+// so a stalled server can't hide its stall by slowing down the generator (no coordinated omission).
+//
+// usage: ds_loadgen [--host 127.0.0.1] [--port 23457] [--connections 100] [--rate 10000]
+//                   [--duration 10] [--size 64]
+
+#include "LatencyHistogram.hpp"
+
+#include <DirtySocks/ErrorCodes.hpp>
+#include <DirtySocks/ErrorConditions.hpp>
+#include <DirtySocks/PollSelector.hpp>
+#include <DirtySocks/SocketAddress.hpp>
+#include <DirtySocks/System.hpp>
+#include <DirtySocks/TcpSocket.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    std::string host = "127.0.0.1";
+    std::string port = "23457";
+    std::size_t connections = 100;
+    double rate = 10000.0; // requests per second, over all connections
+    double duration = 10.0; // seconds
+    std::size_t size = 64;  // bytes per request
+};
+
+// request frame: [scheduled time (ns)][sequence number][padding...]
+constexpr std::size_t FRAME_HEADER_SIZE = 2 * sizeof(std::uint64_t);
+
+struct Connection
+{
+    ds::TcpSocket socket;
+    bool connected = false;
+    bool failed = false;
+
+    std::vector<char> tx;
+    std::size_t tx_offset = 0;
+
+    std::vector<char> rx;
+    std::size_t rx_filled = 0;
+
+    std::uint64_t outstanding = 0;
+};
+
+void print_usage()
+{
+    std::cerr << "usage: ds_loadgen [--host 127.0.0.1] [--port 23457] [--connections 100] [--rate 10000]\n"
+                 "                  [--duration 10] [--size 64]"
+              << std::endl;
+}
+
+bool parse_options(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc)
+            return false;
+
+        const char* value = argv[++i];
+        if (arg == "--host")
+            options.host = value;
+        else if (arg == "--port")
+            options.port = value;
+        else if (arg == "--connections")
+            options.connections = static_cast<std::size_t>(std::atoll(value));
+        else if (arg == "--rate")
+            options.rate = std::atof(value);
+        else if (arg == "--duration")
+            options.duration = std::atof(value);
+        else if (arg == "--size")
+            options.size = static_cast<std::size_t>(std::atoll(value));
+        else
+            return false;
+    }
+
+    return options.connections > 0 && options.rate > 0 && options.duration > 0 && options.size >= FRAME_HEADER_SIZE;
+}
+
+auto to_timeval(Clock::duration duration) -> timeval
+{
+    const auto us = std::max<std::int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+
+    timeval result;
+    result.tv_sec = static_cast<decltype(result.tv_sec)>(us / 1'000'000);
+    result.tv_usec = static_cast<decltype(result.tv_usec)>(us % 1'000'000);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage();
+        return 1;
+    }
+
+    std::error_code ec;
+    ds::System::init(ec);
+    if (ec)
+    {
+        std::cerr << "init: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    auto addr = ds::SocketAddress::resolve(options.host, options.port, ds::IpVersion::BOTH, ec);
+    if (ec || !addr)
+    {
+        std::cerr << "resolve: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    ds::PollSelector selector;
+
+    // non-blocking connects, all at once
+    std::vector<std::unique_ptr<Connection>> connections;
+    std::uint64_t failed_connections = 0;
+    for (std::size_t i = 0; i < options.connections; ++i)
+    {
+        auto conn = std::make_unique<Connection>();
+        conn->rx.resize(options.size);
+
+        conn->socket.set_non_blocking(true, ec);
+        conn->socket.connect(*addr, ec);
+        if (ec && ec != ds::SystemErrc::operation_in_progress && ec != ds::SocketErrc::WOULD_BLOCK)
+        {
+            std::cerr << "connect: " << ec.message() << std::endl;
+            conn->failed = true;
+            ++failed_connections;
+        }
+        else
+        {
+            selector.add_to_write_set(conn->socket, ec);
+            if (ec)
+            {
+                std::cerr << "add connection: " << ec.message() << std::endl;
+                conn->failed = true;
+                ++failed_connections;
+            }
+        }
+        connections.push_back(std::move(conn));
+    }
+
+    const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.rate));
+    const auto total_requests = static_cast<std::uint64_t>(options.rate * options.duration);
+    const auto grace_period = std::chrono::seconds(5);
+
+    ds::tools::LatencyHistogram histogram;
+    std::uint64_t scheduled = 0;
+    std::uint64_t completed = 0;
+    std::uint64_t outstanding = 0;
+    std::uint64_t dropped = 0; // requests scheduled on failed connections, including those outstanding when they failed
+
+    const auto start = Clock::now();
+    const auto issue_end = start + interval * total_requests;
+
+    // its outstanding requests will never be answered, so they're dropped rather than left to time out
+    auto fail = [&](Connection& conn) {
+        conn.failed = true;
+        ++failed_connections;
+        selector.remove(conn.socket);
+
+        dropped += conn.outstanding;
+        outstanding -= conn.outstanding;
+        conn.outstanding = 0;
+        conn.tx.clear();
+        conn.tx_offset = 0;
+    };
+
+    auto flush = [&](Connection& conn) {
+        if (!conn.connected || conn.failed || conn.tx_offset == conn.tx.size())
+            return;
+
+        std::size_t sent_length;
+        conn.socket.send_all(conn.tx.data() + conn.tx_offset, conn.tx.size() - conn.tx_offset, sent_length, ec);
+        conn.tx_offset += sent_length;
+
+        if (ec == ds::SocketErrc::WOULD_BLOCK)
+        {
+            selector.add_to_write_set(conn.socket, ec);
+            return;
+        }
+        if (ec)
+        {
+            fail(conn);
+            return;
+        }
+
+        conn.tx.clear();
+        conn.tx_offset = 0;
+        selector.remove_from_write_set(conn.socket);
+    };
+
+    while (true)
+    {
+        auto now = Clock::now();
+
+        // issue every request whose scheduled time has come, whether or not the previous ones were answered
+        while (scheduled < total_requests && start + interval * scheduled <= now)
+        {
+            Connection& conn = *connections[scheduled % connections.size()];
+            if (conn.failed)
+            {
+                ++dropped;
+                ++scheduled;
+                continue;
+            }
+
+            const std::uint64_t scheduled_ns =
+                std::chrono::duration_cast<std::chrono::nanoseconds>((start + interval * scheduled).time_since_epoch())
+                    .count();
+
+            const std::size_t offset = conn.tx.size();
+            conn.tx.resize(offset + options.size);
+            std::memcpy(conn.tx.data() + offset, &scheduled_ns, sizeof(scheduled_ns));
+            std::memcpy(conn.tx.data() + offset + sizeof(scheduled_ns), &scheduled, sizeof(scheduled));
+
+            ++conn.outstanding;
+            ++outstanding;
+            ++scheduled;
+        }
+
+        for (auto& conn : connections)
+            flush(*conn);
+
+        if (scheduled == total_requests && (0 == outstanding || now > issue_end + grace_period))
+            break;
+
+        const auto next_deadline =
+            (scheduled < total_requests) ? start + interval * scheduled : issue_end + grace_period;
+        timeval timeout = to_timeval(next_deadline - now);
+
+        selector.select(&timeout, ec);
+        if (ec)
+        {
+            std::cerr << "select: " << ec.message() << std::endl;
+            return 1;
+        }
+
+        for (auto& conn_ptr : connections)
+        {
+            Connection& conn = *conn_ptr;
+            if (conn.failed)
+                continue;
+
+            if (!conn.connected && selector.has_write(conn.socket))
+            {
+                // connected if it has a peer now
+                conn.socket.get_remote_address(ec);
+                selector.remove_from_write_set(conn.socket);
+                if (ec)
+                {
+                    fail(conn);
+                    continue;
+                }
+
+                conn.connected = true;
+                selector.add_to_read_set(conn.socket, ec);
+                flush(conn);
+                continue;
+            }
+
+            if (selector.has_write(conn.socket))
+                flush(conn);
+
+            if (conn.failed || !selector.has_read(conn.socket))
+                continue;
+
+            while (true)
+            {
+                std::size_t received_length;
+                conn.socket.receive(conn.rx.data() + conn.rx_filled, conn.rx.size() - conn.rx_filled,
+                                    received_length, ec);
+                if (ec == ds::SocketErrc::WOULD_BLOCK)
+                    break;
+                if (ec || 0 == received_length)
+                {
+                    fail(conn);
+                    break;
+                }
+
+                conn.rx_filled += received_length;
+                if (conn.rx_filled < conn.rx.size())
+                    continue;
+
+                std::uint64_t scheduled_ns;
+                std::memcpy(&scheduled_ns, conn.rx.data(), sizeof(scheduled_ns));
+                const std::uint64_t now_ns =
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+                histogram.record(now_ns - scheduled_ns);
+
+                conn.rx_filled = 0;
+                --conn.outstanding;
+                --outstanding;
+                ++completed;
+            }
+        }
+    }
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    auto us = [](std::uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+    std::cout << std::format("connections: {} ({} failed)\n", connections.size(), failed_connections);
+    std::cout << std::format("requests:    {} scheduled, {} completed, {} timed out, {} dropped\n", scheduled,
+                             completed, outstanding, dropped);
+    std::cout << std::format("throughput:  {:.1f} req/s (target {:.1f} req/s)\n",
+                             static_cast<double>(completed) / elapsed, options.rate);
+    std::cout << "latency (us):\n";
+    std::cout << std::format("  min     {:.1f}\n", us(histogram.get_min()));
+    for (double percentile : {50.0, 90.0, 99.0, 99.9, 99.99})
+        std::cout << std::format("  p{:<6} {:.1f}\n", percentile, us(histogram.get_percentile(percentile)));
+    std::cout << std::format("  max     {:.1f}\n", us(histogram.get_max()));
+
+    ds::System::destroy();
+    return (0 == outstanding && 0 == failed_connections) ? 0 : 2;
+}
@@ -0,0 +1,188 @@
+// Loopback check of `ds::UdpSocket`'s multicast: one socket joins a group, another sends to it
+//
+// The sender sets its multicast options before it's bound, which is where Windows can't tell the socket's family
+// from `getsockname()`.
+// Pass the loopback's interface index (`1` on Linux) on hosts without a multicast route.
+//
+// usage: ds_multicast_check [--group 239.255.0.1] [--interface 0] [--count 10]
+
+#include <DirtySocks/ErrorConditions.hpp>
+#include <DirtySocks/SocketAddress.hpp>
+#include <DirtySocks/System.hpp>
+#include <DirtySocks/UdpSocket.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto RECEIVE_TIMEOUT = std::chrono::seconds(1);
+
+struct Options
+{
+    std::array<std::uint8_t, 4> group = {239, 255, 0, 1};
+    std::uint32_t interface_index = 0;
+    int count = 10;
+};
+
+bool parse_group(std::string_view text, std::array<std::uint8_t, 4>& group)
+{
+    unsigned octets[4];
+    char tail;
+    if (4 != std::sscanf(std::string(text).c_str(), "%u.%u.%u.%u%c", &octets[0], &octets[1], &octets[2], &octets[3],
+                         &tail))
+        return false;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (octets[i] > 255)
+            return false;
+        group[i] = static_cast<std::uint8_t>(octets[i]);
+    }
+    return group[0] >= 224 && group[0] <= 239;
+}
+
+bool parse_options(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string_view name = argv[i];
+        if (name == "--group")
+        {
+            if (!parse_group(argv[i + 1], options.group))
+                return false;
+        }
+        else if (name == "--interface")
+            options.interface_index = static_cast<std::uint32_t>(std::atol(argv[i + 1]));
+        else if (name == "--count")
+            options.count = std::atoi(argv[i + 1]);
+        else
+            return false;
+    }
+    return 1 == argc % 2 && options.count > 0;
+}
+
+bool fail(std::string_view what, const std::error_code& ec)
+{
+    std::cerr << what << ": " << ec.message() << std::endl;
+    return false;
+}
+
+/// @brief Receive one datagram, or time out.
+bool receive(ds::UdpSocket& socket, char* data, std::size_t data_length, std::size_t& received_length,
+             ds::SocketAddress& sender, std::error_code& ec)
+{
+    const Clock::time_point deadline = Clock::now() + RECEIVE_TIMEOUT;
+    for (;;)
+    {
+        socket.receive_from(data, data_length, received_length, sender, ec);
+        if (ec != ds::SocketErrc::WOULD_BLOCK)
+            return !ec;
+        if (Clock::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool run(const Options& options)
+{
+    std::error_code ec;
+    const auto& g = options.group;
+    const ds::SocketAddress group(g[0], g[1], g[2], g[3], 0);
+
+    ds::UdpSocket receiver;
+    receiver.open(ds::IpVersion::V4, ec);
+    if (!ec)
+        receiver.set_reuse_address(true, ec);
+    if (!ec)
+        receiver.bind(ds::SocketAddress(0, 0, 0, 0, 0), ec);
+    if (!ec)
+        receiver.join_group(group, options.interface_index, ec);
+    if (!ec)
+        receiver.set_non_blocking(true, ec);
+    const auto receiver_address = ec ? std::nullopt : receiver.get_local_address(ec);
+    if (ec || !receiver_address)
+        return fail("receiver", ec);
+
+    // options before `bind()`, on a socket that's only open
+    ds::UdpSocket sender;
+    sender.open(ds::IpVersion::V4, ec);
+    if (!ec)
+        sender.set_multicast_ttl(0, ec);
+    if (!ec)
+        sender.set_multicast_loopback(true, ec);
+    if (!ec && 0 != options.interface_index)
+        sender.set_multicast_interface(options.interface_index, ec);
+    if (!ec)
+        sender.bind(ds::SocketAddress(0, 0, 0, 0, 0), ec);
+    if (ec)
+        return fail("sender", ec);
+
+    const ds::SocketAddress destination(g[0], g[1], g[2], g[3], receiver_address->get_port());
+    const auto sender_address = sender.get_local_address(ec);
+    if (ec || !sender_address)
+        return fail("sender address", ec);
+
+    for (int i = 0; i < options.count; ++i)
+    {
+        const std::string message = std::format("multicast {}", i);
+        std::size_t length;
+        sender.send_to(message.data(), message.size(), destination, length, ec);
+        if (ec)
+            return fail("send", ec);
+
+        char data[64];
+        ds::SocketAddress from(0, 0, 0, 0, 0);
+        if (!receive(receiver, data, sizeof(data), length, from, ec))
+            return ec ? fail("receive", ec) : fail("receive", std::make_error_code(std::errc::timed_out));
+        if (std::string_view(data, length) != message || from.get_port() != sender_address->get_port())
+        {
+            std::cerr << "received a mismatching datagram" << std::endl;
+            return false;
+        }
+    }
+
+    receiver.leave_group(group, options.interface_index, ec);
+    if (ec)
+        return fail("leave", ec);
+
+    std::cout << std::format("{} datagrams looped back through {}.{}.{}.{}\n", options.count, +g[0], +g[1], +g[2],
+                             +g[3]);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        std::cerr << "usage: ds_multicast_check [--group 239.255.0.1] [--interface 0] [--count 10]" << std::endl;
+        return 1;
+    }
+
+    std::error_code ec;
+    ds::System::init(ec);
+    if (ec)
+    {
+        std::cerr << "init: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    const bool ok = run(options);
+
+    ds::System::destroy();
+    return ok ? 0 : 2;
+}
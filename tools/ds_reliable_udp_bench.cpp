@@ -0,0 +1,513 @@
+// Latency of a ReliablePeer channel under packet loss, against TCP
+//
+// Sends timestamped messages at a fixed rate to itself over loopback, and measures the one-way latency of each one
+// from its *scheduled* send time, so a message held up behind a lost one counts all of its wait.
+//
+// With UDP, `--loss` drops that fraction of the datagrams in each direction, right before they'd be sent.
+// To put both transports under the same loss instead, use netem (Linux, as root) with `--loss 0`:
+//
+//     tc qdisc add dev lo root netem loss 2%
+//     ...
+//     tc qdisc del dev lo root
+//
+// usage: ds_reliable_udp_bench [--transport udp|tcp] [--channel reliable|sequenced|unreliable] [--rate 1000]
+//                              [--duration 10] [--size 64] [--loss 0]
+
+#include "LatencyHistogram.hpp"
+
+#include <DirtySocks/ErrorCodes.hpp>
+#include <DirtySocks/ErrorConditions.hpp>
+#include <DirtySocks/PollSelector.hpp>
+#include <DirtySocks/ReliablePeer.hpp>
+#include <DirtySocks/SocketAddress.hpp>
+#include <DirtySocks/System.hpp>
+#include <DirtySocks/TcpListener.hpp>
+#include <DirtySocks/TcpSocket.hpp>
+#include <DirtySocks/UdpSocket.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    bool tcp = false;
+    std::size_t channel = 0; // of the default `ReliablePeerConfig`
+    double rate = 1000.0;    // messages per second
+    double duration = 10.0;  // seconds
+    std::size_t size = 64;   // bytes per message
+    double loss = 0.0;       // fraction of dropped datagrams, UDP only
+};
+
+// message: [scheduled time (ns)][sequence number][padding...]
+constexpr std::size_t MESSAGE_HEADER_SIZE = 2 * sizeof(std::uint64_t);
+
+const auto GRACE_PERIOD = std::chrono::seconds(3);
+
+void print_usage()
+{
+    std::cerr << "usage: ds_reliable_udp_bench [--transport udp|tcp] [--channel reliable|sequenced|unreliable]\n"
+                 "                             [--rate 1000] [--duration 10] [--size 64] [--loss 0]"
+              << std::endl;
+}
+
+bool parse_options(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc)
+            return false;
+
+        const std::string_view value = argv[++i];
+        if (arg == "--transport" && (value == "udp" || value == "tcp"))
+            options.tcp = (value == "tcp");
+        else if (arg == "--channel" && value == "reliable")
+            options.channel = 0;
+        else if (arg == "--channel" && value == "sequenced")
+            options.channel = 1;
+        else if (arg == "--channel" && value == "unreliable")
+            options.channel = 2;
+        else if (arg == "--rate")
+            options.rate = std::atof(value.data());
+        else if (arg == "--duration")
+            options.duration = std::atof(value.data());
+        else if (arg == "--size")
+            options.size = static_cast<std::size_t>(std::atoll(value.data()));
+        else if (arg == "--loss")
+            options.loss = std::atof(value.data());
+        else
+            return false;
+    }
+
+    return options.rate > 0 && options.duration > 0 && options.size >= MESSAGE_HEADER_SIZE &&
+           options.loss >= 0 && options.loss < 1 && !(options.tcp && options.loss > 0);
+}
+
+auto to_timeval(Clock::duration duration) -> timeval
+{
+    const auto us = std::max<std::int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+
+    timeval result;
+    result.tv_sec = static_cast<decltype(result.tv_sec)>(us / 1'000'000);
+    result.tv_usec = static_cast<decltype(result.tv_usec)>(us % 1'000'000);
+    return result;
+}
+
+auto to_ns(Clock::time_point time) -> std::uint64_t
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+/// @brief Fixed-rate schedule of messages.
+class Schedule
+{
+public:
+    explicit Schedule(const Options& options)
+        : _interval(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.rate))),
+          _total(static_cast<std::uint64_t>(options.rate * options.duration)), _size(options.size)
+    {
+    }
+
+    /// @return `false` if no message is due yet; `advance()` once it's sent
+    auto next(Clock::time_point now, std::vector<std::byte>& message) -> bool
+    {
+        if (_issued == _total || get_scheduled_time(_issued) > now)
+            return false;
+
+        message.assign(_size, std::byte{0});
+        const std::uint64_t scheduled_ns = to_ns(get_scheduled_time(_issued));
+        std::memcpy(message.data(), &scheduled_ns, sizeof(scheduled_ns));
+        std::memcpy(message.data() + sizeof(scheduled_ns), &_issued, sizeof(_issued));
+        return true;
+    }
+
+    // `next()` was sent
+    void advance()
+    {
+        if (++_issued == _total)
+            _done_time = Clock::now();
+    }
+
+    /// @return when the next message is due, or the run is over once all of them were issued
+    auto get_deadline() const -> Clock::time_point
+    {
+        return (_issued < _total) ? get_scheduled_time(_issued) : get_grace_end();
+    }
+
+    /// @brief Counted from the last message actually issued, which a full window may hold back past the schedule.
+    auto get_grace_end() const -> Clock::time_point
+    {
+        return _done_time + GRACE_PERIOD;
+    }
+
+    bool is_done() const
+    {
+        return _issued == _total;
+    }
+
+    auto get_issued() const -> std::uint64_t
+    {
+        return _issued;
+    }
+
+private:
+    auto get_scheduled_time(std::uint64_t index) const -> Clock::time_point
+    {
+        return _start + _interval * static_cast<Clock::rep>(index);
+    }
+
+private:
+    const Clock::time_point _start = Clock::now();
+    const Clock::duration _interval;
+    const std::uint64_t _total;
+    const std::size_t _size;
+    std::uint64_t _issued = 0;
+    Clock::time_point _done_time = _start;
+};
+
+void record_latency(std::span<const std::byte> message, ds::tools::LatencyHistogram& histogram)
+{
+    std::uint64_t scheduled_ns;
+    std::memcpy(&scheduled_ns, message.data(), sizeof(scheduled_ns));
+    histogram.record(to_ns(Clock::now()) - scheduled_ns);
+}
+
+bool run_udp(const Options& options, ds::tools::LatencyHistogram& histogram, std::error_code& ec)
+{
+    const ds::SocketAddress loopback(127, 0, 0, 1, 0);
+
+    ds::UdpSocket sender;
+    ds::UdpSocket receiver;
+    for (ds::UdpSocket* socket : {&sender, &receiver})
+    {
+        socket->set_non_blocking(true, ec);
+        socket->bind(loopback, ec);
+        if (ec)
+        {
+            std::cerr << "bind: " << ec.message() << std::endl;
+            return false;
+        }
+    }
+
+    const auto sender_address = sender.get_local_address(ec);
+    const auto receiver_address = receiver.get_local_address(ec);
+    if (ec || !sender_address || !receiver_address)
+    {
+        std::cerr << "local address: " << ec.message() << std::endl;
+        return false;
+    }
+    sender.connect(*receiver_address, ec);
+    if (!ec)
+        receiver.connect(*sender_address, ec);
+    if (ec)
+    {
+        std::cerr << "connect: " << ec.message() << std::endl;
+        return false;
+    }
+
+    ds::PollSelector selector;
+    selector.add_to_read_set(sender, ec);
+    if (!ec)
+        selector.add_to_read_set(receiver, ec);
+    if (ec)
+    {
+        std::cerr << "select: " << ec.message() << std::endl;
+        return false;
+    }
+
+    ds::ReliablePeer sender_peer;
+    ds::ReliablePeer receiver_peer;
+
+    std::uint64_t delivered = 0;
+    receiver_peer.set_message_handler([&](std::size_t, std::span<const std::byte> message) {
+        record_latency(message, histogram);
+        ++delivered;
+    });
+
+    std::mt19937_64 random(42);
+    std::bernoulli_distribution drop(options.loss);
+    std::vector<std::byte> packet(ds::ReliablePeerConfig{}.max_packet_length);
+    std::uint64_t dropped_packets = 0;
+
+    // `ReliablePeer::flush()`, but dropping some
+    auto pump = [&](ds::ReliablePeer& peer, ds::UdpSocket& socket, Clock::time_point now) {
+        std::size_t packet_length;
+        while (peer.write_packet(packet, packet_length, now))
+        {
+            if (drop(random))
+            {
+                ++dropped_packets;
+                continue;
+            }
+
+            std::size_t sent_length;
+            socket.send(packet.data(), packet_length, sent_length, ec);
+            if (ec == ds::SocketErrc::WOULD_BLOCK)
+                ec.clear();
+            if (ec)
+                return;
+        }
+    };
+
+    auto drain = [&](ds::ReliablePeer& peer, ds::UdpSocket& socket) {
+        while (true)
+        {
+            std::size_t received_length;
+            socket.receive(packet.data(), packet.size(), received_length, ec);
+            if (ec == ds::SocketErrc::WOULD_BLOCK)
+            {
+                ec.clear();
+                return;
+            }
+            if (ec)
+                return;
+
+            // a malformed packet can't come from loopback
+            peer.read_packet(std::span(packet.data(), received_length), Clock::now(), ec);
+            if (ec)
+                return;
+        }
+    };
+
+    Schedule schedule(options);
+
+    std::vector<std::byte> message;
+    while (true)
+    {
+        auto now = Clock::now();
+
+        // a full window holds the schedule back, so the wait still counts towards the latency
+        bool window_full = false;
+        while (schedule.next(now, message))
+        {
+            sender_peer.send(options.channel, message, ec);
+            if (ec == ds::SystemErrc::no_buffer_space)
+            {
+                ec.clear();
+                window_full = true;
+                break;
+            }
+            if (ec)
+            {
+                std::cerr << "send: " << ec.message() << std::endl;
+                return false;
+            }
+            schedule.advance();
+        }
+
+        pump(sender_peer, sender, now);
+        if (ec)
+        {
+            std::cerr << "send: " << ec.message() << std::endl;
+            return false;
+        }
+
+        // lost unreliable messages just run out the grace period
+        if (schedule.is_done() && (delivered == schedule.get_issued() || now > schedule.get_grace_end()))
+            break;
+
+        // with the window full, the overdue message waits for acks or resends, rather than spinning
+        auto deadline = window_full ? now + GRACE_PERIOD : schedule.get_deadline();
+        if (const auto resend_time = sender_peer.get_resend_time())
+            deadline = std::min(deadline, *resend_time);
+
+        timeval timeout = to_timeval(deadline - now);
+        selector.select(&timeout, ec);
+        if (ec)
+        {
+            std::cerr << "select: " << ec.message() << std::endl;
+            return false;
+        }
+
+        if (selector.has_read(receiver))
+        {
+            drain(receiver_peer, receiver);
+            pump(receiver_peer, receiver, Clock::now()); // acks
+        }
+        if (selector.has_read(sender))
+            drain(sender_peer, sender);
+        if (ec)
+        {
+            std::cerr << "receive: " << ec.message() << std::endl;
+            return false;
+        }
+    }
+
+    const ds::ReliablePeerStats& stats = sender_peer.get_stats();
+    std::cout << std::format("messages:    {} sent, {} delivered\n", schedule.get_issued(), delivered);
+    std::cout << std::format("packets:     {} sent, {} dropped, {} detected lost, {} messages resent\n",
+                             stats.packets_sent, dropped_packets, stats.packets_lost, stats.messages_resent);
+    std::cout << std::format("rtt:         {:.1f} us (rto {:.1f} us)\n",
+                             std::chrono::duration<double, std::micro>(sender_peer.get_rtt()).count(),
+                             std::chrono::duration<double, std::micro>(sender_peer.get_rto()).count());
+    return true;
+}
+
+bool run_tcp(const Options& options, ds::tools::LatencyHistogram& histogram, std::error_code& ec)
+{
+    ds::TcpListener listener;
+    listener.listen(ds::SocketAddress(127, 0, 0, 1, 0), ec);
+    const auto address = listener.get_local_address(ec);
+    if (ec || !address)
+    {
+        std::cerr << "listen: " << ec.message() << std::endl;
+        return false;
+    }
+
+    ds::TcpSocket sender;
+    ds::TcpSocket receiver;
+    sender.connect(*address, ds::SocketOptions().no_delay(), ec);
+    if (!ec)
+        listener.accept(receiver, ec);
+    if (!ec)
+        sender.set_non_blocking(true, ec);
+    if (!ec)
+        receiver.set_non_blocking(true, ec);
+    if (ec)
+    {
+        std::cerr << "connect: " << ec.message() << std::endl;
+        return false;
+    }
+
+    ds::PollSelector selector;
+    selector.add_to_read_set(receiver, ec);
+    if (ec)
+    {
+        std::cerr << "select: " << ec.message() << std::endl;
+        return false;
+    }
+
+    std::vector<std::byte> tx;
+    std::size_t tx_offset = 0;
+    std::vector<std::byte> rx(options.size);
+    std::size_t rx_filled = 0;
+    std::uint64_t delivered = 0;
+
+    Schedule schedule(options);
+    std::vector<std::byte> message;
+    while (true)
+    {
+        auto now = Clock::now();
+
+        while (schedule.next(now, message))
+        {
+            tx.insert(tx.end(), message.begin(), message.end());
+            schedule.advance();
+        }
+
+        if (tx_offset < tx.size())
+        {
+            std::size_t sent_length;
+            sender.send(tx.data() + tx_offset, tx.size() - tx_offset, sent_length, ec);
+            if (ec == ds::SocketErrc::WOULD_BLOCK)
+                ec.clear();
+            else if (ec)
+            {
+                std::cerr << "send: " << ec.message() << std::endl;
+                return false;
+            }
+            else
+                tx_offset += sent_length;
+
+            if (tx_offset == tx.size())
+            {
+                tx.clear();
+                tx_offset = 0;
+                selector.remove_from_write_set(sender);
+            }
+            else
+                selector.add_to_write_set(sender, ec);
+        }
+
+        if (schedule.is_done() && (delivered == schedule.get_issued() || now > schedule.get_grace_end()))
+            break;
+
+        timeval timeout = to_timeval(schedule.get_deadline() - now);
+        selector.select(&timeout, ec);
+        if (ec)
+        {
+            std::cerr << "select: " << ec.message() << std::endl;
+            return false;
+        }
+
+        if (!selector.has_read(receiver))
+            continue;
+
+        while (true)
+        {
+            std::size_t received_length;
+            receiver.receive(rx.data() + rx_filled, rx.size() - rx_filled, received_length, ec);
+            if (ec == ds::SocketErrc::WOULD_BLOCK)
+            {
+                ec.clear();
+                break;
+            }
+            if (ec || 0 == received_length)
+            {
+                std::cerr << "receive: " << ec.message() << std::endl;
+                return false;
+            }
+
+            rx_filled += received_length;
+            if (rx_filled < rx.size())
+                continue;
+
+            record_latency(rx, histogram);
+            ++delivered;
+            rx_filled = 0;
+        }
+    }
+
+    std::cout << std::format("messages:    {} sent, {} delivered\n", schedule.get_issued(), delivered);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage();
+        return 1;
+    }
+
+    std::error_code ec;
+    ds::System::init(ec);
+    if (ec)
+    {
+        std::cerr << "init: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    ds::tools::LatencyHistogram histogram;
+    const bool ok = options.tcp ? run_tcp(options, histogram, ec) : run_udp(options, histogram, ec);
+
+    auto us = [](std::uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+    std::cout << "latency (us):\n";
+    std::cout << std::format("  min     {:.1f}\n", us(histogram.get_min()));
+    for (double percentile : {50.0, 90.0, 99.0, 99.9, 99.99})
+        std::cout << std::format("  p{:<6} {:.1f}\n", percentile, us(histogram.get_percentile(percentile)));
+    std::cout << std::format("  max     {:.1f}\n", us(histogram.get_max()));
+
+    ds::System::destroy();
+    return ok ? 0 : 2;
+}
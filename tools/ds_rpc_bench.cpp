@@ -0,0 +1,431 @@
+// Calls per second & latency of RpcConnection calls pipelined over one connection, against a connection per call
+//
+// An echo server runs on its own thread over loopback. With `--mode pipelined`, a single connection keeps `--depth`
+// calls outstanding; with `--mode per-call`, `--depth` threads each connect, call once, and close, over and over,
+// like services without a way to match responses to requests on a shared connection.
+//
+// usage: ds_rpc_bench [--mode pipelined|per-call] [--calls 100000] [--depth 64] [--size 64]
+
+#include "LatencyHistogram.hpp"
+
+#include <DirtySocks/ConnectionTable.hpp>
+#include <DirtySocks/ErrorCodes.hpp>
+#include <DirtySocks/ErrorConditions.hpp>
+#include <DirtySocks/PollSelector.hpp>
+#include <DirtySocks/RpcConnection.hpp>
+#include <DirtySocks/SocketAddress.hpp>
+#include <DirtySocks/System.hpp>
+#include <DirtySocks/TcpListener.hpp>
+#include <DirtySocks/TcpSocket.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    bool pipelined = true;
+    std::uint64_t calls = 100'000;
+    std::size_t depth = 64; // outstanding calls
+    std::size_t size = 64;  // payload bytes of each request & response
+};
+
+constexpr std::uint16_t ECHO_METHOD = 1;
+constexpr std::uint64_t LISTENER_TOKEN = 0; // no `ConnectionHandle` is `0`
+
+const auto CALL_TIMEOUT = std::chrono::seconds(5);
+
+void print_usage()
+{
+    std::cerr << "usage: ds_rpc_bench [--mode pipelined|per-call] [--calls 100000] [--depth 64] [--size 64]"
+              << std::endl;
+}
+
+bool parse_options(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc)
+            return false;
+
+        const std::string_view value = argv[++i];
+        if (arg == "--mode" && (value == "pipelined" || value == "per-call"))
+            options.pipelined = (value == "pipelined");
+        else if (arg == "--calls")
+            options.calls = static_cast<std::uint64_t>(std::atoll(value.data()));
+        else if (arg == "--depth")
+            options.depth = static_cast<std::size_t>(std::atoll(value.data()));
+        else if (arg == "--size")
+            options.size = static_cast<std::size_t>(std::atoll(value.data()));
+        else
+            return false;
+    }
+
+    return options.calls > 0 && options.depth > 0;
+}
+
+auto to_ns(Clock::duration duration) -> std::uint64_t
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+/// @brief Echoes every call back, on its own thread.
+class EchoServer
+{
+public:
+    bool start(std::error_code& ec)
+    {
+        _listener.listen(ds::SocketAddress(127, 0, 0, 1, 0), SOMAXCONN, ds::SocketOptions().no_delay(), ec);
+        if (!ec)
+            _listener.set_non_blocking(true, ec);
+        if (!ec)
+            _selector.add(_listener, ds::PollInterest::READ, LISTENER_TOKEN, ec);
+        if (!ec)
+            _address = _listener.get_local_address(ec);
+        if (ec || !_address)
+            return false;
+
+        _thread = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop()
+    {
+        _stopping.store(true, std::memory_order_relaxed);
+        _thread.join();
+    }
+
+    auto get_address() const -> const ds::SocketAddress&
+    {
+        return *_address;
+    }
+
+    auto get_accepted_count() const -> std::uint64_t
+    {
+        return _accepted_count;
+    }
+
+private:
+    void run()
+    {
+        while (!_stopping.load(std::memory_order_relaxed))
+        {
+            std::error_code ec;
+            timeval timeout{0, 50'000};
+            _selector.select(&timeout, ec);
+            if (ec)
+            {
+                std::cerr << "server select: " << ec.message() << std::endl;
+                return;
+            }
+
+            _selector.for_each_ready([this](const ds::PollSelector::Ready& ready) {
+                if (LISTENER_TOKEN == ready.token)
+                    accept_all();
+                else
+                    serve(ds::ConnectionHandle::from_token(ready.token), ready);
+            });
+        }
+    }
+
+    void accept_all()
+    {
+        while (true)
+        {
+            std::error_code ec;
+            ds::TcpSocket socket;
+            _listener.accept(socket, ec);
+            if (ec)
+                return;
+
+            ds::RpcConnection connection;
+            connection.set_request_handler([](ds::RpcConnection& conn, const ds::RpcRequest& request) {
+                std::error_code respond_ec;
+                conn.respond(request.stream_id, request.payload, respond_ec);
+            });
+
+            const ds::ConnectionHandle handle = _connections.insert(std::move(socket), std::move(connection));
+            _selector.add(*_connections.get_socket(handle), ds::PollInterest::READ, handle.to_token(), ec);
+            ++_accepted_count;
+        }
+    }
+
+    void serve(ds::ConnectionHandle handle, const ds::PollSelector::Ready& ready)
+    {
+        ds::TcpSocket* socket = _connections.get_socket(handle);
+        ds::RpcConnection* connection = _connections.get_state(handle);
+        if (!socket)
+            return;
+
+        std::error_code ec;
+        if (ready.read || ready.except)
+        {
+            std::size_t received_length;
+            connection->receive_from(*socket, received_length, Clock::now(), ec);
+            if (ec == ds::SocketErrc::WOULD_BLOCK)
+                ec.clear();
+            else if (!ec && 0 == received_length)
+                ec = ds::StreamErrc::END_OF_STREAM;
+        }
+
+        // every response of this batch in one send
+        std::size_t sent_length;
+        if (!ec)
+            connection->flush(*socket, sent_length, ec);
+        if (!ec && 0 != connection->get_send_buffered_length())
+            _selector.add_to_write_set(*socket, ec);
+        else if (!ec)
+            _selector.remove_from_write_set(*socket);
+
+        if (ec)
+        {
+            _selector.remove(*socket);
+            _connections.erase(handle);
+        }
+    }
+
+private:
+    ds::TcpListener _listener;
+    std::optional<ds::SocketAddress> _address;
+    ds::PollSelector _selector;
+    ds::ConnectionTable<ds::RpcConnection> _connections;
+    std::uint64_t _accepted_count = 0;
+
+    std::atomic<bool> _stopping{false};
+    std::thread _thread;
+};
+
+struct Result
+{
+    std::uint64_t completed = 0;
+    std::uint64_t failed = 0;
+};
+
+bool run_pipelined(const Options& options, const ds::SocketAddress& address, ds::tools::LatencyHistogram& histogram,
+                   Result& result, std::error_code& ec)
+{
+    ds::TcpSocket socket;
+    socket.connect(address, ds::SocketOptions().no_delay(), ec);
+    if (!ec)
+        socket.set_non_blocking(true, ec);
+    if (ec)
+    {
+        std::cerr << "connect: " << ec.message() << std::endl;
+        return false;
+    }
+
+    ds::PollSelector selector;
+    selector.add_to_read_set(socket, ec);
+    if (ec)
+    {
+        std::cerr << "select: " << ec.message() << std::endl;
+        return false;
+    }
+
+    ds::RpcConnection connection;
+    const std::vector<std::byte> payload(options.size);
+    std::uint64_t issued = 0;
+
+    // each completion issues the next call right away, keeping `depth` outstanding
+    std::function<void()> issue = [&] {
+        const Clock::time_point start = Clock::now();
+        connection.call(
+            ECHO_METHOD, payload, start + CALL_TIMEOUT, start,
+            [&, start](const ds::RpcResponse& response) {
+                if (response.ec || 0 != response.status)
+                    ++result.failed;
+                else
+                {
+                    histogram.record(to_ns(Clock::now() - start));
+                    ++result.completed;
+                }
+
+                if (issued < options.calls)
+                    issue();
+            },
+            ec);
+        if (!ec)
+            ++issued;
+    };
+
+    for (std::size_t i = 0; i < options.depth && issued < options.calls; ++i)
+        issue();
+
+    while (result.completed + result.failed < options.calls && !ec)
+    {
+        std::size_t sent_length;
+        connection.flush(socket, sent_length, ec);
+        if (ec)
+            break;
+        if (0 != connection.get_send_buffered_length())
+            selector.add_to_write_set(socket, ec);
+        else
+            selector.remove_from_write_set(socket);
+
+        timeval timeout{0, 100'000};
+        selector.select(&timeout, ec);
+        if (ec)
+            break;
+
+        if (selector.has_read(socket))
+        {
+            std::size_t received_length;
+            connection.receive_from(socket, received_length, Clock::now(), ec);
+            if (ec == ds::SocketErrc::WOULD_BLOCK)
+                ec.clear();
+            else if (!ec && 0 == received_length)
+                ec = ds::StreamErrc::END_OF_STREAM;
+        }
+
+        connection.expire(Clock::now());
+    }
+
+    if (ec)
+    {
+        std::cerr << "call: " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool run_per_call(const Options& options, const ds::SocketAddress& address, ds::tools::LatencyHistogram& histogram,
+                  Result& result, std::error_code& ec)
+{
+    std::mutex mutex;
+    std::atomic<std::uint64_t> next_call{0};
+
+    auto worker = [&] {
+        ds::tools::LatencyHistogram local_histogram;
+        Result local_result;
+        std::error_code worker_ec;
+
+        const std::vector<std::byte> payload(options.size);
+        while (next_call.fetch_add(1, std::memory_order_relaxed) < options.calls)
+        {
+            const Clock::time_point start = Clock::now();
+
+            // blocking all the way, as each connection carries a single call
+            ds::TcpSocket socket;
+            socket.connect(address, ds::SocketOptions().no_delay(), worker_ec);
+            if (worker_ec)
+                break;
+
+            ds::RpcConnection connection;
+            bool done = false;
+            connection.call(
+                ECHO_METHOD, payload, start + CALL_TIMEOUT, start,
+                [&](const ds::RpcResponse& response) {
+                    done = true;
+                    if (response.ec || 0 != response.status)
+                        ++local_result.failed;
+                    else
+                    {
+                        local_histogram.record(to_ns(Clock::now() - start));
+                        ++local_result.completed;
+                    }
+                },
+                worker_ec);
+
+            std::size_t length;
+            if (!worker_ec)
+                connection.flush(socket, length, worker_ec);
+            while (!worker_ec && !done)
+            {
+                connection.receive_from(socket, length, Clock::now(), worker_ec);
+                if (!worker_ec && 0 == length)
+                    worker_ec = ds::StreamErrc::END_OF_STREAM;
+            }
+            if (worker_ec)
+                break;
+        }
+
+        std::lock_guard lock(mutex);
+        histogram.merge(local_histogram);
+        result.completed += local_result.completed;
+        result.failed += local_result.failed;
+        if (worker_ec && !ec)
+            ec = worker_ec;
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < options.depth; ++i)
+        threads.emplace_back(worker);
+    for (std::thread& thread : threads)
+        thread.join();
+
+    if (ec)
+    {
+        std::cerr << "call: " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        print_usage();
+        return 1;
+    }
+
+    std::error_code ec;
+    ds::System::init(ec);
+    if (ec)
+    {
+        std::cerr << "init: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    EchoServer server;
+    if (!server.start(ec))
+    {
+        std::cerr << "listen: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    ds::tools::LatencyHistogram histogram;
+    Result result;
+
+    const Clock::time_point start = Clock::now();
+    const bool ok = options.pipelined ? run_pipelined(options, server.get_address(), histogram, result, ec)
+                                      : run_per_call(options, server.get_address(), histogram, result, ec);
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    server.stop();
+
+    auto us = [](std::uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+    std::cout << std::format("calls:       {} completed, {} failed, in {:.2f} s ({:.0f} calls/s)\n",
+                             result.completed, result.failed, elapsed,
+                             static_cast<double>(result.completed) / elapsed);
+    std::cout << std::format("connections: {}\n", server.get_accepted_count());
+    std::cout << "latency (us):\n";
+    std::cout << std::format("  min     {:.1f}\n", us(histogram.get_min()));
+    for (double percentile : {50.0, 90.0, 99.0, 99.9})
+        std::cout << std::format("  p{:<6} {:.1f}\n", percentile, us(histogram.get_percentile(percentile)));
+    std::cout << std::format("  max     {:.1f}\n", us(histogram.get_max()));
+
+    ds::System::destroy();
+    return ok ? 0 : 2;
+}
@@ -0,0 +1,151 @@
+// Per-call overhead of `ds::BasicSocket` against `ds::TcpSocket` and the raw syscalls
+//
+// Over a loopback TCP pair, it times:
+// * a receive from the empty non-blocking socket, the cheapest syscall there is, so the wrapper's share shows the most
+// * a 1-byte send & receive round, closer to a real hot loop
+//
+// usage: ds_socket_call_bench [--calls 2000000]
+
+#include <DirtySocks/BasicSocket.hpp>
+#include <DirtySocks/ErrorConditions.hpp>
+#include <DirtySocks/SocketAddress.hpp>
+#include <DirtySocks/System.hpp>
+#include <DirtySocks/TcpListener.hpp>
+#include <DirtySocks/TcpSocket.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <string_view>
+#include <system_error>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+using FastSocket = ds::BasicSocket<ds::BlockingMode::NON_BLOCKING, ds::TcpProtocol>;
+
+bool make_pair(ds::TcpSocket& client, ds::TcpSocket& server, std::error_code& ec)
+{
+    ds::TcpListener listener;
+    listener.listen(ds::SocketAddress(127, 0, 0, 1, 0), ec);
+    const auto address = listener.get_local_address(ec);
+    if (ec || !address)
+        return false;
+
+    client.connect(*address, ds::SocketOptions().no_delay(), ec);
+    if (!ec)
+        listener.accept(server, ec);
+    if (!ec)
+        client.set_non_blocking(true, ec);
+    if (!ec)
+        server.set_non_blocking(true, ec);
+    return !ec;
+}
+
+/// @return nanoseconds per call of `func`, which returns `false` on an unexpected result
+template <typename Func>
+auto measure(std::uint64_t calls, Func&& func) -> double
+{
+    const Clock::time_point start = Clock::now();
+    for (std::uint64_t i = 0; i < calls; ++i)
+    {
+        if (!func())
+        {
+            std::cerr << "unexpected result" << std::endl;
+            std::exit(2);
+        }
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(calls);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::uint64_t calls = 2'000'000;
+    if (3 == argc && std::string_view(argv[1]) == "--calls")
+    {
+        // a negative count would wrap around to a huge one
+        const long long value = std::atoll(argv[2]);
+        calls = (value > 0) ? static_cast<std::uint64_t>(value) : 0;
+    }
+    else if (1 != argc)
+        calls = 0;
+
+    if (0 == calls)
+    {
+        std::cerr << "usage: ds_socket_call_bench [--calls 2000000]" << std::endl;
+        return 1;
+    }
+
+    std::error_code ec;
+    ds::System::init(ec);
+    if (ec)
+    {
+        std::cerr << "init: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    // one pair each, as `BasicSocket` takes its handles over
+    ds::TcpSocket raw_client, raw_server;
+    ds::TcpSocket tcp_client, tcp_server;
+    ds::TcpSocket fast_client_source, fast_server_source;
+    if (!make_pair(raw_client, raw_server, ec) || !make_pair(tcp_client, tcp_server, ec) ||
+        !make_pair(fast_client_source, fast_server_source, ec))
+    {
+        std::cerr << "connect: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    FastSocket fast_client = FastSocket::adopt(fast_client_source.release(), ec);
+    FastSocket fast_server = FastSocket::adopt(fast_server_source.release(), ec);
+    if (ec)
+    {
+        std::cerr << "adopt: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    char byte = 0;
+    std::size_t length;
+
+    // the raw calls set `errno` and the like, but never an error code
+    const double raw_empty = measure(calls, [&] {
+        return ::recv(raw_server.get_handle(), &byte, 1, 0) < 0;
+    });
+    const double tcp_empty = measure(calls, [&] {
+        tcp_server.receive(&byte, 1, length, ec);
+        return ec == ds::SocketErrc::WOULD_BLOCK;
+    });
+    const double fast_empty = measure(calls, [&] {
+        fast_server.receive(&byte, 1, length, ec);
+        return ec == ds::SocketErrc::WOULD_BLOCK;
+    });
+
+    // loopback delivers within the send, so the receive always finds the byte
+    const double raw_round = measure(calls, [&] {
+        return 1 == ::send(raw_client.get_handle(), &byte, 1, 0) && 1 == ::recv(raw_server.get_handle(), &byte, 1, 0);
+    });
+    const double tcp_round = measure(calls, [&] {
+        tcp_client.send(&byte, 1, length, ec);
+        if (!ec)
+            tcp_server.receive(&byte, 1, length, ec);
+        return !ec && 1 == length;
+    });
+    const double fast_round = measure(calls, [&] {
+        fast_client.send(&byte, 1, length, ec);
+        if (!ec)
+            fast_server.receive(&byte, 1, length, ec);
+        return !ec && 1 == length;
+    });
+
+    std::cout << std::format("{:<12} {:>20} {:>20}\n", "ns per call", "empty receive", "1-byte send+receive");
+    std::cout << std::format("{:<12} {:>20.1f} {:>20.1f}\n", "raw syscall", raw_empty, raw_round);
+    std::cout << std::format("{:<12} {:>20.1f} {:>20.1f}\n", "TcpSocket", tcp_empty, tcp_round);
+    std::cout << std::format("{:<12} {:>20.1f} {:>20.1f}\n", "BasicSocket", fast_empty, fast_round);
+
+    ds::System::destroy();
+    return 0;
+}
@@ -0,0 +1,218 @@
+// Round-trip latency of a `ds::UnixSocket` connection, against loopback TCP
+//
+// A ping thread and an echo thread bounce a small message back and forth over blocking sockets,
+// first over a Unix domain socket in the temp directory, then over a `127.0.0.1` TCP connection.
+// Unix sockets skip the TCP/IP stack, so they're expected to take about half of the loopback TCP round trip.
+//
+// usage: ds_unix_latency_bench [--count 100000] [--size 64]
+
+#include "LatencyHistogram.hpp"
+
+#include <DirtySocks/SocketAddress.hpp>
+#include <DirtySocks/System.hpp>
+#include <DirtySocks/TcpListener.hpp>
+#include <DirtySocks/TcpSocket.hpp>
+#include <DirtySocks/UnixListener.hpp>
+#include <DirtySocks/UnixSocket.hpp>
+#include <DirtySocks/UnixSocketAddress.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    std::uint64_t count = 100'000;
+    std::size_t size = 64;
+};
+
+bool parse_options(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc)
+            return false;
+
+        const std::string_view value = argv[++i];
+        if (arg == "--count")
+            options.count = static_cast<std::uint64_t>(std::atoll(value.data()));
+        else if (arg == "--size")
+            options.size = static_cast<std::size_t>(std::atoll(value.data()));
+        else
+            return false;
+    }
+
+    return options.count > 0 && options.size > 0;
+}
+
+/// @brief Bounce `options.count` messages over the connected `ping` & `echo`, and record each round trip.
+template <typename Socket>
+bool run(const Options& options, Socket& ping, Socket& echo, ds::tools::LatencyHistogram& histogram)
+{
+    std::error_code echo_ec;
+    std::thread echo_thread([&] {
+        std::vector<std::byte> message(options.size);
+        std::size_t length;
+        for (std::uint64_t i = 0; i < options.count; ++i)
+        {
+            echo.receive_exact(message.data(), message.size(), length, echo_ec);
+            if (!echo_ec)
+                echo.send_all(message.data(), message.size(), length, echo_ec);
+            if (echo_ec)
+                break;
+        }
+
+        // unblock the ping side, if this side failed
+        if (echo_ec)
+            echo.close();
+    });
+
+    std::error_code ec;
+    std::vector<std::byte> message(options.size);
+    std::size_t length;
+    for (std::uint64_t i = 0; i < options.count; ++i)
+    {
+        const Clock::time_point start = Clock::now();
+        ping.send_all(message.data(), message.size(), length, ec);
+        if (!ec)
+            ping.receive_exact(message.data(), message.size(), length, ec);
+        if (ec)
+            break;
+
+        histogram.record(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+    }
+
+    // unblock the echo thread, if this side failed
+    if (ec)
+        ping.close();
+    echo_thread.join();
+
+    if (ec || echo_ec)
+    {
+        std::cerr << "ping: " << (echo_ec ? echo_ec : ec).message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool run_unix(const Options& options, ds::tools::LatencyHistogram& histogram)
+{
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() /
+        std::format("ds_unix_latency_bench_{}.sock", Clock::now().time_since_epoch().count());
+
+    std::error_code ec;
+    const auto address = ds::UnixSocketAddress::from_path(path.string(), ec);
+    if (ec || !address)
+    {
+        std::cerr << "unix address: " << ec.message() << std::endl;
+        return false;
+    }
+
+    ds::UnixListener listener;
+    ds::UnixSocket ping;
+    ds::UnixSocket echo;
+    listener.listen(*address, ec);
+    if (!ec)
+        ping.connect(*address, ec);
+    if (!ec)
+        listener.accept(echo, ec);
+
+    // the socket file stays until it's removed
+    listener.close();
+    std::error_code remove_ec;
+    std::filesystem::remove(path, remove_ec);
+
+    if (ec)
+    {
+        std::cerr << "unix connect: " << ec.message() << std::endl;
+        return false;
+    }
+    return run(options, ping, echo, histogram);
+}
+
+bool run_tcp(const Options& options, ds::tools::LatencyHistogram& histogram)
+{
+    std::error_code ec;
+    ds::TcpListener listener;
+    listener.listen(ds::SocketAddress(127, 0, 0, 1, 0), SOMAXCONN, ds::SocketOptions().no_delay(), ec);
+    const auto address = listener.get_local_address(ec);
+    if (ec || !address)
+    {
+        std::cerr << "tcp listen: " << ec.message() << std::endl;
+        return false;
+    }
+
+    ds::TcpSocket ping;
+    ds::TcpSocket echo;
+    ping.connect(*address, ds::SocketOptions().no_delay(), ec);
+    if (!ec)
+        listener.accept(echo, ec);
+    if (ec)
+    {
+        std::cerr << "tcp connect: " << ec.message() << std::endl;
+        return false;
+    }
+    return run(options, ping, echo, histogram);
+}
+
+void print_row(std::string_view name, const ds::tools::LatencyHistogram& histogram)
+{
+    auto us = [](std::uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+    std::cout << std::format("{:<6} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}\n", name, us(histogram.get_min()),
+                             us(histogram.get_percentile(50.0)), us(histogram.get_percentile(99.0)),
+                             us(histogram.get_max()));
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        std::cerr << "usage: ds_unix_latency_bench [--count 100000] [--size 64]" << std::endl;
+        return 1;
+    }
+
+    std::error_code ec;
+    ds::System::init(ec);
+    if (ec)
+    {
+        std::cerr << "init: " << ec.message() << std::endl;
+        return 1;
+    }
+
+    ds::tools::LatencyHistogram unix_histogram;
+    ds::tools::LatencyHistogram tcp_histogram;
+    const bool ok = run_unix(options, unix_histogram) && run_tcp(options, tcp_histogram);
+
+    if (ok)
+    {
+        std::cout << std::format("{:<6} {:>10} {:>10} {:>10} {:>10}\n", "us", "min", "p50", "p99", "max");
+        print_row("unix", unix_histogram);
+        print_row("tcp", tcp_histogram);
+        std::cout << std::format("unix / tcp p50: {:.2f}\n",
+                                 static_cast<double>(unix_histogram.get_percentile(50.0)) /
+                                     static_cast<double>(tcp_histogram.get_percentile(50.0)));
+    }
+
+    ds::System::destroy();
+    return ok ? 0 : 2;
+}